@@ -122,7 +122,7 @@ int16 Oki_ADPCMStream::decodeOKI(byte code) {
 
 int XA_ADPCMStream::readBuffer(int16 *buffer, const int numSamples) {
 	int samples;
-	byte *data = new byte[128];
+	byte data[128];
 
 	for (samples = 0; samples < numSamples && !endOfData(); samples++) {
 		if (_decodedSampleCount == 0) {
@@ -143,7 +143,6 @@ int XA_ADPCMStream::readBuffer(int16 *buffer, const int numSamples) {
 		_decodedSampleCount--;
 	}
 
-	delete[] data;
 	return samples;
 }
 
@@ -316,40 +315,66 @@ int MSIma_ADPCMStream::readBuffer(int16 *buffer, const int numSamples) {
 
 	int samples = 0;
 
-	while (samples < numSamples && !_stream->eos() && _stream->pos() < _endpos) {
-		if (_blockPos[0] == _blockAlign) {
-			for (int i = 0; i < _channels; i++) {
-				// read block header
-				_status.ima_ch[i].last = _stream->readSint16LE();
-				_status.ima_ch[i].stepIndex = _stream->readSint16LE();
-			}
+	while (samples < numSamples) {
+		if (_blockSampleIndex == _blockSampleCount) {
+			if (_stream->eos() || _stream->pos() >= _endpos)
+				break;
 
-			_blockPos[0] = _channels * 4;
+			decodeBlock();
 		}
 
-		// Decode a set of samples
+		const uint32 count = MIN<uint32>(numSamples - samples, _blockSampleCount - _blockSampleIndex);
+		memcpy(buffer + samples, _blockSamples + _blockSampleIndex, count * sizeof(int16));
+		_blockSampleIndex += count;
+		samples += count;
+	}
+
+	return samples;
+}
+
+void MSIma_ADPCMStream::decodeBlock() {
+	const uint32 headerSize = _channels * 4;
+	const uint32 groupSize = _channels * 4;
+
+	// Groups of four bytes per channel follow the header. A truncated
+	// group at the end of the data is still decoded as a whole.
+	const uint32 available = MIN<uint32>(_blockAlign, _endpos - _stream->pos());
+	uint32 groups = (available > headerSize) ? (available - headerSize + groupSize - 1) / groupSize : 1;
+	groups = MIN<uint32>(groups, (_blockAlign - headerSize) / groupSize);
+
+	const uint32 size = headerSize + groups * groupSize;
+	const uint32 read = _stream->read(_blockData, size);
+	if (read < size)
+		memset(_blockData + read, 0, size - read);
+
+	const byte *src = _blockData;
+
+	for (int i = 0; i < _channels; i++) {
+		_status.ima_ch[i].last = (int16)READ_LE_UINT16(src);
+		_status.ima_ch[i].stepIndex = CLIP<int32>((int16)READ_LE_UINT16(src + 2), 0, ARRAYSIZE(_imaTable) - 1);
+		src += 4;
+	}
+
+	// Decode straight into the interleaved order
+	int16 *dst = _blockSamples;
+
+	for (uint32 group = 0; group < groups; group++) {
 		for (int i = 0; i < _channels; i++) {
-			// The stream encodes four bytes per channel at a time
+			int16 *out = dst + i;
+
 			for (int j = 0; j < 4; j++) {
-				byte data = _stream->readByte();
-				_blockPos[0]++;
-				_buffer[i][j * 2] = decodeIMA(data & 0x0f, i);
-				_buffer[i][j * 2 + 1] = decodeIMA((data >> 4) & 0x0f, i);
-				_samplesLeft[i] += 2;
+				const byte data = *src++;
+				out[0]         = decodeIMA(data & 0x0f, i);
+				out[_channels] = decodeIMA((data >> 4) & 0x0f, i);
+				out += _channels * 2;
 			}
 		}
 
-		while (samples < numSamples && _samplesLeft[0] != 0) {
-			for (int i = 0; i < _channels; i++) {
-				buffer[samples + i] = _buffer[i][8 - _samplesLeft[i]];
-				_samplesLeft[i]--;
-			}
-
-			samples += _channels;
-		}
+		dst += 8 * _channels;
 	}
 
-	return samples;
+	_blockSampleCount = groups * 8 * _channels;
+	_blockSampleIndex = 0;
 }
 
 
@@ -388,48 +413,65 @@ int16 MS_ADPCMStream::decodeMS(ADPCMChannelStatus *c, byte code) {
 }
 
 int MS_ADPCMStream::readBuffer(int16 *buffer, const int numSamples) {
-	int samples;
-	byte data;
-	int i;
+	int samples = 0;
 
-	for (samples = 0; samples < numSamples && !endOfData(); samples++) {
-		if (_decodedSampleCount == 0) {
-			if (_blockPos[0] == _blockAlign) {
-				// read block header
-				for (i = 0; i < _channels; i++) {
-					_status.ch[i].predictor = CLIP(_stream->readByte(), (byte)0, (byte)6);
-					_status.ch[i].coeff1 = MSADPCMAdaptCoeff1[_status.ch[i].predictor];
-					_status.ch[i].coeff2 = MSADPCMAdaptCoeff2[_status.ch[i].predictor];
-				}
+	while (samples < numSamples) {
+		if (_blockSampleIndex == _blockSampleCount) {
+			if (_stream->eos() || _stream->pos() >= _endpos)
+				break;
 
-				for (i = 0; i < _channels; i++)
-					_status.ch[i].delta = _stream->readSint16LE();
+			decodeBlock();
+		}
 
-				for (i = 0; i < _channels; i++)
-					_status.ch[i].sample1 = _stream->readSint16LE();
+		const uint32 count = MIN<uint32>(numSamples - samples, _blockSampleCount - _blockSampleIndex);
+		memcpy(buffer + samples, _blockSamples + _blockSampleIndex, count * sizeof(int16));
+		_blockSampleIndex += count;
+		samples += count;
+	}
 
-				for (i = 0; i < _channels; i++)
-					_decodedSamples[_decodedSampleCount++] = _status.ch[i].sample2 = _stream->readSint16LE();
+	return samples;
+}
 
-				for (i = 0; i < _channels; i++)
-					_decodedSamples[_decodedSampleCount++] = _status.ch[i].sample1;
+void MS_ADPCMStream::decodeBlock() {
+	const uint32 headerSize = _channels * 7;
 
-				_blockPos[0] = _channels * 7;
-			} else {
-				data = _stream->readByte();
-				_blockPos[0]++;
-				_decodedSamples[_decodedSampleCount++] = decodeMS(&_status.ch[0], (data >> 4) & 0x0f);
-				_decodedSamples[_decodedSampleCount++] = decodeMS(&_status.ch[_channels - 1], data & 0x0f);
-			}
-			_decodedSampleIndex = 0;
-		}
+	// The last block may be shorter, but always has a complete header
+	uint32 size = _stream->read(_blockData, MIN<uint32>(_blockAlign, _endpos - _stream->pos()));
+	if (size < headerSize) {
+		memset(_blockData + size, 0, headerSize - size);
+		size = headerSize;
+	}
 
-		// _decodedSamples acts as a FIFO of depth 2 or 4;
-		buffer[samples] = _decodedSamples[_decodedSampleIndex++];
-		_decodedSampleCount--;
+	const byte *src = _blockData;
+	int16 *dst = _blockSamples;
+	int i;
+
+	for (i = 0; i < _channels; i++) {
+		_status.ch[i].predictor = CLIP(*src++, (byte)0, (byte)6);
+		_status.ch[i].coeff1 = MSADPCMAdaptCoeff1[_status.ch[i].predictor];
+		_status.ch[i].coeff2 = MSADPCMAdaptCoeff2[_status.ch[i].predictor];
 	}
 
-	return samples;
+	for (i = 0; i < _channels; i++, src += 2)
+		_status.ch[i].delta = (int16)READ_LE_UINT16(src);
+
+	for (i = 0; i < _channels; i++, src += 2)
+		_status.ch[i].sample1 = (int16)READ_LE_UINT16(src);
+
+	for (i = 0; i < _channels; i++, src += 2)
+		*dst++ = _status.ch[i].sample2 = (int16)READ_LE_UINT16(src);
+
+	for (i = 0; i < _channels; i++)
+		*dst++ = _status.ch[i].sample1;
+
+	// Each byte holds one sample for each channel, or two for mono
+	for (const byte *end = _blockData + size; src < end; src++) {
+		*dst++ = decodeMS(&_status.ch[0], (*src >> 4) & 0x0f);
+		*dst++ = decodeMS(&_status.ch[_channels - 1], *src & 0x0f);
+	}
+
+	_blockSampleCount = dst - _blockSamples;
+	_blockSampleIndex = 0;
 }
 
 
@@ -545,14 +587,200 @@ const int16 Ima_ADPCMStream::_imaTable[89] = {
 	32767
 };
 
+// The sample difference for each step index and code, derived from _imaTable:
+// (2 * (code & 7) + 1) * step / 8, negated when bit 3 of the code is set
+static const int32 s_imaDiffTable[89][16] = {
+	{      0,      2,      4,      6,      7,      9,     11,     13,      0,     -2,     -4,     -6,     -7,     -9,    -11,    -13 },
+	{      1,      3,      5,      7,      9,     11,     13,     15,     -1,     -3,     -5,     -7,     -9,    -11,    -13,    -15 },
+	{      1,      3,      5,      7,     10,     12,     14,     16,     -1,     -3,     -5,     -7,    -10,    -12,    -14,    -16 },
+	{      1,      3,      6,      8,     11,     13,     16,     18,     -1,     -3,     -6,     -8,    -11,    -13,    -16,    -18 },
+	{      1,      4,      6,      9,     12,     15,     17,     20,     -1,     -4,     -6,     -9,    -12,    -15,    -17,    -20 },
+	{      1,      4,      7,     10,     13,     16,     19,     22,     -1,     -4,     -7,    -10,    -13,    -16,    -19,    -22 },
+	{      1,      4,      8,     11,     14,     17,     21,     24,     -1,     -4,     -8,    -11,    -14,    -17,    -21,    -24 },
+	{      1,      5,      8,     12,     15,     19,     22,     26,     -1,     -5,     -8,    -12,    -15,    -19,    -22,    -26 },
+	{      2,      6,     10,     14,     18,     22,     26,     30,     -2,     -6,    -10,    -14,    -18,    -22,    -26,    -30 },
+	{      2,      6,     10,     14,     19,     23,     27,     31,     -2,     -6,    -10,    -14,    -19,    -23,    -27,    -31 },
+	{      2,      7,     11,     16,     21,     26,     30,     35,     -2,     -7,    -11,    -16,    -21,    -26,    -30,    -35 },
+	{      2,      7,     13,     18,     23,     28,     34,     39,     -2,     -7,    -13,    -18,    -23,    -28,    -34,    -39 },
+	{      2,      8,     14,     20,     25,     31,     37,     43,     -2,     -8,    -14,    -20,    -25,    -31,    -37,    -43 },
+	{      3,      9,     15,     21,     28,     34,     40,     46,     -3,     -9,    -15,    -21,    -28,    -34,    -40,    -46 },
+	{      3,     10,     17,     24,     31,     38,     45,     52,     -3,    -10,    -17,    -24,    -31,    -38,    -45,    -52 },
+	{      3,     11,     19,     27,     34,     42,     50,     58,     -3,    -11,    -19,    -27,    -34,    -42,    -50,    -58 },
+	{      4,     12,     21,     29,     38,     46,     55,     63,     -4,    -12,    -21,    -29,    -38,    -46,    -55,    -63 },
+	{      4,     13,     23,     32,     41,     50,     60,     69,     -4,    -13,    -23,    -32,    -41,    -50,    -60,    -69 },
+	{      5,     15,     25,     35,     46,     56,     66,     76,     -5,    -15,    -25,    -35,    -46,    -56,    -66,    -76 },
+	{      5,     16,     28,     39,     50,     61,     73,     84,     -5,    -16,    -28,    -39,    -50,    -61,    -73,    -84 },
+	{      6,     18,     31,     43,     56,     68,     81,     93,     -6,    -18,    -31,    -43,    -56,    -68,    -81,    -93 },
+	{      6,     20,     34,     48,     61,     75,     89,    103,     -6,    -20,    -34,    -48,    -61,    -75,    -89,   -103 },
+	{      7,     22,     37,     52,     67,     82,     97,    112,     -7,    -22,    -37,    -52,    -67,    -82,    -97,   -112 },
+	{      8,     24,     41,     57,     74,     90,    107,    123,     -8,    -24,    -41,    -57,    -74,    -90,   -107,   -123 },
+	{      9,     27,     45,     63,     82,    100,    118,    136,     -9,    -27,    -45,    -63,    -82,   -100,   -118,   -136 },
+	{     10,     30,     50,     70,     90,    110,    130,    150,    -10,    -30,    -50,    -70,    -90,   -110,   -130,   -150 },
+	{     11,     33,     55,     77,     99,    121,    143,    165,    -11,    -33,    -55,    -77,    -99,   -121,   -143,   -165 },
+	{     12,     36,     60,     84,    109,    133,    157,    181,    -12,    -36,    -60,    -84,   -109,   -133,   -157,   -181 },
+	{     13,     40,     66,     93,    120,    147,    173,    200,    -13,    -40,    -66,    -93,   -120,   -147,   -173,   -200 },
+	{     14,     44,     73,    103,    132,    162,    191,    221,    -14,    -44,    -73,   -103,   -132,   -162,   -191,   -221 },
+	{     16,     48,     81,    113,    146,    178,    211,    243,    -16,    -48,    -81,   -113,   -146,   -178,   -211,   -243 },
+	{     17,     53,     89,    125,    160,    196,    232,    268,    -17,    -53,    -89,   -125,   -160,   -196,   -232,   -268 },
+	{     19,     58,     98,    137,    176,    215,    255,    294,    -19,    -58,    -98,   -137,   -176,   -215,   -255,   -294 },
+	{     21,     64,    108,    151,    194,    237,    281,    324,    -21,    -64,   -108,   -151,   -194,   -237,   -281,   -324 },
+	{     23,     71,    118,    166,    213,    261,    308,    356,    -23,    -71,   -118,   -166,   -213,   -261,   -308,   -356 },
+	{     26,     78,    130,    182,    235,    287,    339,    391,    -26,    -78,   -130,   -182,   -235,   -287,   -339,   -391 },
+	{     28,     86,    143,    201,    258,    316,    373,    431,    -28,    -86,   -143,   -201,   -258,   -316,   -373,   -431 },
+	{     31,     94,    158,    221,    284,    347,    411,    474,    -31,    -94,   -158,   -221,   -284,   -347,   -411,   -474 },
+	{     34,    104,    174,    244,    313,    383,    453,    523,    -34,   -104,   -174,   -244,   -313,   -383,   -453,   -523 },
+	{     38,    115,    191,    268,    345,    422,    498,    575,    -38,   -115,   -191,   -268,   -345,   -422,   -498,   -575 },
+	{     42,    126,    210,    294,    379,    463,    547,    631,    -42,   -126,   -210,   -294,   -379,   -463,   -547,   -631 },
+	{     46,    139,    231,    324,    417,    510,    602,    695,    -46,   -139,   -231,   -324,   -417,   -510,   -602,   -695 },
+	{     51,    153,    255,    357,    459,    561,    663,    765,    -51,   -153,   -255,   -357,   -459,   -561,   -663,   -765 },
+	{     56,    168,    280,    392,    505,    617,    729,    841,    -56,   -168,   -280,   -392,   -505,   -617,   -729,   -841 },
+	{     61,    185,    308,    432,    555,    679,    802,    926,    -61,   -185,   -308,   -432,   -555,   -679,   -802,   -926 },
+	{     68,    204,    340,    476,    612,    748,    884,   1020,    -68,   -204,   -340,   -476,   -612,   -748,   -884,  -1020 },
+	{     74,    224,    373,    523,    672,    822,    971,   1121,    -74,   -224,   -373,   -523,   -672,   -822,   -971,  -1121 },
+	{     82,    246,    411,    575,    740,    904,   1069,   1233,    -82,   -246,   -411,   -575,   -740,   -904,  -1069,  -1233 },
+	{     90,    271,    452,    633,    814,    995,   1176,   1357,    -90,   -271,   -452,   -633,   -814,   -995,  -1176,  -1357 },
+	{     99,    298,    497,    696,    895,   1094,   1293,   1492,    -99,   -298,   -497,   -696,   -895,  -1094,  -1293,  -1492 },
+	{    109,    328,    547,    766,    985,   1204,   1423,   1642,   -109,   -328,   -547,   -766,   -985,  -1204,  -1423,  -1642 },
+	{    120,    361,    601,    842,   1083,   1324,   1564,   1805,   -120,   -361,   -601,   -842,  -1083,  -1324,  -1564,  -1805 },
+	{    132,    397,    662,    927,   1192,   1457,   1722,   1987,   -132,   -397,   -662,   -927,  -1192,  -1457,  -1722,  -1987 },
+	{    145,    437,    728,   1020,   1311,   1603,   1894,   2186,   -145,   -437,   -728,  -1020,  -1311,  -1603,  -1894,  -2186 },
+	{    160,    480,    801,   1121,   1442,   1762,   2083,   2403,   -160,   -480,   -801,  -1121,  -1442,  -1762,  -2083,  -2403 },
+	{    176,    529,    881,   1234,   1587,   1940,   2292,   2645,   -176,   -529,   -881,  -1234,  -1587,  -1940,  -2292,  -2645 },
+	{    194,    582,    970,   1358,   1746,   2134,   2522,   2910,   -194,   -582,   -970,  -1358,  -1746,  -2134,  -2522,  -2910 },
+	{    213,    640,   1066,   1493,   1920,   2347,   2773,   3200,   -213,   -640,  -1066,  -1493,  -1920,  -2347,  -2773,  -3200 },
+	{    234,    704,   1173,   1643,   2112,   2582,   3051,   3521,   -234,   -704,  -1173,  -1643,  -2112,  -2582,  -3051,  -3521 },
+	{    258,    774,   1291,   1807,   2324,   2840,   3357,   3873,   -258,   -774,  -1291,  -1807,  -2324,  -2840,  -3357,  -3873 },
+	{    284,    852,   1420,   1988,   2556,   3124,   3692,   4260,   -284,   -852,  -1420,  -1988,  -2556,  -3124,  -3692,  -4260 },
+	{    312,    937,   1561,   2186,   2811,   3436,   4060,   4685,   -312,   -937,  -1561,  -2186,  -2811,  -3436,  -4060,  -4685 },
+	{    343,   1030,   1718,   2405,   3092,   3779,   4467,   5154,   -343,  -1030,  -1718,  -2405,  -3092,  -3779,  -4467,  -5154 },
+	{    378,   1134,   1890,   2646,   3402,   4158,   4914,   5670,   -378,  -1134,  -1890,  -2646,  -3402,  -4158,  -4914,  -5670 },
+	{    415,   1247,   2079,   2911,   3742,   4574,   5406,   6238,   -415,  -1247,  -2079,  -2911,  -3742,  -4574,  -5406,  -6238 },
+	{    457,   1372,   2287,   3202,   4117,   5032,   5947,   6862,   -457,  -1372,  -2287,  -3202,  -4117,  -5032,  -5947,  -6862 },
+	{    503,   1509,   2516,   3522,   4529,   5535,   6542,   7548,   -503,  -1509,  -2516,  -3522,  -4529,  -5535,  -6542,  -7548 },
+	{    553,   1660,   2767,   3874,   4981,   6088,   7195,   8302,   -553,  -1660,  -2767,  -3874,  -4981,  -6088,  -7195,  -8302 },
+	{    608,   1826,   3044,   4262,   5479,   6697,   7915,   9133,   -608,  -1826,  -3044,  -4262,  -5479,  -6697,  -7915,  -9133 },
+	{    669,   2009,   3348,   4688,   6027,   7367,   8706,  10046,   -669,  -2009,  -3348,  -4688,  -6027,  -7367,  -8706, -10046 },
+	{    736,   2210,   3683,   5157,   6630,   8104,   9577,  11051,   -736,  -2210,  -3683,  -5157,  -6630,  -8104,  -9577, -11051 },
+	{    810,   2431,   4052,   5673,   7294,   8915,  10536,  12157,   -810,  -2431,  -4052,  -5673,  -7294,  -8915, -10536, -12157 },
+	{    891,   2674,   4457,   6240,   8023,   9806,  11589,  13372,   -891,  -2674,  -4457,  -6240,  -8023,  -9806, -11589, -13372 },
+	{    980,   2941,   4903,   6864,   8825,  10786,  12748,  14709,   -980,  -2941,  -4903,  -6864,  -8825, -10786, -12748, -14709 },
+	{   1078,   3236,   5393,   7551,   9708,  11866,  14023,  16181,  -1078,  -3236,  -5393,  -7551,  -9708, -11866, -14023, -16181 },
+	{   1186,   3559,   5933,   8306,  10679,  13052,  15426,  17799,  -1186,  -3559,  -5933,  -8306, -10679, -13052, -15426, -17799 },
+	{   1305,   3915,   6526,   9136,  11747,  14357,  16968,  19578,  -1305,  -3915,  -6526,  -9136, -11747, -14357, -16968, -19578 },
+	{   1435,   4307,   7179,  10051,  12922,  15794,  18666,  21538,  -1435,  -4307,  -7179, -10051, -12922, -15794, -18666, -21538 },
+	{   1579,   4738,   7896,  11055,  14214,  17373,  20531,  23690,  -1579,  -4738,  -7896, -11055, -14214, -17373, -20531, -23690 },
+	{   1737,   5212,   8686,  12161,  15636,  19111,  22585,  26060,  -1737,  -5212,  -8686, -12161, -15636, -19111, -22585, -26060 },
+	{   1911,   5733,   9555,  13377,  17200,  21022,  24844,  28666,  -1911,  -5733,  -9555, -13377, -17200, -21022, -24844, -28666 },
+	{   2102,   6306,  10511,  14715,  18920,  23124,  27329,  31533,  -2102,  -6306, -10511, -14715, -18920, -23124, -27329, -31533 },
+	{   2312,   6937,  11562,  16187,  20812,  25437,  30062,  34687,  -2312,  -6937, -11562, -16187, -20812, -25437, -30062, -34687 },
+	{   2543,   7631,  12718,  17806,  22893,  27981,  33068,  38156,  -2543,  -7631, -12718, -17806, -22893, -27981, -33068, -38156 },
+	{   2798,   8394,  13990,  19586,  25183,  30779,  36375,  41971,  -2798,  -8394, -13990, -19586, -25183, -30779, -36375, -41971 },
+	{   3077,   9233,  15389,  21545,  27700,  33856,  40012,  46168,  -3077,  -9233, -15389, -21545, -27700, -33856, -40012, -46168 },
+	{   3385,  10157,  16928,  23700,  30471,  37243,  44014,  50786,  -3385, -10157, -16928, -23700, -30471, -37243, -44014, -50786 },
+	{   3724,  11172,  18621,  26069,  33518,  40966,  48415,  55863,  -3724, -11172, -18621, -26069, -33518, -40966, -48415, -55863 },
+	{   4095,  12287,  20479,  28671,  36862,  45054,  53246,  61438,  -4095, -12287, -20479, -28671, -36862, -45054, -53246, -61438 }
+};
+
+// The next step index for each step index and code, derived from
+// _stepAdjustTable and clipped to the range of _imaTable
+static const byte s_imaNextStepTable[89][16] = {
+	{  0,  0,  0,  0,  2,  4,  6,  8,  0,  0,  0,  0,  2,  4,  6,  8 },
+	{  0,  0,  0,  0,  3,  5,  7,  9,  0,  0,  0,  0,  3,  5,  7,  9 },
+	{  1,  1,  1,  1,  4,  6,  8, 10,  1,  1,  1,  1,  4,  6,  8, 10 },
+	{  2,  2,  2,  2,  5,  7,  9, 11,  2,  2,  2,  2,  5,  7,  9, 11 },
+	{  3,  3,  3,  3,  6,  8, 10, 12,  3,  3,  3,  3,  6,  8, 10, 12 },
+	{  4,  4,  4,  4,  7,  9, 11, 13,  4,  4,  4,  4,  7,  9, 11, 13 },
+	{  5,  5,  5,  5,  8, 10, 12, 14,  5,  5,  5,  5,  8, 10, 12, 14 },
+	{  6,  6,  6,  6,  9, 11, 13, 15,  6,  6,  6,  6,  9, 11, 13, 15 },
+	{  7,  7,  7,  7, 10, 12, 14, 16,  7,  7,  7,  7, 10, 12, 14, 16 },
+	{  8,  8,  8,  8, 11, 13, 15, 17,  8,  8,  8,  8, 11, 13, 15, 17 },
+	{  9,  9,  9,  9, 12, 14, 16, 18,  9,  9,  9,  9, 12, 14, 16, 18 },
+	{ 10, 10, 10, 10, 13, 15, 17, 19, 10, 10, 10, 10, 13, 15, 17, 19 },
+	{ 11, 11, 11, 11, 14, 16, 18, 20, 11, 11, 11, 11, 14, 16, 18, 20 },
+	{ 12, 12, 12, 12, 15, 17, 19, 21, 12, 12, 12, 12, 15, 17, 19, 21 },
+	{ 13, 13, 13, 13, 16, 18, 20, 22, 13, 13, 13, 13, 16, 18, 20, 22 },
+	{ 14, 14, 14, 14, 17, 19, 21, 23, 14, 14, 14, 14, 17, 19, 21, 23 },
+	{ 15, 15, 15, 15, 18, 20, 22, 24, 15, 15, 15, 15, 18, 20, 22, 24 },
+	{ 16, 16, 16, 16, 19, 21, 23, 25, 16, 16, 16, 16, 19, 21, 23, 25 },
+	{ 17, 17, 17, 17, 20, 22, 24, 26, 17, 17, 17, 17, 20, 22, 24, 26 },
+	{ 18, 18, 18, 18, 21, 23, 25, 27, 18, 18, 18, 18, 21, 23, 25, 27 },
+	{ 19, 19, 19, 19, 22, 24, 26, 28, 19, 19, 19, 19, 22, 24, 26, 28 },
+	{ 20, 20, 20, 20, 23, 25, 27, 29, 20, 20, 20, 20, 23, 25, 27, 29 },
+	{ 21, 21, 21, 21, 24, 26, 28, 30, 21, 21, 21, 21, 24, 26, 28, 30 },
+	{ 22, 22, 22, 22, 25, 27, 29, 31, 22, 22, 22, 22, 25, 27, 29, 31 },
+	{ 23, 23, 23, 23, 26, 28, 30, 32, 23, 23, 23, 23, 26, 28, 30, 32 },
+	{ 24, 24, 24, 24, 27, 29, 31, 33, 24, 24, 24, 24, 27, 29, 31, 33 },
+	{ 25, 25, 25, 25, 28, 30, 32, 34, 25, 25, 25, 25, 28, 30, 32, 34 },
+	{ 26, 26, 26, 26, 29, 31, 33, 35, 26, 26, 26, 26, 29, 31, 33, 35 },
+	{ 27, 27, 27, 27, 30, 32, 34, 36, 27, 27, 27, 27, 30, 32, 34, 36 },
+	{ 28, 28, 28, 28, 31, 33, 35, 37, 28, 28, 28, 28, 31, 33, 35, 37 },
+	{ 29, 29, 29, 29, 32, 34, 36, 38, 29, 29, 29, 29, 32, 34, 36, 38 },
+	{ 30, 30, 30, 30, 33, 35, 37, 39, 30, 30, 30, 30, 33, 35, 37, 39 },
+	{ 31, 31, 31, 31, 34, 36, 38, 40, 31, 31, 31, 31, 34, 36, 38, 40 },
+	{ 32, 32, 32, 32, 35, 37, 39, 41, 32, 32, 32, 32, 35, 37, 39, 41 },
+	{ 33, 33, 33, 33, 36, 38, 40, 42, 33, 33, 33, 33, 36, 38, 40, 42 },
+	{ 34, 34, 34, 34, 37, 39, 41, 43, 34, 34, 34, 34, 37, 39, 41, 43 },
+	{ 35, 35, 35, 35, 38, 40, 42, 44, 35, 35, 35, 35, 38, 40, 42, 44 },
+	{ 36, 36, 36, 36, 39, 41, 43, 45, 36, 36, 36, 36, 39, 41, 43, 45 },
+	{ 37, 37, 37, 37, 40, 42, 44, 46, 37, 37, 37, 37, 40, 42, 44, 46 },
+	{ 38, 38, 38, 38, 41, 43, 45, 47, 38, 38, 38, 38, 41, 43, 45, 47 },
+	{ 39, 39, 39, 39, 42, 44, 46, 48, 39, 39, 39, 39, 42, 44, 46, 48 },
+	{ 40, 40, 40, 40, 43, 45, 47, 49, 40, 40, 40, 40, 43, 45, 47, 49 },
+	{ 41, 41, 41, 41, 44, 46, 48, 50, 41, 41, 41, 41, 44, 46, 48, 50 },
+	{ 42, 42, 42, 42, 45, 47, 49, 51, 42, 42, 42, 42, 45, 47, 49, 51 },
+	{ 43, 43, 43, 43, 46, 48, 50, 52, 43, 43, 43, 43, 46, 48, 50, 52 },
+	{ 44, 44, 44, 44, 47, 49, 51, 53, 44, 44, 44, 44, 47, 49, 51, 53 },
+	{ 45, 45, 45, 45, 48, 50, 52, 54, 45, 45, 45, 45, 48, 50, 52, 54 },
+	{ 46, 46, 46, 46, 49, 51, 53, 55, 46, 46, 46, 46, 49, 51, 53, 55 },
+	{ 47, 47, 47, 47, 50, 52, 54, 56, 47, 47, 47, 47, 50, 52, 54, 56 },
+	{ 48, 48, 48, 48, 51, 53, 55, 57, 48, 48, 48, 48, 51, 53, 55, 57 },
+	{ 49, 49, 49, 49, 52, 54, 56, 58, 49, 49, 49, 49, 52, 54, 56, 58 },
+	{ 50, 50, 50, 50, 53, 55, 57, 59, 50, 50, 50, 50, 53, 55, 57, 59 },
+	{ 51, 51, 51, 51, 54, 56, 58, 60, 51, 51, 51, 51, 54, 56, 58, 60 },
+	{ 52, 52, 52, 52, 55, 57, 59, 61, 52, 52, 52, 52, 55, 57, 59, 61 },
+	{ 53, 53, 53, 53, 56, 58, 60, 62, 53, 53, 53, 53, 56, 58, 60, 62 },
+	{ 54, 54, 54, 54, 57, 59, 61, 63, 54, 54, 54, 54, 57, 59, 61, 63 },
+	{ 55, 55, 55, 55, 58, 60, 62, 64, 55, 55, 55, 55, 58, 60, 62, 64 },
+	{ 56, 56, 56, 56, 59, 61, 63, 65, 56, 56, 56, 56, 59, 61, 63, 65 },
+	{ 57, 57, 57, 57, 60, 62, 64, 66, 57, 57, 57, 57, 60, 62, 64, 66 },
+	{ 58, 58, 58, 58, 61, 63, 65, 67, 58, 58, 58, 58, 61, 63, 65, 67 },
+	{ 59, 59, 59, 59, 62, 64, 66, 68, 59, 59, 59, 59, 62, 64, 66, 68 },
+	{ 60, 60, 60, 60, 63, 65, 67, 69, 60, 60, 60, 60, 63, 65, 67, 69 },
+	{ 61, 61, 61, 61, 64, 66, 68, 70, 61, 61, 61, 61, 64, 66, 68, 70 },
+	{ 62, 62, 62, 62, 65, 67, 69, 71, 62, 62, 62, 62, 65, 67, 69, 71 },
+	{ 63, 63, 63, 63, 66, 68, 70, 72, 63, 63, 63, 63, 66, 68, 70, 72 },
+	{ 64, 64, 64, 64, 67, 69, 71, 73, 64, 64, 64, 64, 67, 69, 71, 73 },
+	{ 65, 65, 65, 65, 68, 70, 72, 74, 65, 65, 65, 65, 68, 70, 72, 74 },
+	{ 66, 66, 66, 66, 69, 71, 73, 75, 66, 66, 66, 66, 69, 71, 73, 75 },
+	{ 67, 67, 67, 67, 70, 72, 74, 76, 67, 67, 67, 67, 70, 72, 74, 76 },
+	{ 68, 68, 68, 68, 71, 73, 75, 77, 68, 68, 68, 68, 71, 73, 75, 77 },
+	{ 69, 69, 69, 69, 72, 74, 76, 78, 69, 69, 69, 69, 72, 74, 76, 78 },
+	{ 70, 70, 70, 70, 73, 75, 77, 79, 70, 70, 70, 70, 73, 75, 77, 79 },
+	{ 71, 71, 71, 71, 74, 76, 78, 80, 71, 71, 71, 71, 74, 76, 78, 80 },
+	{ 72, 72, 72, 72, 75, 77, 79, 81, 72, 72, 72, 72, 75, 77, 79, 81 },
+	{ 73, 73, 73, 73, 76, 78, 80, 82, 73, 73, 73, 73, 76, 78, 80, 82 },
+	{ 74, 74, 74, 74, 77, 79, 81, 83, 74, 74, 74, 74, 77, 79, 81, 83 },
+	{ 75, 75, 75, 75, 78, 80, 82, 84, 75, 75, 75, 75, 78, 80, 82, 84 },
+	{ 76, 76, 76, 76, 79, 81, 83, 85, 76, 76, 76, 76, 79, 81, 83, 85 },
+	{ 77, 77, 77, 77, 80, 82, 84, 86, 77, 77, 77, 77, 80, 82, 84, 86 },
+	{ 78, 78, 78, 78, 81, 83, 85, 87, 78, 78, 78, 78, 81, 83, 85, 87 },
+	{ 79, 79, 79, 79, 82, 84, 86, 88, 79, 79, 79, 79, 82, 84, 86, 88 },
+	{ 80, 80, 80, 80, 83, 85, 87, 88, 80, 80, 80, 80, 83, 85, 87, 88 },
+	{ 81, 81, 81, 81, 84, 86, 88, 88, 81, 81, 81, 81, 84, 86, 88, 88 },
+	{ 82, 82, 82, 82, 85, 87, 88, 88, 82, 82, 82, 82, 85, 87, 88, 88 },
+	{ 83, 83, 83, 83, 86, 88, 88, 88, 83, 83, 83, 83, 86, 88, 88, 88 },
+	{ 84, 84, 84, 84, 87, 88, 88, 88, 84, 84, 84, 84, 87, 88, 88, 88 },
+	{ 85, 85, 85, 85, 88, 88, 88, 88, 85, 85, 85, 85, 88, 88, 88, 88 },
+	{ 86, 86, 86, 86, 88, 88, 88, 88, 86, 86, 86, 86, 88, 88, 88, 88 },
+	{ 87, 87, 87, 87, 88, 88, 88, 88, 87, 87, 87, 87, 88, 88, 88, 88 }
+};
+
 int16 Ima_ADPCMStream::decodeIMA(byte code, int channel) {
-	int32 E = (2 * (code & 0x7) + 1) * _imaTable[_status.ima_ch[channel].stepIndex] / 8;
-	int32 diff = (code & 0x08) ? -E : E;
-	int32 samp = CLIP<int32>(_status.ima_ch[channel].last + diff, -32768, 32767);
+	const int32 stepIndex = _status.ima_ch[channel].stepIndex;
+	int32 samp = CLIP<int32>(_status.ima_ch[channel].last + s_imaDiffTable[stepIndex][code], -32768, 32767);
 
 	_status.ima_ch[channel].last = samp;
-	_status.ima_ch[channel].stepIndex += _stepAdjustTable[code];
-	_status.ima_ch[channel].stepIndex = CLIP<int32>(_status.ima_ch[channel].stepIndex, 0, ARRAYSIZE(_imaTable) - 1);
+	_status.ima_ch[channel].stepIndex = s_imaNextStepTable[stepIndex][code];
 
 	return samp;
 }
@@ -182,21 +182,36 @@ public:
 		if (blockAlign % (_channels * 4))
 			error("MSIma_ADPCMStream(): invalid blockAlign");
 
-		_samplesLeft[0] = 0;
-		_samplesLeft[1] = 0;
+		// Every four bytes after the header hold eight samples of one channel
+		_blockData = new byte[blockAlign];
+		_blockSamples = new int16[blockAlign * 2];
+		_blockSampleCount = 0;
+		_blockSampleIndex = 0;
 	}
 
+	~MSIma_ADPCMStream() {
+		delete[] _blockData;
+		delete[] _blockSamples;
+	}
+
+	virtual bool endOfData() const { return ADPCMStream::endOfData() && (_blockSampleIndex == _blockSampleCount); }
+
 	virtual int readBuffer(int16 *buffer, const int numSamples);
 
 	void reset() {
 		Ima_ADPCMStream::reset();
-		_samplesLeft[0] = 0;
-		_samplesLeft[1] = 0;
+		_blockSampleCount = 0;
+		_blockSampleIndex = 0;
 	}
 
 private:
-	int16 _buffer[2][8];
-	int _samplesLeft[2];
+	void decodeBlock();
+
+	// The current block, decoded as a whole into interleaved samples
+	byte *_blockData;
+	int16 *_blockSamples;
+	uint32 _blockSampleCount;
+	uint32 _blockSampleIndex;
 };
 
 class MS_ADPCMStream : public ADPCMStream {
@@ -218,6 +233,8 @@ protected:
 	void reset() {
 		ADPCMStream::reset();
 		memset(&_status, 0, sizeof(_status));
+		_blockSampleCount = 0;
+		_blockSampleIndex = 0;
 	}
 
 public:
@@ -226,11 +243,20 @@ public:
 		if (blockAlign == 0)
 			error("MS_ADPCMStream(): blockAlign isn't specified for MS ADPCM");
 		memset(&_status, 0, sizeof(_status));
-		_decodedSampleCount = 0;
-		_decodedSampleIndex = 0;
+
+		// The header holds two samples per channel, every other byte two samples
+		_blockData = new byte[MAX<uint32>(blockAlign, _channels * 7)];
+		_blockSamples = new int16[MAX<uint32>(blockAlign, _channels * 7) * 2];
+		_blockSampleCount = 0;
+		_blockSampleIndex = 0;
 	}
 
-	virtual bool endOfData() const { return (_stream->eos() || _stream->pos() >= _endpos) && (_decodedSampleCount == 0); }
+	~MS_ADPCMStream() {
+		delete[] _blockData;
+		delete[] _blockSamples;
+	}
+
+	virtual bool endOfData() const { return (_stream->eos() || _stream->pos() >= _endpos) && (_blockSampleIndex == _blockSampleCount); }
 
 	virtual int readBuffer(int16 *buffer, const int numSamples);
 
@@ -238,9 +264,13 @@ protected:
 	int16 decodeMS(ADPCMChannelStatus *c, byte);
 
 private:
-	uint8 _decodedSampleCount;
-	uint8 _decodedSampleIndex;
-	int16 _decodedSamples[4];
+	void decodeBlock();
+
+	// The current block, decoded as a whole into interleaved samples
+	byte *_blockData;
+	int16 *_blockSamples;
+	uint32 _blockSampleCount;
+	uint32 _blockSampleIndex;
 };
 
 // Duck DK3 IMA ADPCM Decoder
@@ -289,34 +289,44 @@ void BaseMP3Stream::deinitStream() {
 	_state = MP3_STATE_EOS;
 }
 
-static inline int scaleSample(mad_fixed_t sample) {
+static inline int16 scaleSample(mad_fixed_t sample) {
 	// round
 	sample += (1L << (MAD_F_FRACBITS - 16));
 
 	// clip
-	if (sample > MAD_F_ONE - 1)
-		sample = MAD_F_ONE - 1;
-	else if (sample < -MAD_F_ONE)
-		sample = -MAD_F_ONE;
+	sample = CLIP<mad_fixed_t>(sample, -MAD_F_ONE, MAD_F_ONE - 1);
 
 	// quantize and scale to not saturate when mixing a lot of channels
-	return sample >> (MAD_F_FRACBITS + 1 - 16);
+	return (int16)(sample >> (MAD_F_FRACBITS + 1 - 16));
 }
 
 int BaseMP3Stream::fillBuffer(Common::ReadStream &stream, int16 *buffer, const int numSamples) {
 	int samples = 0;
 	// Keep going as long as we have input available
 	while (samples < numSamples && _state != MP3_STATE_EOS) {
-		const int len = MIN(numSamples, samples + (int)(_synth.pcm.length - _posInFrame) * MAD_NCHANNELS(&_frame.header));
-		while (samples < len) {
-			*buffer++ = (int16)scaleSample(_synth.pcm.samples[0][_posInFrame]);
-			samples++;
-			if (MAD_NCHANNELS(&_frame.header) == 2) {
-				*buffer++ = (int16)scaleSample(_synth.pcm.samples[1][_posInFrame]);
-				samples++;
+		const uint channels = MAD_NCHANNELS(&_frame.header);
+
+		// Convert as many whole sample frames as fit, interleaving the
+		// channels in the same pass
+		const uint frames = MIN<uint>((numSamples - samples) / channels, _synth.pcm.length - _posInFrame);
+		if (!frames && _posInFrame < _synth.pcm.length)
+			break;
+
+		const mad_fixed_t *left = &_synth.pcm.samples[0][_posInFrame];
+		if (channels == 2) {
+			const mad_fixed_t *right = &_synth.pcm.samples[1][_posInFrame];
+			for (uint i = 0; i < frames; i++) {
+				*buffer++ = scaleSample(left[i]);
+				*buffer++ = scaleSample(right[i]);
 			}
-			_posInFrame++;
+		} else {
+			for (uint i = 0; i < frames; i++)
+				*buffer++ = scaleSample(left[i]);
 		}
+
+		samples += frames * channels;
+		_posInFrame += frames;
+
 		if (_posInFrame >= _synth.pcm.length) {
 			// We used up all PCM data in the current frame -- read & decode more
 			decodeMP3Data(stream);
@@ -469,7 +479,12 @@ int PacketizedMP3Stream::readBuffer(int16 *buffer, const int numSamples) {
 			_state = MP3_STATE_READY;
 		}
 
-		samples += fillBuffer(*packet, buffer + samples, numSamples - samples);
+		const int read = fillBuffer(*packet, buffer + samples, numSamples - samples);
+		samples += read;
+
+		// No room left for a whole sample frame
+		if (!read && _state == MP3_STATE_READY)
+			break;
 
 		// If the stream is done, kill it
 		if (packet->pos() >= packet->size()) {
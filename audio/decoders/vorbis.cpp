@@ -117,6 +117,12 @@ public:
 	Timestamp getLength() const override { return _length; }
 protected:
 	bool refill();
+
+	/**
+	 * Decode up to the given number of bytes of interleaved 16-bit PCM,
+	 * skipping over holes in the data.
+	 */
+	long readPCM(char *buffer, int length);
 };
 
 VorbisStream::VorbisStream(Common::SeekableReadStream *inStream, DisposeAfterUse::Flag dispose) :
@@ -159,6 +165,17 @@ int VorbisStream::readBuffer(int16 *buffer, const int numSamples) {
 		_pos += len;
 		samples += len;
 		if (_pos >= _bufferEnd) {
+			// Decode large requests straight into the caller's buffer,
+			// without going through our own
+			while (numSamples - samples >= (int)ARRAYSIZE(_buffer)) {
+				const long result = readPCM((char *)buffer, (numSamples - samples) * 2);
+				if (result <= 0)
+					break;
+
+				buffer += result / 2;
+				samples += result / 2;
+			}
+
 			if (!refill())
 				break;
 		}
@@ -179,29 +196,25 @@ bool VorbisStream::seek(const Timestamp &where) {
 	return refill();
 }
 
-bool VorbisStream::refill() {
-	// Read the samples
-	uint len_left = sizeof(_buffer);
-	char *read_pos = (char *)_buffer;
-
-	while (len_left > 0) {
-		long result;
+long VorbisStream::readPCM(char *buffer, int length) {
+	long result;
 
+	do {
 #ifdef USE_TREMOR
 		// Tremor ov_read() always returns data as signed 16 bit interleaved PCM
 		// in host byte order. As such, it does not take arguments to request
 		// specific signedness, byte order or bit depth as in Vorbisfile.
-		result = ov_read(&_ovFile, read_pos, len_left,
+		result = ov_read(&_ovFile, buffer, length,
 						NULL);
 #else
 #ifdef SCUMM_BIG_ENDIAN
-		result = ov_read(&_ovFile, read_pos, len_left,
+		result = ov_read(&_ovFile, buffer, length,
 						1,
 						2,	// 16 bit
 						1,	// signed
 						NULL);
 #else
-		result = ov_read(&_ovFile, read_pos, len_left,
+		result = ov_read(&_ovFile, buffer, length,
 						0,
 						2,	// 16 bit
 						1,	// signed
@@ -211,7 +224,21 @@ bool VorbisStream::refill() {
 		if (result == OV_HOLE) {
 			// Possibly recoverable, just warn about it
 			warning("Corrupted data in Vorbis file");
-		} else if (result == 0) {
+		}
+	} while (result == OV_HOLE);
+
+	return result;
+}
+
+bool VorbisStream::refill() {
+	// Read the samples
+	uint len_left = sizeof(_buffer);
+	char *read_pos = (char *)_buffer;
+
+	while (len_left > 0) {
+		const long result = readPCM(read_pos, len_left);
+
+		if (result == 0) {
 			//warning("End of file while reading from Vorbis file");
 			//_pos = _bufferEnd;
 			//return false;
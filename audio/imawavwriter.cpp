@@ -0,0 +1,174 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/stream.h"
+#include "common/util.h"
+
+#include "audio/imawavwriter.h"
+#include "audio/decoders/adpcm_intern.h"
+#include "audio/decoders/wave_types.h"
+
+namespace Audio {
+
+IMAWAVWriter::IMAWAVWriter(Common::SeekableWriteStream *stream, int rate, bool stereo)
+	: _stream(stream), _rate(rate), _channels(stereo ? 2 : 1), _blockFill(0), _dataSize(0),
+	  _hasLoop(false), _loopStart(0), _loopEnd(0), _loopPlayCount(0) {
+	for (int i = 0; i < 2; i++) {
+		_state[i].last = 0;
+		_state[i].stepIndex = 0;
+	}
+	_block = new int16[kBlockSamples * _channels];
+
+	const uint32 blockAlign = kChannelBlockSize * _channels;
+
+	// The RIFF and data sizes are written by finish()
+	_stream->writeUint32BE(MKTAG('R', 'I', 'F', 'F'));
+	_stream->writeUint32LE(0);
+	_stream->writeUint32BE(MKTAG('W', 'A', 'V', 'E'));
+	_stream->writeUint32BE(MKTAG('f', 'm', 't', ' '));
+	_stream->writeUint32LE(20);
+	_stream->writeUint16LE(kWaveFormatMSIMAADPCM);
+	_stream->writeUint16LE(_channels);
+	_stream->writeUint32LE(rate);
+	_stream->writeUint32LE(rate * blockAlign / kBlockSamples);
+	_stream->writeUint16LE(blockAlign);
+	_stream->writeUint16LE(4);
+	_stream->writeUint16LE(2);
+	// Other decoders also play the sample in the block header
+	_stream->writeUint16LE(kBlockSamples + 1);
+	_stream->writeUint32BE(MKTAG('d', 'a', 't', 'a'));
+	_stream->writeUint32LE(0);
+}
+
+IMAWAVWriter::~IMAWAVWriter() {
+	delete[] _block;
+}
+
+void IMAWAVWriter::write(const int16 *samples, uint32 count) {
+	while (count > 0) {
+		const uint32 frames = MIN<uint32>(count / _channels, kBlockSamples - _blockFill);
+		memcpy(_block + _blockFill * _channels, samples, frames * _channels * sizeof(int16));
+		_blockFill += frames;
+		samples += frames * _channels;
+		count -= frames * _channels;
+
+		if (_blockFill == kBlockSamples)
+			writeBlock();
+	}
+}
+
+void IMAWAVWriter::setLoop(uint32 start, uint32 end, uint32 playCount) {
+	_hasLoop = true;
+	_loopStart = start;
+	_loopEnd = end;
+	_loopPlayCount = playCount;
+}
+
+bool IMAWAVWriter::finish() {
+	if (_blockFill > 0)
+		writeBlock();
+
+	// The blocks have an even size, so no padding is needed
+	uint32 loopSize = 0;
+	if (_hasLoop) {
+		loopSize = 8 + 36 + 24;
+		_stream->writeUint32BE(MKTAG('s', 'm', 'p', 'l'));
+		_stream->writeUint32LE(36 + 24);
+		_stream->writeUint32LE(0); // Manufacturer
+		_stream->writeUint32LE(0); // Product
+		_stream->writeUint32LE(1000000000 / _rate); // Sample period in ns
+		_stream->writeUint32LE(60); // MIDI unity note
+		_stream->writeUint32LE(0); // MIDI pitch fraction
+		_stream->writeUint32LE(0); // SMPTE format
+		_stream->writeUint32LE(0); // SMPTE offset
+		_stream->writeUint32LE(1); // Loop count
+		_stream->writeUint32LE(0); // Sampler data size
+		_stream->writeUint32LE(0); // Cue point ID
+		_stream->writeUint32LE(0); // Forward loop
+		_stream->writeUint32LE(_loopStart);
+		_stream->writeUint32LE(_loopEnd - 1); // The last frame is included
+		_stream->writeUint32LE(0); // Fraction
+		_stream->writeUint32LE(_loopPlayCount);
+	}
+
+	_stream->seek(4, SEEK_SET);
+	_stream->writeUint32LE(4 + 8 + 20 + 8 + _dataSize + loopSize);
+	_stream->seek(12 + 8 + 20 + 4, SEEK_SET);
+	_stream->writeUint32LE(_dataSize);
+	_stream->seek(0, SEEK_END);
+
+	return _stream->flush() && !_stream->err();
+}
+
+// Picks the code the decoder turns into the closest sample, and updates
+// the state the same way as the decoder
+byte IMAWAVWriter::encodeSample(int16 sample, Channel &channel) {
+	const int32 step = Ima_ADPCMStream::_imaTable[channel.stepIndex];
+	int32 diff = sample - channel.last;
+	byte code = 0;
+
+	if (diff < 0) {
+		code = 8;
+		diff = -diff;
+	}
+	code |= MIN<int32>(diff * 4 / step, 7);
+
+	const int32 delta = (2 * (code & 7) + 1) * step / 8;
+	channel.last = CLIP<int32>(channel.last + ((code & 8) ? -delta : delta), -32768, 32767);
+	channel.stepIndex = CLIP<int32>(channel.stepIndex + ADPCMStream::_stepAdjustTable[code], 0, ARRAYSIZE(Ima_ADPCMStream::_imaTable) - 1);
+
+	return code;
+}
+
+void IMAWAVWriter::writeBlock() {
+	for (int i = 0; i < _channels; i++) {
+		_stream->writeUint16LE((uint16)(int16)_state[i].last);
+		_stream->writeByte(_state[i].stepIndex);
+		_stream->writeByte(0);
+	}
+
+	// The last group is completed by repeating the last sample
+	const uint32 groups = (_blockFill + 7) / 8;
+	for (uint32 frame = _blockFill; frame < groups * 8; frame++) {
+		for (int i = 0; i < _channels; i++)
+			_block[frame * _channels + i] = _block[(_blockFill - 1) * _channels + i];
+	}
+
+	// Each group holds eight samples of the first channel, then eight of
+	// the second one
+	for (uint32 group = 0; group < groups; group++) {
+		for (int i = 0; i < _channels; i++) {
+			const int16 *src = _block + group * 8 * _channels + i;
+
+			for (int j = 0; j < 4; j++) {
+				const byte low = encodeSample(src[0], _state[i]);
+				const byte high = encodeSample(src[_channels], _state[i]);
+				_stream->writeByte(low | (high << 4));
+				src += _channels * 2;
+			}
+		}
+	}
+
+	_dataSize += 4 * _channels + groups * 4 * _channels;
+	_blockFill = 0;
+}
+
+} // End of namespace Audio
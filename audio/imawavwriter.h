@@ -0,0 +1,113 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef AUDIO_IMAWAVWRITER_H
+#define AUDIO_IMAWAVWRITER_H
+
+#include "common/types.h"
+
+namespace Common {
+class SeekableWriteStream;
+}
+
+namespace Audio {
+
+/**
+ * @defgroup audio_imawavwriter IMA ADPCM WAV writer
+ * @ingroup audio
+ *
+ * @brief Encoder for WAV files compressed with MS IMA ADPCM.
+ * @{
+ */
+
+/**
+ * Writes 16-bit samples to a WAV file compressed with MS IMA ADPCM, which
+ * takes a quarter of the size of the samples and can be played with
+ * makeWAVStream().
+ */
+class IMAWAVWriter {
+public:
+	/**
+	 * Start a WAV file. The sizes in the header are only set by finish(),
+	 * so an unfinished file is not recognised as a WAV file.
+	 *
+	 * @param stream  The stream to write to, which must be empty. It is
+	 *                not deleted by the writer.
+	 */
+	IMAWAVWriter(Common::SeekableWriteStream *stream, int rate, bool stereo);
+	~IMAWAVWriter();
+
+	/**
+	 * Encode interleaved samples.
+	 *
+	 * @param count  The number of samples, a multiple of the channel count.
+	 */
+	void write(const int16 *samples, uint32 count);
+
+	/**
+	 * Set a loop, which finish() writes in a 'smpl' chunk after the data.
+	 *
+	 * @param start      The first frame of the loop.
+	 * @param end        The frame after the last one of the loop.
+	 * @param playCount  How often the loop is played, 0 for forever.
+	 */
+	void setLoop(uint32 start, uint32 end, uint32 playCount);
+
+	/**
+	 * Write the last block and the sizes in the header.
+	 *
+	 * @return  Whether all the data could be written.
+	 */
+	bool finish();
+
+private:
+	enum {
+		/** Bytes per block and channel, header included */
+		kChannelBlockSize = 1024,
+		/** Samples per block and channel, each four bytes holding eight */
+		kBlockSamples = (kChannelBlockSize - 4) * 2
+	};
+
+	struct Channel {
+		int32 last;
+		int32 stepIndex;
+	};
+
+	void writeBlock();
+	byte encodeSample(int16 sample, Channel &channel);
+
+	Common::SeekableWriteStream *_stream;
+	const int _rate;
+	const int _channels;
+	Channel _state[2];
+	int16 *_block;
+	uint32 _blockFill;
+	uint32 _dataSize;
+	bool _hasLoop;
+	uint32 _loopStart;
+	uint32 _loopEnd;
+	uint32 _loopPlayCount;
+};
+
+/** @} */
+} // End of namespace Audio
+
+#endif
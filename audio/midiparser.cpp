@@ -44,6 +44,8 @@ _centerPitchWheelOnUnload(false),
 _sendSustainOffOnNotesOff(false),
 _disableAllNotesOffMidiEvents(false),
 _disableAutoStartPlayback(false),
+_stopAtInfiniteLoop(false),
+_atInfiniteLoop(false),
 _numTracks(0),
 _activeTrack(255),
 _abortParse(false),
@@ -78,6 +80,9 @@ void MidiParser::property(int prop, int value) {
 	case mpDisableAutoStartPlayback:
 		_disableAutoStartPlayback = (value != 0);
 		break;
+	case mpStopAtInfiniteLoop:
+		_stopAtInfiniteLoop = (value != 0);
+		break;
 	default:
 		break;
 	}
@@ -349,6 +354,7 @@ void MidiParser::allNotesOff() {
 
 void MidiParser::resetTracking() {
 	_position.clear();
+	_atInfiniteLoop = false;
 }
 
 bool MidiParser::setTrack(int track) {
@@ -304,6 +304,8 @@ protected:
 	bool   _sendSustainOffOnNotesOff;   ///< Send a sustain off on a notes off event, stopping hanging notes
 	bool   _disableAllNotesOffMidiEvents;   ///< Don't send All Notes Off MIDI messages
 	bool   _disableAutoStartPlayback;  ///< Do not automatically start playback after parsing MIDI data or setting the track
+	bool   _stopAtInfiniteLoop;  ///< End the track where it would loop forever
+	bool   _atInfiniteLoop;      ///< The next end of track replaces an infinite loop
 	byte  *_tracks[MAXIMUM_TRACKS];    ///< Multi-track MIDI formats are supported, up to 120 tracks.
 	byte   _numTracks;     ///< Count of total tracks for multi-track MIDI formats. 1 for single-track formats.
 	byte   _activeTrack;   ///< Keeps track of the currently active track, in multi-track formats.
@@ -418,7 +420,14 @@ public:
 		  * or setting the track. Use startPlaying to start playback.
 		  * Note that not every parser implementation might support this.
 		  */
-		 mpDisableAutoStartPlayback = 7
+		 mpDisableAutoStartPlayback = 7,
+
+		 /**
+		  * Ends the track where it would loop back forever, e.g. to render
+		  * it offline. Finite loops are still played. Only XMIDI has such
+		  * loops.
+		  */
+		 mpStopAtInfiniteLoop = 8
 	};
 
 public:
@@ -487,6 +496,12 @@ public:
 	uint32 getPPQN() { return _ppqn; }
 	virtual uint32 getTick() { return _position._playTick; }
 
+	/**
+	 * Check whether the end of track event sent last, or about to be sent,
+	 * replaces an infinite loop, see mpStopAtInfiniteLoop.
+	 */
+	bool isAtInfiniteLoop() const { return _atInfiniteLoop; }
+
 	static void defaultXMidiCallback(byte eventData, void *refCon);
 
 	static MidiParser *createParser_SMF(int8 source = -1);
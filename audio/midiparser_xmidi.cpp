@@ -236,6 +236,13 @@ void MidiParser_XMIDI::parseNextEvent(EventInfo &info) {
 							_position._playPos = _loop[_loopCount].pos;
 							info.loop = true;
 						}
+					} else if (_stopAtInfiniteLoop) {
+						// Turn the loop into the end of the track
+						_atInfiniteLoop = true;
+						info.event = 0xFF;
+						info.ext.type = 0x2F;
+						info.ext.data = _position._playPos;
+						info.length = 0;
 					} else {
 						_position._playPos = _loop[_loopCount].pos;
 						info.loop = true;
@@ -21,8 +21,10 @@
 
 #include "audio/midiplayer.h"
 #include "audio/midiparser.h"
+#include "audio/audiostream.h"
 
 #include "common/config-manager.h"
+#include "common/system.h"
 
 namespace Audio {
 
@@ -33,7 +35,13 @@ MidiPlayer::MidiPlayer() :
 	_isLooping(false),
 	_isPlaying(false),
 	_masterVolume(0),
-	_nativeMT32(false) {
+	_nativeMT32(false),
+	_prerenderer(nullptr),
+	_synthReleased(false),
+	_prerenderedStream(nullptr),
+	_playingPrerendered(false),
+	_stopPrerendered(false),
+	_updatePrerendered(false) {
 
 	memset(_channelsTable, 0, sizeof(_channelsTable));
 	memset(_channelsVolume, 127, sizeof(_channelsVolume));
@@ -42,6 +50,8 @@ MidiPlayer::MidiPlayer() :
 }
 
 MidiPlayer::~MidiPlayer() {
+	stopPrerendering();
+
 	// FIXME/TODO: In some engines, stop() was called first;
 	// in others, _driver->setTimerCallback(NULL, NULL) came first.
 	// Hopefully, this make no real difference, but we should
@@ -55,6 +65,10 @@ MidiPlayer::~MidiPlayer() {
 		delete _driver;
 		_driver = nullptr;
 	}
+
+	// The timer doesn't run any more
+	g_system->getMixer()->stopHandle(_prerenderedHandle);
+	delete _prerenderedStream;
 }
 
 void MidiPlayer::createDriver(int flags) {
@@ -65,6 +79,99 @@ void MidiPlayer::createDriver(int flags) {
 	assert(_driver);
 	if (_nativeMT32)
 		_driver->property(MidiDriver::PROP_CHANNEL_MASK, 0x03FE);
+
+	if (MidiPrerenderer::isAvailable(dev))
+		_prerenderer = new MidiPrerenderer(_driver, dev, _nativeMT32, this);
+}
+
+void MidiPlayer::prerenderTrack(const byte *data, uint32 size, MidiPrerenderer::Format format, int track) {
+	if (_prerenderer)
+		_prerenderer->queueTrack(data, size, format, track);
+}
+
+bool MidiPlayer::playPrerendered(const byte *data, uint32 size, MidiPrerenderer::Format format, bool loop, int track) {
+	if (!_prerenderer)
+		return false;
+
+	Common::StackLock lock(_mutex);
+
+	AudioStream *stream = _prerenderer->openTrack(data, size, format, loop, track);
+	if (!stream) {
+		// The caller plays the track through the synth meanwhile
+		acquireSynth();
+		_prerenderer->queueTrack(data, size, format, track);
+		return false;
+	}
+
+	// Started by the next timer call
+	if (_playingPrerendered)
+		_stopPrerendered = true;
+	delete _prerenderedStream;
+	_prerenderedStream = stream;
+
+	_isLooping = loop;
+	_isPlaying = true;
+	_playingPrerendered = true;
+
+	// The synth isn't needed until the next track
+	releaseSynth();
+	return true;
+}
+
+void MidiPlayer::stopPrerendering() {
+	// Take the synth back for good
+	delete _prerenderer;
+	_prerenderer = nullptr;
+	_synthReleased = false;
+}
+
+void MidiPlayer::acquireSynth() {
+	if (!_synthReleased)
+		return;
+
+	_prerenderer->acquireSynth();
+	_synthReleased = false;
+
+	// The synth was reset after rendering, and the channel volumes are
+	// the ones of the rendered tracks
+	memset(_channelsVolume, 127, sizeof(_channelsVolume));
+	for (int i = 0; i < kNumChannels; ++i) {
+		if (_channelsTable[i]) {
+			_channelsTable[i]->volume(_channelsVolume[i] * _masterVolume / 255);
+		}
+	}
+}
+
+void MidiPlayer::releaseSynth() {
+	if (!_prerenderer || _synthReleased)
+		return;
+
+	_synthReleased = true;
+	_prerenderer->releaseSynth();
+}
+
+void MidiPlayer::updatePrerendered() {
+	Mixer *mixer = g_system->getMixer();
+
+	if (_stopPrerendered) {
+		mixer->stopHandle(_prerenderedHandle);
+		_stopPrerendered = false;
+	}
+
+	if (_prerenderedStream) {
+		// The volume is applied like for the output of the driver
+		mixer->playStream(Mixer::kPlainSoundType, &_prerenderedHandle, _prerenderedStream, -1, _masterVolume);
+		_prerenderedStream = nullptr;
+	} else if (_playingPrerendered && !mixer->isSoundHandleActive(_prerenderedHandle)) {
+		_isPlaying = false;
+		_playingPrerendered = false;
+	}
+
+	if (_updatePrerendered) {
+		mixer->setChannelVolume(_prerenderedHandle, _masterVolume);
+		mixer->pauseHandle(_prerenderedHandle, _playingPrerendered && !_isPlaying);
+		_updatePrerendered = false;
+	}
 }
 
 
@@ -76,6 +183,12 @@ void MidiPlayer::setVolume(int volume) {
 	Common::StackLock lock(_mutex);
 
 	_masterVolume = volume;
+	_updatePrerendered = true;
+
+	// The channels are sent the volume when the synth is taken back
+	if (_synthReleased)
+		return;
+
 	for (int i = 0; i < kNumChannels; ++i) {
 		if (_channelsTable[i]) {
 			_channelsTable[i]->volume(_channelsVolume[i] * _masterVolume / 255);
@@ -93,12 +206,15 @@ void MidiPlayer::syncVolume() {
 
 
 void MidiPlayer::send(uint32 b) {
+	// While the synth is released, this is only called by the prerenderer
 	byte ch = (byte)(b & 0x0F);
 	if ((b & 0xFFF0) == 0x07B0) {
-		// Adjust volume changes by master volume
+		// Adjust volume changes by master volume. The mixer applies it to
+		// the rendered tracks instead.
 		byte volume = (byte)((b >> 16) & 0x7F);
 		_channelsVolume[ch] = volume;
-		volume = volume * _masterVolume / 255;
+		if (!_synthReleased)
+			volume = volume * _masterVolume / 255;
 		b = (b & 0xFF00FFFF) | (volume << 16);
 	} else if ((b & 0xFFF0) == 0x007BB0) {
 		// Only respond to All Notes Off if this channel
@@ -153,8 +269,13 @@ void MidiPlayer::onTimer() {
 	// by a simple check for "_parser != 0" ?
 
 	if (_isPlaying && _parser) {
+		// Tracks are no longer rendered with the synth once it's played
+		// through again
+		acquireSynth();
 		_parser->onTimer();
 	}
+
+	updatePrerendered();
 }
 
 
@@ -162,7 +283,14 @@ void MidiPlayer::stop() {
 	Common::StackLock lock(_mutex);
 
 	_isPlaying = false;
+	if (_playingPrerendered) {
+		_stopPrerendered = true;
+		delete _prerenderedStream;
+		_prerenderedStream = nullptr;
+		_playingPrerendered = false;
+	}
 	if (_parser) {
+		acquireSynth();
 		_parser->unloadMusic();
 
 		// FIXME/TODO: The MidiParser destructor calls allNotesOff()
@@ -177,18 +305,23 @@ void MidiPlayer::stop() {
 
 	free(_midiData);
 	_midiData = nullptr;
+
+	// Let the queued tracks be rendered until the next one is played
+	releaseSynth();
 }
 
 void MidiPlayer::pause() {
 //	debugC(2, kDraciSoundDebugLevel, "Pausing track %d", _track);
 	_isPlaying = false;
 	setVolume(-1);	// FIXME: This should be 0, shouldn't it?
+	_updatePrerendered = true;
 }
 
 void MidiPlayer::resume() {
 //	debugC(2, kDraciSoundDebugLevel, "Resuming track %d", _track);
 	syncVolume();
 	_isPlaying = true;
+	_updatePrerendered = true;
 }
 
 } // End of namespace Audio
@@ -25,6 +25,8 @@
 #include "common/scummsys.h"
 #include "common/mutex.h"
 #include "audio/mididrv.h"
+#include "audio/midiprerender.h"
+#include "audio/mixer.h"
 
 class MidiParser;
 
@@ -121,6 +123,19 @@ public:
 	// TODO: Document this
 	bool hasNativeMT32() const { return _nativeMT32; }
 
+	/**
+	 * Render a track in the background, so that playPrerendered() can
+	 * play it later on. Does nothing unless pre-rendering is enabled.
+	 *
+	 * Tracks are rendered with the driver while the player doesn't play
+	 * through it, see MidiPrerenderer. Their events go through send() and
+	 * sendToChannel() on the render thread, so subclasses map them like
+	 * the tracks they play. Engines must then only send data to the driver
+	 * through a parser set in _parser, or after playPrerendered() returned
+	 * false, which take the driver back.
+	 */
+	void prerenderTrack(const byte *data, uint32 size, MidiPrerenderer::Format format, int track = 0);
+
 	// MidiDriver_BASE implementation
 	void send(uint32 b) override;
 	void metaEvent(byte type, byte *data, uint16 length) override;
@@ -148,6 +163,28 @@ protected:
 
 	void createDriver(int flags = MDT_MIDI | MDT_ADLIB | MDT_PREFER_GM);
 
+	/**
+	 * Play a track rendered by MidiPrerenderer instead of sending it to
+	 * the driver. If the track isn't rendered yet, it is queued for
+	 * rendering, and the caller has to play it through the driver.
+	 *
+	 * @return  Whether the rendered track is playing.
+	 */
+	bool playPrerendered(const byte *data, uint32 size, MidiPrerenderer::Format format, bool loop, int track = 0);
+
+	/**
+	 * Stop rendering tracks for good. Subclasses which override send() or
+	 * sendToChannel() must call this in their destructor, since the render
+	 * thread calls them.
+	 */
+	void stopPrerendering();
+
+	/** Take the synth back from the prerenderer, see MidiPrerenderer. */
+	void acquireSynth();
+	/** Let the prerenderer render the queued tracks with the synth. */
+	void releaseSynth();
+	void updatePrerendered();
+
 protected:
 	enum {
 		/**
@@ -187,6 +224,23 @@ protected:
 	int _masterVolume;	// FIXME: byte or int ?
 
 	bool _nativeMT32;
+
+	/**
+	 * Set by createDriver() when pre-rendering is enabled for the device.
+	 */
+	MidiPrerenderer *_prerenderer;
+	bool _synthReleased;
+
+	/**
+	 * The timer of the driver may be called with the mixer locked, so the
+	 * rendered tracks are only started, stopped and updated from there,
+	 * in updatePrerendered().
+	 */
+	SoundHandle _prerenderedHandle;
+	AudioStream *_prerenderedStream;
+	bool _playingPrerendered;
+	bool _stopPrerendered;
+	bool _updatePrerendered;
 };
 
 /** @} */
@@ -0,0 +1,472 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "audio/midiprerender.h"
+#include "audio/audiostream.h"
+#include "audio/imawavwriter.h"
+#include "audio/midiparser.h"
+#include "audio/decoders/wave.h"
+#include "audio/softsynth/emumidi.h"
+
+#include "common/config-manager.h"
+#include "common/debug.h"
+#include "common/file.h"
+#include "common/fs.h"
+#include "common/stream.h"
+#include "common/system.h"
+#include "common/textconsole.h"
+
+namespace Audio {
+
+namespace {
+
+// FNV-1a
+uint32 hashBytes(uint32 hash, const byte *data, uint32 size) {
+	for (uint32 i = 0; i < size; i++)
+		hash = (hash ^ data[i]) * 16777619u;
+	return hash;
+}
+
+uint32 hashString(uint32 hash, const Common::String &str) {
+	return hashBytes(hash, (const byte *)str.c_str(), str.size() + 1);
+}
+
+uint32 hashFile(uint32 hash, const char *const *names) {
+	Common::File file;
+	for (; *names; names++) {
+		if (!file.open(*names))
+			continue;
+
+		byte buffer[4096];
+		uint32 size;
+		while ((size = file.read(buffer, sizeof(buffer))) > 0)
+			hash = hashBytes(hash, buffer, size);
+		return hash;
+	}
+	return hash;
+}
+
+// Reads the first loop of the 'smpl' chunk written by IMAWAVWriter
+bool readLoop(Common::SeekableReadStream &stream, uint32 &start, uint32 &end, uint32 &playCount) {
+	stream.seek(12);
+	while (!stream.eos() && !stream.err()) {
+		const uint32 tag = stream.readUint32BE();
+		const uint32 size = stream.readUint32LE();
+		if (stream.eos())
+			break;
+
+		if (tag == MKTAG('s', 'm', 'p', 'l') && size >= 36 + 24) {
+			stream.skip(28);
+			const uint32 loops = stream.readUint32LE();
+			stream.skip(4 + 8);
+			start = stream.readUint32LE();
+			end = stream.readUint32LE() + 1;
+			stream.skip(4);
+			playCount = stream.readUint32LE();
+			return loops > 0 && !stream.eos() && start < end;
+		}
+
+		stream.skip(size + (size & 1));
+	}
+	return false;
+}
+
+} // End of anonymous namespace
+
+/**
+ * Passes the events of the track being rendered on to the player, and
+ * finds where the track ends and loops.
+ */
+class MidiPrerenderer::TrackOutput : public MidiDriver_BASE {
+public:
+	TrackOutput(MidiDriver_BASE *output, MidiParser *parser, bool xmidi) :
+		frames(0), ended(false), infiniteLoop(false), loopStart(0), loopEnd(0),
+		_output(output), _parser(parser), _xmidi(xmidi), _loopCount(-1) {}
+
+	void send(uint32 b) override;
+	void sysEx(const byte *msg, uint16 length) override { _output->sysEx(msg, length); }
+	uint16 sysExNoDelay(const byte *msg, uint16 length) override { return _output->sysExNoDelay(msg, length); }
+	void metaEvent(byte type, byte *data, uint16 length) override;
+
+	/** The frames rendered before the events being sent */
+	uint32 frames;
+	bool ended;
+	/** Whether the track loops from loopStart to loopEnd forever by itself */
+	bool infiniteLoop;
+	uint32 loopStart;
+	uint32 loopEnd;
+
+private:
+	MidiDriver_BASE *const _output;
+	MidiParser *const _parser;
+	const bool _xmidi;
+
+	// The XMIDI loops, followed like MidiParser_XMIDI does, with the frame
+	// each one starts at
+	struct Loop {
+		uint32 frame;
+		byte repeat;
+	};
+	Loop _loops[4];
+	int _loopCount;
+};
+
+void MidiPrerenderer::TrackOutput::send(uint32 b) {
+	if (_xmidi && (b & 0xF0) == 0xB0) {
+		const byte value = (b >> 16) & 0x7F;
+		switch ((b >> 8) & 0xFF) {
+		case 0x74: // XMIDI_CONTROLLER_FOR_LOOP
+			if (_loopCount < ARRAYSIZE(_loops) - 1)
+				_loopCount++;
+			_loops[_loopCount].frame = frames;
+			_loops[_loopCount].repeat = value;
+			break;
+		case 0x75: // XMIDI_CONTROLLER_NEXT_BREAK
+			// The parser ends the track instead of looping forever
+			if (_loopCount >= 0 && (value < 64 || --_loops[_loopCount].repeat == 0))
+				_loopCount--;
+			break;
+		default:
+			break;
+		}
+	}
+
+	_output->send(b);
+}
+
+void MidiPrerenderer::TrackOutput::metaEvent(byte type, byte *data, uint16 length) {
+	if (type != 0x2F)
+		return;
+
+	ended = true;
+	loopEnd = frames;
+	if (_parser->isAtInfiniteLoop() && _loopCount >= 0) {
+		infiniteLoop = true;
+		loopStart = _loops[_loopCount].frame;
+	}
+}
+
+MidiPrerenderer::MidiPrerenderer(MidiDriver *driver, MidiDriver::DeviceHandle device, bool mt32, MidiDriver_BASE *output)
+	: _driver(driver), _synth(dynamic_cast<MidiDriver_Emulated *>(driver)), _output(output), _device(device), _mt32(mt32),
+	  _setupHash(0), _running(false), _quit(false), _synthReleased(false), _rendering(false) {
+	assert(_synth);
+	_path = ConfMan.get("midi_prerender_path");
+}
+
+MidiPrerenderer::~MidiPrerenderer() {
+	{
+		Common::StackLock lock(_mutex);
+		_quit = true;
+	}
+	_thread.join();
+
+	for (uint i = 0; i < _jobs.size(); i++)
+		free(_jobs[i].data);
+}
+
+bool MidiPrerenderer::isAvailable(MidiDriver::DeviceHandle device) {
+	if (ConfMan.get("midi_prerender_path").empty())
+		return false;
+
+	const Common::String driver = MidiDriver::getDeviceString(device, MidiDriver::kDriverId);
+	return driver == "mt32" || driver == "fluidsynth";
+}
+
+uint32 MidiPrerenderer::getSetupHash() const {
+	const Common::String driver = MidiDriver::getDeviceString(_device, MidiDriver::kDriverId);
+
+	uint32 hash = 2166136261u;
+	hash = hashString(hash, Common::String::format("%d %s %d %d %d", kRenderVersion, driver.c_str(), _mt32, _synth->getRate(), ConfMan.getInt("midi_gain")));
+
+	if (driver == "mt32") {
+		// The driver uses the first ROMs it finds
+		static const char *const controlROMs[] = { "CM32L_CONTROL.ROM", "MT32_CONTROL.ROM", nullptr };
+		static const char *const pcmROMs[] = { "CM32L_PCM.ROM", "MT32_PCM.ROM", nullptr };
+		hash = hashFile(hash, controlROMs);
+		hash = hashFile(hash, pcmROMs);
+	} else {
+		static const char *const keys[] = {
+			"soundfont",
+			"fluidsynth_chorus_activate", "fluidsynth_chorus_nr", "fluidsynth_chorus_level",
+			"fluidsynth_chorus_speed", "fluidsynth_chorus_depth", "fluidsynth_chorus_waveform",
+			"fluidsynth_reverb_activate", "fluidsynth_reverb_roomsize", "fluidsynth_reverb_damping",
+			"fluidsynth_reverb_width", "fluidsynth_reverb_level",
+			"fluidsynth_misc_interpolation", "fluidsynth_misc_polyphony"
+		};
+		for (uint i = 0; i < ARRAYSIZE(keys); i++)
+			hash = hashString(hash, ConfMan.get(keys[i]));
+	}
+
+	return hash;
+}
+
+Common::String MidiPrerenderer::getFileName(const byte *data, uint32 size, Format format, int track) {
+	// The ROMs are only read once, the settings can't change while the
+	// driver is open
+	if (!_setupHash)
+		_setupHash = getSetupHash();
+
+	const Common::String driver = MidiDriver::getDeviceString(_device, MidiDriver::kDriverId);
+	const uint32 hash = hashBytes(_setupHash, data, size);
+
+	return Common::String::format("%s-%08x-%u-%c%d.wav", driver.c_str(), hash, size, format == kFormatXMIDI ? 'x' : 's', track);
+}
+
+AudioStream *MidiPrerenderer::openTrack(const byte *data, uint32 size, Format format, bool loop, int track) {
+	Common::FSNode file = Common::FSNode(_path).getChild(getFileName(data, size, format, track));
+	if (!file.exists())
+		return nullptr;
+
+	// Tracks being rendered aren't valid WAV files yet
+	Common::StackLock lock(_mutex);
+	if (!_jobs.empty() && _jobs[0].fileName == file.getName())
+		return nullptr;
+
+	Common::SeekableReadStream *stream = file.createReadStream();
+	if (!stream)
+		return nullptr;
+
+	uint32 loopStart = 0, loopEnd = 0, playCount = 1;
+	const bool hasLoop = readLoop(*stream, loopStart, loopEnd, playCount);
+	stream->seek(0);
+
+	SeekableAudioStream *wav = makeWAVStream(stream, DisposeAfterUse::YES);
+	if (!wav)
+		return nullptr;
+
+	if (!hasLoop || (!loop && playCount != 0))
+		return wav;
+
+	// The release after the end of the track is only played when it
+	// doesn't loop
+	const int rate = wav->getRate();
+	return new SubLoopingAudioStream(wav, 0, Timestamp(0, loopStart, rate), Timestamp(0, loopEnd, rate));
+}
+
+void MidiPrerenderer::queueTrack(const byte *data, uint32 size, Format format, int track) {
+	Job job;
+	job.fileName = getFileName(data, size, format, track);
+
+	Common::StackLock lock(_mutex);
+
+	for (uint i = 0; i < _jobs.size(); i++) {
+		if (_jobs[i].fileName == job.fileName)
+			return;
+	}
+
+	// Files left by interrupted renderings have no data chunk
+	Common::FSNode file = Common::FSNode(_path).getChild(job.fileName);
+	if (file.exists()) {
+		Common::SeekableReadStream *stream = file.createReadStream();
+		int dataSize = 0, rate;
+		byte flags;
+		const bool valid = stream && loadWAVFromStream(*stream, dataSize, rate, flags);
+		delete stream;
+		if (valid)
+			return;
+	}
+
+	job.data = (byte *)malloc(size);
+	memcpy(job.data, data, size);
+	job.size = size;
+	job.format = format;
+	job.track = track;
+	_jobs.push_back(job);
+
+	startRendering();
+}
+
+bool MidiPrerenderer::isRendering() {
+	Common::StackLock lock(_mutex);
+	return !_jobs.empty();
+}
+
+void MidiPrerenderer::releaseSynth() {
+	Common::StackLock lock(_mutex);
+	_synthReleased = true;
+	startRendering();
+}
+
+void MidiPrerenderer::acquireSynth() {
+	bool rendering;
+	{
+		Common::StackLock lock(_mutex);
+		_synthReleased = false;
+		rendering = _rendering;
+	}
+
+	// The render thread checks between two timer ticks of the track
+	if (rendering)
+		_synthReturned.wait();
+}
+
+void MidiPrerenderer::startRendering() {
+	// Called with the mutex locked
+	if (_running || !_synthReleased || _jobs.empty() || !_synth->isOpen())
+		return;
+
+	// The previous thread has nothing left to do but return
+	_thread.join();
+	_running = _thread.start(renderThreadProc, this);
+	if (!_running) {
+		warning("MidiPrerenderer: Threads are not supported, tracks can't be rendered");
+		for (uint i = 0; i < _jobs.size(); i++)
+			free(_jobs[i].data);
+		_jobs.clear();
+	}
+}
+
+void MidiPrerenderer::renderThreadProc(void *param) {
+	static_cast<MidiPrerenderer *>(param)->renderJobs();
+}
+
+void MidiPrerenderer::renderJobs() {
+	while (true) {
+		Job job;
+		{
+			Common::StackLock lock(_mutex);
+			if (_quit || !_synthReleased || _jobs.empty()) {
+				_running = false;
+				return;
+			}
+			job = _jobs[0];
+			_rendering = true;
+		}
+
+		// The job stays queued while it's rendered, so it isn't queued twice
+		const bool finished = renderJob(job);
+
+		bool interrupted;
+		{
+			Common::StackLock lock(_mutex);
+			_rendering = false;
+			interrupted = !_synthReleased;
+			if (finished) {
+				free(_jobs[0].data);
+				_jobs.remove_at(0);
+			}
+		}
+
+		if (interrupted)
+			_synthReturned.signal();
+	}
+}
+
+bool MidiPrerenderer::renderJob(const Job &job) {
+	MidiParser *parser = (job.format == kFormatXMIDI) ? MidiParser::createParser_XMIDI() : MidiParser::createParser_SMF();
+	Common::SeekableWriteStream *stream = nullptr;
+
+	if (parser->loadMusic(job.data, job.size) && parser->setTrack(job.track))
+		stream = Common::FSNode(_path).getChild(job.fileName).createWriteStream();
+
+	if (!stream) {
+		warning("MidiPrerenderer: Can't render %s", job.fileName.c_str());
+		delete parser;
+		return true;
+	}
+
+	const uint32 start = g_system->getMillis();
+
+	// The mixer plays silence while the track is rendered
+	_synth->setOffline(true);
+	if (_mt32)
+		_driver->sendMT32Reset();
+	else
+		_driver->sendGMReset();
+
+	TrackOutput output(_output, parser, job.format == kFormatXMIDI);
+	parser->setMidiDriver(&output);
+	parser->setTimerRate(_driver->getBaseTempo());
+	parser->property(MidiParser::mpCenterPitchWheelOnUnload, 1);
+	parser->property(MidiParser::mpSendSustainOffOnNotesOff, 1);
+	parser->property(MidiParser::mpStopAtInfiniteLoop, 1);
+
+	const int rate = _synth->getRate();
+	const int channels = _synth->isStereo() ? 2 : 1;
+	IMAWAVWriter writer(stream, rate, channels == 2);
+
+	// The parser is called as often as the driver calls its timer. The
+	// frames per call are in 16.16 fixed point.
+	const uint32 tickFrames = (uint32)(((uint64)rate << 16) * _driver->getBaseTempo() / 1000000);
+	const uint32 chunk = 1024;
+	int16 buffer[chunk * 2];
+	uint32 frames = 0, nextTick = 0;
+	bool finished = false, done = false;
+
+	while (true) {
+		{
+			Common::StackLock lock(_mutex);
+			if (_quit || !_synthReleased)
+				break;
+		}
+
+		nextTick += tickFrames;
+		const uint32 tickEnd = frames + (nextTick >> 16);
+		nextTick &= 0xFFFF;
+		while (frames < tickEnd) {
+			const uint32 count = MIN(tickEnd - frames, chunk);
+			_synth->renderOffline(buffer, count * channels);
+			writer.write(buffer, count * channels);
+			frames += count;
+		}
+		output.frames = frames;
+		parser->onTimer();
+
+		// Tracks looping forever have no release, the loop is played
+		// instead. The others are looped from their start when the
+		// engine asks for it, and the release is only played at the end.
+		bool complete = false;
+		if (output.infiniteLoop) {
+			writer.setLoop(output.loopStart, output.loopEnd, 0);
+			complete = true;
+		} else if (output.ended && frames >= output.loopEnd + rate * kReleaseLength) {
+			writer.setLoop(0, output.loopEnd, 1);
+			complete = true;
+		} else if (frames >= (uint32)rate * kMaxTrackLength) {
+			writer.setLoop(0, frames, 1);
+			complete = true;
+		}
+
+		if (complete) {
+			done = writer.finish();
+			if (!done)
+				warning("MidiPrerenderer: Failed to write %s", job.fileName.c_str());
+			finished = true;
+			break;
+		}
+	}
+
+	delete parser;
+	delete stream;
+
+	// Clear what the track left in the synth before handing it back
+	if (_mt32)
+		_driver->sendMT32Reset();
+	else
+		_driver->sendGMReset();
+	_synth->setOffline(false);
+
+	if (done)
+		debug(1, "MidiPrerenderer: Rendered %s in %d ms", job.fileName.c_str(), g_system->getMillis() - start);
+	return finished;
+}
+
+} // End of namespace Audio
@@ -0,0 +1,189 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef AUDIO_MIDIPRERENDER_H
+#define AUDIO_MIDIPRERENDER_H
+
+#include "common/array.h"
+#include "common/mutex.h"
+#include "common/str.h"
+#include "common/thread.h"
+#include "common/types.h"
+#include "audio/mididrv.h"
+
+class MidiDriver_Emulated;
+
+namespace Audio {
+
+/**
+ * @defgroup audio_midiprerender MIDI pre-rendering
+ * @ingroup audio
+ *
+ * @brief Offline rendering of MIDI tracks through a software synth.
+ * @{
+ */
+
+class AudioStream;
+
+/**
+ * Renders MIDI tracks offline into compressed WAV files, so that devices
+ * too slow to run a software synth in real time can play them as PCM.
+ *
+ * Pre-rendering is enabled by setting "midi_prerender_path" to a cache
+ * directory, and only applies to the software synths, e.g. the MT-32
+ * emulator and FluidSynth. Each track is rendered once, on a background
+ * thread if the backend supports threads. The file names depend on the
+ * MIDI data, the ROMs or SoundFont, the synth settings and the output
+ * rate.
+ *
+ * The tracks are rendered with the synth the game plays through, so it
+ * isn't loaded twice. The player lends it with releaseSynth() while it
+ * doesn't play through it, and takes it back with acquireSynth(), which
+ * interrupts the rendering. Tracks are rendered as they are played from
+ * their start, with the synth reset to General MIDI or MT-32 mode, and
+ * XMIDI tracks end where they would loop forever. Their events are sent
+ * through the player, which maps them to the driver like for the tracks
+ * it plays.
+ *
+ * The synth is reset again once it's handed back. Data the engine sends to
+ * its driver outside of the tracks, such as custom MT-32 timbres, is lost
+ * and not part of the rendered audio, so engines must only use this for
+ * tracks which don't depend on such data.
+ */
+class MidiPrerenderer {
+public:
+	enum Format {
+		kFormatSMF,
+		kFormatXMIDI
+	};
+
+	/**
+	 * @param driver  The driver the tracks are rendered with, created for
+	 *                the device. It must be open before the synth is
+	 *                released, and outlive the prerenderer.
+	 * @param device  The device of the driver.
+	 * @param mt32    Whether the synth is set to MT-32 mode instead of
+	 *                General MIDI.
+	 * @param output  The player the events of the tracks are sent to. It
+	 *                is called from the render thread while the synth is
+	 *                released, and must send the events to the driver.
+	 *                Meta events aren't passed on.
+	 */
+	MidiPrerenderer(MidiDriver *driver, MidiDriver::DeviceHandle device, bool mt32, MidiDriver_BASE *output);
+
+	/**
+	 * Stops the rendering, the track being rendered is dropped. The synth
+	 * is handed back.
+	 */
+	~MidiPrerenderer();
+
+	/**
+	 * Check whether pre-rendering is configured and the device is a
+	 * software synth.
+	 */
+	static bool isAvailable(MidiDriver::DeviceHandle device);
+
+	/**
+	 * Open a rendered track. Looping tracks are repeated from their start
+	 * until their end of track event, and XMIDI tracks with an infinite
+	 * loop always repeat that loop. The release of the last notes is only
+	 * played by the tracks which don't loop.
+	 *
+	 * @return  A stream playing the track, or 0 if it is not rendered yet.
+	 */
+	AudioStream *openTrack(const byte *data, uint32 size, Format format, bool loop, int track = 0);
+
+	/**
+	 * Queue a track for rendering, unless it is rendered or queued already.
+	 * The data is copied.
+	 */
+	void queueTrack(const byte *data, uint32 size, Format format, int track = 0);
+
+	/**
+	 * Check whether tracks are waiting to be rendered.
+	 */
+	bool isRendering();
+
+	/**
+	 * Let the queued tracks be rendered with the synth, until
+	 * acquireSynth() is called. Nothing else may be sent to the driver
+	 * meanwhile.
+	 */
+	void releaseSynth();
+
+	/**
+	 * Stop rendering with the synth and wait until it plays through the
+	 * mixer again. The track being rendered is rendered again from its
+	 * start the next time the synth is released.
+	 */
+	void acquireSynth();
+
+private:
+	struct Job {
+		byte *data;
+		uint32 size;
+		Format format;
+		int track;
+		Common::String fileName;
+	};
+
+	enum {
+		/** Longest track rendered, in seconds */
+		kMaxTrackLength = 30 * 60,
+		/** Time the last notes are given to end after the track, in seconds */
+		kReleaseLength = 2,
+		/** Changed when tracks are rendered differently, so they're rendered again */
+		kRenderVersion = 3
+	};
+
+	class TrackOutput;
+
+	Common::String getFileName(const byte *data, uint32 size, Format format, int track);
+	uint32 getSetupHash() const;
+	void startRendering();
+	bool renderJob(const Job &job);
+	void renderJobs();
+	static void renderThreadProc(void *param);
+
+	MidiDriver *const _driver;
+	MidiDriver_Emulated *const _synth;
+	MidiDriver_BASE *const _output;
+	const MidiDriver::DeviceHandle _device;
+	const bool _mt32;
+	Common::String _path;
+	uint32 _setupHash;
+
+	Common::Thread _thread;
+	Common::Mutex _mutex;
+	Common::Semaphore _synthReturned;
+	Common::Array<Job> _jobs;
+	bool _running;
+	bool _quit;
+	/** Whether the player lent the synth */
+	bool _synthReleased;
+	/** Whether the synth is rendering a track */
+	bool _rendering;
+};
+
+/** @} */
+} // End of namespace Audio
+
+#endif
@@ -5,6 +5,7 @@ MODULE_OBJS := \
 	adlib_ms.o \
 	audiostream.o \
 	fmopl.o \
+	imawavwriter.o \
 	mididrv.o \
 	mididrv_ms.o \
 	midiparser_qt.o \
@@ -12,6 +13,7 @@ MODULE_OBJS := \
 	midiparser_xmidi.o \
 	midiparser.o \
 	midiplayer.o \
+	midiprerender.o \
 	miles_adlib.o \
 	miles_midi.o \
 	mixer.o \
@@ -20,6 +22,7 @@ MODULE_OBJS := \
 	musicplugin.o \
 	null.o \
 	rate.o \
+	soundcache.o \
 	timestamp.o \
 	decoders/3do.o \
 	decoders/aac.o \
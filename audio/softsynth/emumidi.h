@@ -26,6 +26,8 @@
 #include "audio/mididrv.h"
 #include "audio/mixer.h"
 
+#include "common/mutex.h"
+
 class MidiDriver_Emulated : public Audio::AudioStream, public MidiDriver {
 protected:
 	bool _isOpen;
@@ -43,12 +45,21 @@ private:
 	int _nextTick;
 	int _samplesPerTick;
 
+	Common::Mutex _offlineMutex;
+	bool _offline;
+
 protected:
 	int _baseFreq;
 
 	virtual void generateSamples(int16 *buf, int len) = 0;
 	virtual void onTimer() {}
 
+	/**
+	 * Check whether the output is rendered with renderOffline(). Only valid
+	 * in generateSamples(), which is called with the state locked.
+	 */
+	bool isOffline() const { return _offline; }
+
 public:
 	MidiDriver_Emulated(Audio::Mixer *mixer) :
 		_mixer(mixer),
@@ -57,6 +68,7 @@ public:
 		_timerParam(0),
 		_nextTick(0),
 		_samplesPerTick(0),
+		_offline(false),
 		_baseFreq(250) {
 	}
 
@@ -86,6 +98,25 @@ public:
 		return 1000000 / _baseFreq;
 	}
 
+	/**
+	 * Take the output away from the mixer, so that it can be read with
+	 * renderOffline() instead, e.g. to render MIDI data to a file. The mixer
+	 * gets silence meanwhile, but still calls the timer callbacks.
+	 */
+	void setOffline(bool offline) {
+		Common::StackLock lock(_offlineMutex);
+		_offline = offline;
+	}
+
+	/**
+	 * Render the output while the driver is offline. The timer callbacks
+	 * are not called, the caller sends the MIDI data itself in between.
+	 */
+	void renderOffline(int16 *data, const int numSamples) {
+		Common::StackLock lock(_offlineMutex);
+		generateSamples(data, numSamples / (isStereo() ? 2 : 1));
+	}
+
 	// AudioStream API
 	virtual int readBuffer(int16 *data, const int numSamples) {
 		const int stereoFactor = isStereo() ? 2 : 1;
@@ -97,7 +128,13 @@ public:
 			if (step > (_nextTick >> FIXP_SHIFT))
 				step = (_nextTick >> FIXP_SHIFT);
 
-			generateSamples(data, step);
+			{
+				Common::StackLock lock(_offlineMutex);
+				if (_offline)
+					memset(data, 0, step * stereoFactor * sizeof(int16));
+				else
+					generateSamples(data, step);
+			}
 
 			_nextTick -= step << FIXP_SHIFT;
 			if (!(_nextTick >> FIXP_SHIFT)) {
@@ -41,6 +41,7 @@
 #include "common/system.h"
 #include "common/textconsole.h"
 #include "common/translation.h"
+#include "common/util.h"
 #include "audio/musicplugin.h"
 #include "audio/mpu401.h"
 #include "audio/softsynth/emumidi.h"
@@ -94,6 +95,23 @@ private:
 	int _outputRate;
 	Common::SeekableReadStream *_engineSoundFontData;
 
+	// Polyphony limited to keep the rendering time within a share of the
+	// played time, with the time spent over the last second. The polyphony
+	// set in the synth only goes down gradually towards the target.
+	enum {
+		kPolyphonyStep = 4
+	};
+
+	int _maxPolyphony;
+	int _targetPolyphony;
+	int _polyphony;
+	int _cpuBudget;
+	uint32 _renderTime;
+	uint32 _renderedSamples;
+
+	void adjustPolyphony();
+	void updatePolyphony();
+
 protected:
 	// Because GCC complains about casting from const to non-const...
 	void setInt(const char *name, int val);
@@ -129,7 +147,8 @@ public:
 // MidiDriver method implementations
 
 MidiDriver_FluidSynth::MidiDriver_FluidSynth(Audio::Mixer *mixer)
-	: MidiDriver_Emulated(mixer), _engineSoundFontData(nullptr) {
+	: MidiDriver_Emulated(mixer), _engineSoundFontData(nullptr), _maxPolyphony(0), _targetPolyphony(0), _polyphony(0),
+	  _cpuBudget(0), _renderTime(0), _renderedSamples(0) {
 
 	for (int i = 0; i < ARRAYSIZE(_midiChannels); i++) {
 		_midiChannels[i].init(this, i);
@@ -249,6 +268,26 @@ int MidiDriver_FluidSynth::open() {
 	setNum("synth.gain", gain);
 	setNum("synth.sample-rate", _outputRate);
 
+	_maxPolyphony = CLIP(ConfMan.getInt("fluidsynth_misc_polyphony"), 16, 1024);
+	_targetPolyphony = _polyphony = _maxPolyphony;
+	_cpuBudget = CLIP(ConfMan.getInt("fluidsynth_misc_cpu_budget"), 0, 100);
+	_renderTime = 0;
+	_renderedSamples = 0;
+	setInt("synth.polyphony", _maxPolyphony);
+
+	if (_cpuBudget > 0) {
+		// When the limit is reached, end the released notes first so
+		// that held notes are rarely cut
+		setNum("synth.overflow.released", -4000);
+	}
+
+#if FS_API_VERSION >= 0x0201
+	// Only load the samples of the presets selected by the game, instead
+	// of the whole SoundFont, which may not fit in memory
+	if (ConfMan.getBool("fluidsynth_misc_dynamic_loading"))
+		setInt("synth.dynamic-sample-loading", 1);
+#endif
+
 	_synth = new_fluid_synth(_settings);
 
 	if (ConfMan.getBool("fluidsynth_chorus_activate")) {
@@ -446,7 +485,63 @@ MidiChannel *MidiDriver_FluidSynth::getPercussionChannel() {
 }
 
 void MidiDriver_FluidSynth::generateSamples(int16 *data, int len) {
+	// Tracks rendered offline get the full polyphony, whatever the load.
+	// The budget takes over again once the mixer reads the output.
+	if (_cpuBudget > 0 && isOffline() && _polyphony != _maxPolyphony) {
+		fluid_synth_set_polyphony(_synth, _maxPolyphony);
+		_polyphony = _maxPolyphony;
+	}
+
+	if (_cpuBudget == 0 || isOffline()) {
+		fluid_synth_write_s16(_synth, len, data, 0, 2, data, 1, 2);
+		return;
+	}
+
+	const uint32 start = g_system->getMillis();
 	fluid_synth_write_s16(_synth, len, data, 0, 2, data, 1, 2);
+	_renderTime += g_system->getMillis() - start;
+	_renderedSamples += len;
+
+	if (_renderedSamples >= (uint32)_outputRate)
+		adjustPolyphony();
+	if (_polyphony != _targetPolyphony)
+		updatePolyphony();
+}
+
+void MidiDriver_FluidSynth::adjustPolyphony() {
+	// Percentage of the played time spent rendering it
+	const uint32 load = _renderTime * _outputRate / (_renderedSamples * 10);
+	_renderTime = 0;
+	_renderedSamples = 0;
+
+	int polyphony = _targetPolyphony;
+	if (load > (uint32)_cpuBudget)
+		polyphony = MAX(polyphony * 3 / 4, 16);
+	else if (load < (uint32)_cpuBudget / 2)
+		polyphony = MIN(polyphony + _maxPolyphony / 8, _maxPolyphony);
+
+	if (polyphony != _targetPolyphony) {
+		debug(2, "FluidSynth: Rendering at %u%% of the CPU, polyphony target set to %d", load, polyphony);
+		_targetPolyphony = polyphony;
+	}
+}
+
+void MidiDriver_FluidSynth::updatePolyphony() {
+	int polyphony = _targetPolyphony;
+
+	// FluidSynth turns off the voices above a lowered polyphony at once,
+	// which clicks. Only the voices that aren't playing are dropped instead,
+	// a few at a time, and the voice stealing takes care of the rest as
+	// new notes start, ending the released notes first.
+	if (polyphony < _polyphony) {
+		const int playing = fluid_synth_get_active_voice_count(_synth);
+		polyphony = MAX(MAX(polyphony, _polyphony - kPolyphonyStep), playing);
+		if (polyphony >= _polyphony)
+			return;
+	}
+
+	fluid_synth_set_polyphony(_synth, polyphony);
+	_polyphony = polyphony;
 }
 
 void MidiDriver_FluidSynth::setEngineSoundFont(Common::SeekableReadStream *soundFontData) {
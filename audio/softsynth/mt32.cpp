@@ -34,6 +34,7 @@
 #include "common/events.h"
 #include "common/file.h"
 #include "common/system.h"
+#include "common/thread.h"
 #include "common/util.h"
 #include "common/archive.h"
 #include "common/textconsole.h"
@@ -119,6 +120,26 @@ private:
 
 	int _outputRate;
 
+	// Rendering ahead on a separate thread, see startRenderThread()
+	enum {
+		kRenderChunk = 256
+	};
+
+	bool _renderAhead;
+	Common::Thread _renderThread;
+	Common::Mutex _bufferMutex;
+	Common::Semaphore _bufferConsumed;
+	int16 *_buffer;
+	uint _bufferSize, _bufferRead, _bufferWrite, _bufferFilled;
+	bool _quitRenderThread;
+
+	bool startRenderThread(int latency);
+	void stopRenderThread();
+	static void renderThreadProc(void *param);
+	void renderAhead();
+
+	void writeSysex(byte channel, const byte *data, uint16 length);
+
 protected:
 	void generateSamples(int16 *buf, int len) override;
 
@@ -137,6 +158,7 @@ public:
 	MidiChannel *getPercussionChannel() override;
 
 	// AudioStream API
+	int readBuffer(int16 *data, const int numSamples) override;
 	bool isStereo() const override { return true; }
 	int getRate() const override { return _outputRate; }
 };
@@ -156,6 +178,10 @@ MidiDriver_MT32::MidiDriver_MT32(Audio::Mixer *mixer) : MidiDriver_Emulated(mixe
 	_outputRate = 0;
 	_controlData = nullptr;
 	_pcmData = nullptr;
+	_renderAhead = false;
+	_buffer = nullptr;
+	_bufferSize = _bufferRead = _bufferWrite = _bufferFilled = 0;
+	_quitRenderThread = false;
 }
 
 MidiDriver_MT32::~MidiDriver_MT32() {
@@ -195,6 +221,12 @@ int MidiDriver_MT32::open() {
 
 	pcmFile.close();
 
+	// Replaying the starts of the notes saves a lot of time on slow devices, at the cost of
+	// slight differences with the emulation. The cache is a local patch of the bundled Munt.
+	const int partialCacheSize = ConfMan.getInt("mt32_partial_cache");
+	if (partialCacheSize > 0)
+		_service.setPartialCacheSize(partialCacheSize * 1024);
+
 	if (_service.openSynth() != MT32EMU_RC_OK)
 		return MERR_DEVICE_NOT_AVAILABLE;
 
@@ -215,6 +247,10 @@ int MidiDriver_MT32::open() {
 
 	MidiDriver_Emulated::open();
 
+	const int latency = ConfMan.getInt("mt32_render_ahead");
+	if (latency > 0 && !startRenderThread(latency))
+		warning("MT32emu: Threads are not supported, rendering in the mixer instead");
+
 	_mixer->playStream(Audio::Mixer::kPlainSoundType, &_mixerSoundHandle, this, -1, Audio::Mixer::kMaxChannelVolume, 0, DisposeAfterUse::NO, true);
 
 	return 0;
@@ -234,8 +270,7 @@ void MidiDriver_MT32::setPitchBendRange(byte channel, uint range) {
 		warning("setPitchBendRange() called with range > 24: %d", range);
 	}
 	byte benderRangeSysex[4] = { 0, 0, 4, (uint8)range };
-	Common::StackLock lock(_mutex);
-	_service.writeSysex(channel, benderRangeSysex, 4);
+	writeSysex(channel, benderRangeSysex, 4);
 }
 
 void MidiDriver_MT32::sysEx(const byte *msg, uint16 length) {
@@ -250,8 +285,7 @@ void MidiDriver_MT32::sysEx(const byte *msg, uint16 length) {
 		};
 
 		if (msg[3] == SYSEX_CMD_DT1 || msg[3] == SYSEX_CMD_DAT) {
-			Common::StackLock lock(_mutex);
-			_service.writeSysex(msg[1], msg + 4, length - 5);
+			writeSysex(msg[1], msg + 4, length - 5);
 		} else {
 			warning("Unused sysEx command %d", msg[3]);
 		}
@@ -263,10 +297,12 @@ void MidiDriver_MT32::close() {
 		return;
 	_isOpen = false;
 
-	// Detach the player callback handler
-	setTimerCallback(nullptr, nullptr);
 	// Detach the mixer callback handler
 	_mixer->stopHandle(_mixerSoundHandle);
+	// The render thread calls the player callback as well
+	stopRenderThread();
+	// Detach the player callback handler
+	setTimerCallback(nullptr, nullptr);
 
 	Common::StackLock lock(_mutex);
 	_service.closeSynth();
@@ -277,11 +313,160 @@ void MidiDriver_MT32::close() {
 	_pcmData = nullptr;
 }
 
+void MidiDriver_MT32::writeSysex(byte channel, const byte *data, uint16 length) {
+	if (!_renderAhead) {
+		Common::StackLock lock(_mutex);
+		_service.writeSysex(channel, data, length);
+		return;
+	}
+
+	// Writing directly to the synth is not safe while it renders on
+	// another thread, so the data goes through the MIDI queue as a DT1
+	// message instead, with the checksum the synth expects. Device IDs
+	// above 0x10 are ignored there, and all address the whole device here.
+	byte *msg = new byte[length + 7];
+	byte checksum = 0;
+
+	msg[0] = 0xF0;
+	msg[1] = 0x41;
+	msg[2] = MIN<byte>(channel, 0x10);
+	msg[3] = 0x16;
+	msg[4] = 0x12;
+	for (uint16 i = 0; i < length; ++i) {
+		msg[5 + i] = data[i];
+		checksum += data[i];
+	}
+	msg[length + 5] = (128 - (checksum & 0x7F)) & 0x7F;
+	msg[length + 6] = 0xF7;
+
+	{
+		Common::StackLock lock(_mutex);
+		_service.playSysex(msg, length + 7);
+	}
+	delete[] msg;
+}
+
 void MidiDriver_MT32::generateSamples(int16 *data, int len) {
+	// Munt's MIDI queue needs no locking against the rendering thread,
+	// the mutex only serialises the threads sending MIDI data
+	if (_renderAhead) {
+		_service.renderBit16s(data, len);
+		return;
+	}
+
 	Common::StackLock lock(_mutex);
 	_service.renderBit16s(data, len);
 }
 
+int MidiDriver_MT32::readBuffer(int16 *data, const int numSamples) {
+	if (!_renderAhead)
+		return MidiDriver_Emulated::readBuffer(data, numSamples);
+
+	uint read, filled;
+	{
+		Common::StackLock lock(_bufferMutex);
+		read = _bufferRead;
+		filled = _bufferFilled;
+	}
+
+	// The render thread only writes to the part of the buffer that is not
+	// filled, so the copy needs no lock
+	const uint frames = MIN<uint>(numSamples / 2, filled);
+	const uint first = MIN<uint>(frames, _bufferSize - read);
+	memcpy(data, _buffer + read * 2, first * 4);
+	memcpy(data + first * 2, _buffer, (frames - first) * 4);
+
+	{
+		Common::StackLock lock(_bufferMutex);
+		_bufferRead = (read + frames) % _bufferSize;
+		_bufferFilled -= frames;
+	}
+	_bufferConsumed.signal();
+
+	if (frames < (uint)numSamples / 2) {
+		debug(5, "MT32emu: Render thread underrun by %d samples", numSamples / 2 - frames);
+		memset(data + frames * 2, 0, (numSamples - frames * 2) * sizeof(int16));
+	}
+
+	return numSamples;
+}
+
+/**
+ * Render ahead of the mixer on a separate thread, keeping up to the given
+ * number of milliseconds in a ring buffer.
+ *
+ * The timer callbacks set by the engine (usually its music player or MIDI
+ * parser) are driven by the rendering, so they are called from the render
+ * thread, up to that latency ahead of the audio being heard. They must lock
+ * whatever they share with the engine thread, and anything they report back
+ * (a track ending, a music cue reached) happens that much early. MIDI data
+ * sent from other threads is heard that much later.
+ */
+bool MidiDriver_MT32::startRenderThread(int latency) {
+	const uint chunks = MAX<uint>((_outputRate * latency / 1000 + kRenderChunk - 1) / kRenderChunk, 2);
+
+	// The buffer is a whole number of chunks, so they never wrap around
+	_bufferSize = chunks * kRenderChunk;
+	_buffer = new int16[_bufferSize * 2];
+	_bufferRead = _bufferWrite = _bufferFilled = 0;
+	_quitRenderThread = false;
+
+	_renderAhead = true;
+	if (!_renderThread.start(renderThreadProc, this)) {
+		_renderAhead = false;
+		delete[] _buffer;
+		_buffer = nullptr;
+		return false;
+	}
+
+	debug(1, "MT32emu: Rendering %d ms ahead on a separate thread", _bufferSize * 1000 / _outputRate);
+	return true;
+}
+
+void MidiDriver_MT32::stopRenderThread() {
+	if (!_renderAhead)
+		return;
+
+	{
+		Common::StackLock lock(_bufferMutex);
+		_quitRenderThread = true;
+	}
+	_bufferConsumed.signal();
+	_renderThread.join();
+	_renderAhead = false;
+
+	delete[] _buffer;
+	_buffer = nullptr;
+}
+
+void MidiDriver_MT32::renderThreadProc(void *param) {
+	static_cast<MidiDriver_MT32 *>(param)->renderAhead();
+}
+
+void MidiDriver_MT32::renderAhead() {
+	while (true) {
+		bool full;
+		{
+			Common::StackLock lock(_bufferMutex);
+			if (_quitRenderThread)
+				return;
+			full = _bufferFilled + kRenderChunk > _bufferSize;
+		}
+
+		// Sleep until the mixer has read from the buffer
+		if (full) {
+			_bufferConsumed.wait();
+			continue;
+		}
+
+		MidiDriver_Emulated::readBuffer(_buffer + _bufferWrite * 2, kRenderChunk * 2);
+		_bufferWrite = (_bufferWrite + kRenderChunk) % _bufferSize;
+
+		Common::StackLock lock(_bufferMutex);
+		_bufferFilled += kRenderChunk;
+	}
+}
+
 uint32 MidiDriver_MT32::property(int prop, uint32 param) {
 	switch (prop) {
 	case PROP_CHANNEL_MASK:
@@ -72,9 +72,14 @@ Partial::Partial(Synth *useSynth, int usePartialIndex) :
 	default:
 		la32Pair = nullptr;
 	}
+	// ScummVM local patch: partial cache
+	cacheState = CACHE_OFF;
+	cacheEntry = nullptr;
+	cachePosition = 0;
 }
 
 Partial::~Partial() {
+	releaseCacheEntry();
 	delete la32Pair;
 	delete tva;
 	delete tvp;
@@ -122,8 +127,11 @@ void Partial::deactivate() {
 	synth->printPartialUsage(sampleNum);
 #endif
 	if (isRingModulatingSlave()) {
+		// The master may be playing from the cache, with its wave generators behind
+		pair->leaveCache();
 		pair->la32Pair->deactivate(LA32PartialPair::SLAVE);
 	} else {
+		releaseCacheEntry();
 		la32Pair->deactivate(LA32PartialPair::MASTER);
 		if (hasRingModulatingSlave()) {
 			pair->deactivate();
@@ -232,6 +240,13 @@ void Partial::startPartial(const Part *part, Poly *usePoly, const PatchCache *us
 	if (!hasRingModulatingSlave()) {
 		la32Pair->deactivate(LA32PartialPair::SLAVE);
 	}
+
+	// ScummVM local patch: the cache is looked up with the first sample, once the slave of the pair is started as well
+	releaseCacheEntry();
+	if (synth->partialCache != nullptr && !isRingModulatingSlave()) {
+		cacheState = CACHE_LOOKUP;
+		cachePosition = 0;
+	}
 }
 
 Bit32u Partial::getAmpValue() {
@@ -333,8 +348,10 @@ bool Partial::generateNextSample(LA32PairImpl *la32PairImpl) {
 }
 
 void Partial::produceAndMixSample(IntSample *&leftBuf, IntSample *&rightBuf, LA32IntPartialPair *la32IntPair) {
-	IntSampleEx sample = la32IntPair->nextOutSample();
+	mixSample(leftBuf, rightBuf, la32IntPair->nextOutSample());
+}
 
+void Partial::mixSample(IntSample *&leftBuf, IntSample *&rightBuf, IntSampleEx sample) {
 	// FIXME: LA32 may produce distorted sound in case if the absolute value of maximal amplitude of the input exceeds 8191
 	// when the panning value is non-zero. Most probably the distortion occurs in the same way it does with ring modulation,
 	// and it seems to be caused by limited precision of the common multiplication circuit.
@@ -369,11 +386,178 @@ bool Partial::doProduceOutput(Sample *leftBuf, Sample *rightBuf, Bit32u length,
 	return true;
 }
 
+// ScummVM local patch: the partial cache, up to produceOutput()
+
+// The slave inputs are only given with ring modulation
+static void generateFromInputs(LA32IntPartialPair *la32IntPair, const PartialCacheInputs &master, const PartialCacheInputs *slave) {
+	la32IntPair->generateNextSample(LA32PartialPair::MASTER, master.amp, master.pitch, master.cutoff);
+	if (slave != nullptr) {
+		la32IntPair->generateNextSample(LA32PartialPair::SLAVE, slave->amp, slave->pitch, slave->cutoff);
+	}
+}
+
+// Like generateNextSample(), but while the partial is played from the cache the inputs of
+// the wave generators are only compared to the recorded ones.
+bool Partial::generateNextCachedSample(LA32IntPartialPair *la32IntPair) {
+	if (!tva->isPlaying() || !la32IntPair->isActive(LA32PartialPair::MASTER)) {
+		// Notes shorter than the cached length are kept whole
+		if (cacheState == CACHE_RECORDING) {
+			finishCacheRecording();
+		}
+		deactivate();
+		return false;
+	}
+
+	const bool ringModulated = hasRingModulatingSlave();
+	PartialCacheInputs master, slave;
+	master.amp = getAmpValue();
+	master.pitch = tvp->nextPitch();
+	master.cutoff = getCutoffValue();
+	if (ringModulated) {
+		slave.amp = pair->getAmpValue();
+		slave.pitch = pair->tvp->nextPitch();
+		slave.cutoff = pair->getCutoffValue();
+	} else {
+		slave.amp = 0;
+		slave.pitch = 0;
+		slave.cutoff = 0;
+	}
+
+	if (cacheState == CACHE_LOOKUP) {
+		PartialCacheKey key;
+		makeCacheKey(key, master, slave);
+		cacheEntry = synth->partialCache->acquire(key);
+		if (cacheEntry != nullptr) {
+			cacheState = CACHE_PLAYING;
+		} else {
+			cacheEntry = synth->partialCache->startRecording(key, ringModulated);
+			cacheState = cacheEntry != nullptr ? CACHE_RECORDING : CACHE_OFF;
+		}
+	}
+
+	if (cacheState == CACHE_PLAYING && cacheEntry->matches(cachePosition, master, slave)) {
+		if (++cachePosition == cacheEntry->length) {
+			*la32IntPair = cacheEntry->end;
+			releaseCacheEntry();
+		}
+	} else {
+		if (cacheState == CACHE_PLAYING) {
+			leaveCache();
+		} else if (cacheState == CACHE_RECORDING) {
+			synth->partialCache->recordInputs(cacheEntry, *la32IntPair, master, slave);
+		}
+		generateFromInputs(la32IntPair, master, ringModulated ? &slave : nullptr);
+	}
+
+	if (ringModulated) {
+		if (!pair->tva->isPlaying() || !la32IntPair->isActive(LA32PartialPair::SLAVE)) {
+			pair->deactivate();
+			if (mixType == 2) {
+				deactivate();
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+bool Partial::produceCachedOutput(IntSample *leftBuf, IntSample *rightBuf, Bit32u length) {
+	if (!canProduceOutput()) return false;
+	alreadyOutputed = true;
+
+	LA32IntPartialPair *la32IntPair = static_cast<LA32IntPartialPair *>(la32Pair);
+	for (sampleNum = 0; sampleNum < length; sampleNum++) {
+		if (cacheState == CACHE_OFF) {
+			if (!generateNextSample(la32IntPair)) break;
+			produceAndMixSample(leftBuf, rightBuf, la32IntPair);
+			continue;
+		}
+
+		if (!generateNextCachedSample(la32IntPair)) break;
+		if (cacheState == CACHE_PLAYING) {
+			mixSample(leftBuf, rightBuf, cacheEntry->samples[cachePosition - 1]);
+			continue;
+		}
+		Bit16s sample = la32IntPair->nextOutSample();
+		if (cacheState == CACHE_RECORDING && synth->partialCache->recordSample(cacheEntry, sample)) {
+			finishCacheRecording();
+		}
+		mixSample(leftBuf, rightBuf, sample);
+	}
+	sampleNum = 0;
+	return true;
+}
+
+void Partial::describeWave(Bit32u *params) const {
+	if (isPCM()) {
+		params[0] = 0x80000000 | pcmWave->addr;
+		params[1] = pcmWave->len;
+		params[2] = pcmWave->loop;
+	} else {
+		params[0] = patchCache->waveform & 1;
+		params[1] = pulseWidthVal;
+		params[2] = patchCache->srcPartial.tvf.resonance + 1;
+	}
+}
+
+// The key covers what la32Pair was initialised with in startPartial()
+void Partial::makeCacheKey(PartialCacheKey &key, const PartialCacheInputs &master, const PartialCacheInputs &slave) const {
+	const bool ringModulated = hasRingModulatingSlave();
+	key.params[0] = (ringModulated ? 1 : 0) | (mixType == 1 ? 2 : 0);
+	describeWave(&key.params[1]);
+	if (ringModulated) {
+		pair->describeWave(&key.params[4]);
+	} else {
+		key.params[4] = key.params[5] = key.params[6] = 0;
+	}
+	key.params[7] = master.amp;
+	key.params[8] = master.cutoff;
+	key.params[9] = master.pitch;
+	key.params[10] = slave.amp;
+	key.params[11] = slave.cutoff;
+	key.params[12] = slave.pitch;
+}
+
+void Partial::finishCacheRecording() {
+	synth->partialCache->finishRecording(cacheEntry, *static_cast<LA32IntPartialPair *>(la32Pair));
+	cacheEntry = nullptr;
+	cacheState = CACHE_OFF;
+}
+
+void Partial::releaseCacheEntry() {
+	if (cacheState == CACHE_PLAYING) {
+		synth->partialCache->release(cacheEntry);
+	} else if (cacheState == CACHE_RECORDING) {
+		synth->partialCache->abandonRecording(cacheEntry);
+	}
+	cacheEntry = nullptr;
+	cacheState = CACHE_OFF;
+}
+
+// Brings the wave generators to the state they had after the samples played from the cache,
+// replaying the recorded inputs since the last snapshot
+void Partial::leaveCache() {
+	if (cacheState == CACHE_PLAYING) {
+		LA32IntPartialPair *la32IntPair = static_cast<LA32IntPartialPair *>(la32Pair);
+		const PartialCache::Entry *entry = cacheEntry;
+		const Bit32u blockStart = cachePosition & ~PartialCache::BLOCK_MASK;
+		*la32IntPair = entry->snapshots[blockStart / PartialCache::BLOCK_LENGTH];
+		for (Bit32u position = blockStart; position < cachePosition; position++) {
+			generateFromInputs(la32IntPair, entry->masterInputs[position], entry->ringModulated ? &entry->slaveInputs[position] : nullptr);
+		}
+	}
+	releaseCacheEntry();
+}
+
 bool Partial::produceOutput(IntSample *leftBuf, IntSample *rightBuf, Bit32u length) {
 	if (floatMode) {
 		synth->printDebug("Partial: Invalid call to produceOutput()! Renderer = %d\n", synth->getSelectedRendererType());
 		return false;
 	}
+	// ScummVM local patch: partial cache
+	if (cacheState != CACHE_OFF) {
+		return produceCachedOutput(leftBuf, rightBuf, length);
+	}
 	return doProduceOutput(leftBuf, rightBuf, length, static_cast<LA32IntPartialPair *>(la32Pair));
 }
 
@@ -25,6 +25,7 @@
 #include "LA32Ramp.h"
 #include "LA32WaveGenerator.h"
 #include "LA32FloatWaveGenerator.h"
+#include "PartialCache.h"
 
 namespace MT32Emu {
 
@@ -80,6 +81,17 @@ private:
 	const PatchCache *patchCache;
 	PatchCache cachebackup;
 
+	// ScummVM local patch: only used with the integer renderer when the partial cache is enabled
+	enum CacheState {
+		CACHE_OFF,
+		CACHE_LOOKUP,
+		CACHE_PLAYING,
+		CACHE_RECORDING
+	} cacheState;
+	PartialCache::Entry *cacheEntry;
+	// Number of samples played from cacheEntry
+	Bit32u cachePosition;
+
 	Bit32u getAmpValue();
 	Bit32u getCutoffValue();
 
@@ -90,6 +102,16 @@ private:
 	bool generateNextSample(LA32PairImpl *la32PairImpl);
 	void produceAndMixSample(IntSample *&leftBuf, IntSample *&rightBuf, LA32IntPartialPair *la32IntPair);
 	void produceAndMixSample(FloatSample *&leftBuf, FloatSample *&rightBuf, LA32FloatPartialPair *la32FloatPair);
+	void mixSample(IntSample *&leftBuf, IntSample *&rightBuf, IntSampleEx sample);
+
+	// ScummVM local patch: partial cache
+	bool produceCachedOutput(IntSample *leftBuf, IntSample *rightBuf, Bit32u length);
+	bool generateNextCachedSample(LA32IntPartialPair *la32IntPair);
+	void describeWave(Bit32u *params) const;
+	void makeCacheKey(PartialCacheKey &key, const PartialCacheInputs &master, const PartialCacheInputs &slave) const;
+	void finishCacheRecording();
+	void releaseCacheEntry();
+	void leaveCache();
 
 public:
 	bool alreadyOutputed;
@@ -0,0 +1,209 @@
+/* Copyright (C) 2003, 2004, 2005, 2006, 2008, 2009 Dean Beeler, Jerome Fisher
+ * Copyright (C) 2011-2021 Dean Beeler, Jerome Fisher, Sergey V. Mikayev
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// ScummVM local patch, see PartialCache.h
+
+#include <cstddef>
+#include <cstring>
+
+#include "internals.h"
+
+#include "PartialCache.h"
+
+namespace MT32Emu {
+
+// How far the inputs of a replayed sample may be from the recorded ones. The amp and the cutoff
+// are added to the logarithmic samples after a shift by 10, the pitch has 4096 steps per octave.
+// So these are about 0.1 dB and 2 cents.
+static const Bit32u AMP_TOLERANCE = 1 << 16;
+static const Bit32u CUTOFF_TOLERANCE = 1 << 16;
+static const Bit32u PITCH_TOLERANCE = 8;
+
+static inline Bit32u distance(Bit32u a, Bit32u b) {
+	return a > b ? a - b : b - a;
+}
+
+bool PartialCacheInputs::isCloseTo(const PartialCacheInputs &other) const {
+	return distance(amp, other.amp) <= AMP_TOLERANCE && distance(cutoff, other.cutoff) <= CUTOFF_TOLERANCE && distance(pitch, other.pitch) <= PITCH_TOLERANCE;
+}
+
+Bit32u PartialCacheKey::hash() const {
+	// FNV-1a
+	Bit32u result = 2166136261u;
+	for (unsigned int i = 0; i < PARAM_COUNT; i++) {
+		result = (result ^ params[i]) * 16777619u;
+	}
+	return result ^ (result >> 16);
+}
+
+bool PartialCacheKey::operator==(const PartialCacheKey &other) const {
+	return memcmp(params, other.params, sizeof(params)) == 0;
+}
+
+template <class T>
+static T *shrinkArray(T *array, Bit32u length) {
+	T *result = new T[length];
+	for (Bit32u i = 0; i < length; i++) {
+		result[i] = array[i];
+	}
+	delete[] array;
+	return result;
+}
+
+PartialCache::PartialCache(Bit32u memorySize) :
+	maxMemorySize(memorySize), usedMemorySize(0), useCounter(0) {
+	memset(buckets, 0, sizeof(buckets));
+}
+
+PartialCache::~PartialCache() {
+	for (Bit32u i = 0; i < BUCKET_COUNT; i++) {
+		while (buckets[i] != nullptr) {
+			Entry *entry = buckets[i];
+			buckets[i] = entry->next;
+			deleteEntry(entry);
+		}
+	}
+}
+
+Bit32u PartialCache::getEntryMemorySize(Bit32u length, bool ringModulated) {
+	Bit32u blockCount = (length + BLOCK_MASK) / BLOCK_LENGTH;
+	Bit32u sampleSize = (ringModulated ? 2 : 1) * sizeof(PartialCacheInputs) + sizeof(Bit16s);
+	return Bit32u(sizeof(Entry) + length * sampleSize + blockCount * sizeof(LA32IntPartialPair));
+}
+
+void PartialCache::deleteEntry(Entry *entry) {
+	delete[] entry->masterInputs;
+	delete[] entry->slaveInputs;
+	delete[] entry->samples;
+	delete[] entry->snapshots;
+	delete entry;
+}
+
+PartialCache::Entry *PartialCache::acquire(const PartialCacheKey &key) {
+	for (Entry *entry = buckets[key.hash() % BUCKET_COUNT]; entry != nullptr; entry = entry->next) {
+		if (entry->key == key) {
+			entry->useCount++;
+			entry->lastUse = ++useCounter;
+			return entry;
+		}
+	}
+	return nullptr;
+}
+
+void PartialCache::release(Entry *entry) {
+	entry->useCount--;
+}
+
+bool PartialCache::evictLeastRecentlyUsed() {
+	Entry **victim = nullptr;
+	for (Bit32u i = 0; i < BUCKET_COUNT; i++) {
+		for (Entry **entry = &buckets[i]; *entry != nullptr; entry = &(*entry)->next) {
+			if ((*entry)->useCount == 0 && (victim == nullptr || Bit32s((*entry)->lastUse - (*victim)->lastUse) < 0)) {
+				victim = entry;
+			}
+		}
+	}
+	if (victim == nullptr) {
+		return false;
+	}
+	Entry *entry = *victim;
+	*victim = entry->next;
+	usedMemorySize -= entry->memorySize;
+	deleteEntry(entry);
+	return true;
+}
+
+PartialCache::Entry *PartialCache::startRecording(const PartialCacheKey &key, bool ringModulated) {
+	Bit32u memorySize = getEntryMemorySize(MAX_ENTRY_LENGTH, ringModulated);
+	while (usedMemorySize + memorySize > maxMemorySize) {
+		if (!evictLeastRecentlyUsed()) {
+			return nullptr;
+		}
+	}
+	usedMemorySize += memorySize;
+
+	Entry *entry = new Entry;
+	entry->key = key;
+	entry->ringModulated = ringModulated;
+	entry->length = 0;
+	entry->masterInputs = new PartialCacheInputs[MAX_ENTRY_LENGTH];
+	entry->slaveInputs = ringModulated ? new PartialCacheInputs[MAX_ENTRY_LENGTH] : nullptr;
+	entry->samples = new Bit16s[MAX_ENTRY_LENGTH];
+	entry->snapshots = new LA32IntPartialPair[(MAX_ENTRY_LENGTH + BLOCK_MASK) / BLOCK_LENGTH];
+	entry->memorySize = memorySize;
+	entry->useCount = 0;
+	entry->lastUse = 0;
+	entry->next = nullptr;
+	return entry;
+}
+
+void PartialCache::recordInputs(Entry *entry, const LA32IntPartialPair &la32Pair, const PartialCacheInputs &master, const PartialCacheInputs &slave) {
+	if ((entry->length & BLOCK_MASK) == 0) {
+		entry->snapshots[entry->length / BLOCK_LENGTH] = la32Pair;
+	}
+	entry->masterInputs[entry->length] = master;
+	if (entry->ringModulated) {
+		entry->slaveInputs[entry->length] = slave;
+	}
+}
+
+bool PartialCache::recordSample(Entry *entry, Bit16s sample) {
+	entry->samples[entry->length++] = sample;
+	return entry->length == MAX_ENTRY_LENGTH;
+}
+
+void PartialCache::finishRecording(Entry *entry, const LA32IntPartialPair &la32Pair) {
+	// The same partial may have been recorded at the same time by another pair
+	Entry **bucket = &buckets[entry->key.hash() % BUCKET_COUNT];
+	for (Entry *other = *bucket; other != nullptr; other = other->next) {
+		if (other->key == entry->key) {
+			abandonRecording(entry);
+			return;
+		}
+	}
+	if (entry->length == 0) {
+		abandonRecording(entry);
+		return;
+	}
+
+	entry->end = la32Pair;
+
+	// Give the memory reserved for the rest of the quarter of a second back
+	if (entry->length < MAX_ENTRY_LENGTH) {
+		entry->masterInputs = shrinkArray(entry->masterInputs, entry->length);
+		if (entry->ringModulated) {
+			entry->slaveInputs = shrinkArray(entry->slaveInputs, entry->length);
+		}
+		entry->samples = shrinkArray(entry->samples, entry->length);
+		entry->snapshots = shrinkArray(entry->snapshots, (entry->length + BLOCK_MASK) / BLOCK_LENGTH);
+
+		Bit32u memorySize = getEntryMemorySize(entry->length, entry->ringModulated);
+		usedMemorySize -= entry->memorySize - memorySize;
+		entry->memorySize = memorySize;
+	}
+
+	entry->lastUse = ++useCounter;
+	entry->next = *bucket;
+	*bucket = entry;
+}
+
+void PartialCache::abandonRecording(Entry *entry) {
+	usedMemorySize -= entry->memorySize;
+	deleteEntry(entry);
+}
+
+} // namespace MT32Emu
@@ -0,0 +1,132 @@
+/* Copyright (C) 2003, 2004, 2005, 2006, 2008, 2009 Dean Beeler, Jerome Fisher
+ * Copyright (C) 2011-2021 Dean Beeler, Jerome Fisher, Sergey V. Mikayev
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MT32EMU_PARTIAL_CACHE_H
+#define MT32EMU_PARTIAL_CACHE_H
+
+// ScummVM local patch, not part of upstream Munt. Enabled with the mt32_partial_cache setting.
+// The replayed partials aren't bit-exact: their inputs are only compared to the recorded ones
+// within about 0.1 dB and 2 cents. When updating Munt, this file and the code marked as part
+// of the same patch in Partial, Synth and the C interface must be carried over.
+
+#include "globals.h"
+#include "internals.h"
+#include "Types.h"
+#include "LA32WaveGenerator.h"
+
+namespace MT32Emu {
+
+// Values the TVA, TVP and TVF of a partial feed to its wave generator for one sample.
+struct PartialCacheInputs {
+	Bit32u amp;
+	Bit32u cutoff;
+	Bit16u pitch;
+
+	// Returns whether the other inputs make a negligible difference to the output of the wave generator.
+	bool isCloseTo(const PartialCacheInputs &other) const;
+};
+
+// Identifies the start of a partial pair: what its wave generators were initialised with,
+// and the inputs of the first sample, which depend on the key and the velocity.
+struct PartialCacheKey {
+	static const unsigned int PARAM_COUNT = 13;
+
+	// Ring modulation and mixing flags, three values describing the wave of each generator,
+	// then the first inputs of each generator
+	Bit32u params[PARAM_COUNT];
+
+	Bit32u hash() const;
+	bool operator==(const PartialCacheKey &other) const;
+};
+
+// Keeps the output of LA32 partial pairs at the start of the notes, to replay it
+// the next time the same partial is started instead of synthesising it again.
+//
+// The TVA, TVP and TVF still run while a partial is replayed, and each sample
+// is only taken from the cache as long as their output stays close to what it
+// was when the entry was recorded. The TVP is updated with a random jitter, so
+// the output rarely matches exactly, and the replayed partials differ slightly
+// from the emulation. When the inputs diverge, e.g. because the note is released,
+// the wave generators are brought to the state they would have after the samples
+// replayed so far, from the closest snapshot, and the partial continues being
+// synthesised.
+class PartialCache {
+public:
+	// The state of the wave generators is saved at the start of every block
+	static const Bit32u BLOCK_LENGTH = 256;
+	static const Bit32u BLOCK_MASK = BLOCK_LENGTH - 1;
+	// Only the first quarter of a second of a partial is cached
+	static const Bit32u MAX_ENTRY_LENGTH = SAMPLE_RATE / 4;
+
+	struct Entry {
+		PartialCacheKey key;
+		bool ringModulated;
+
+		// Number of samples
+		Bit32u length;
+		// Inputs of the wave generators for each sample, the slave ones only with ring modulation
+		PartialCacheInputs *masterInputs;
+		PartialCacheInputs *slaveInputs;
+		// Output of the pair for each sample
+		Bit16s *samples;
+		// State of the pair at the start of each block, and after the last sample
+		LA32IntPartialPair *snapshots;
+		LA32IntPartialPair end;
+
+		Bit32u memorySize;
+		Bit32u useCount;
+		Bit32u lastUse;
+		Entry *next;
+
+		bool matches(Bit32u position, const PartialCacheInputs &master, const PartialCacheInputs &slave) const {
+			return masterInputs[position].isCloseTo(master) && (!ringModulated || slaveInputs[position].isCloseTo(slave));
+		}
+	};
+
+	PartialCache(Bit32u memorySize);
+	~PartialCache();
+
+	// Returns the complete entry for the key, which stays valid until release() is called.
+	Entry *acquire(const PartialCacheKey &key);
+	void release(Entry *entry);
+
+	// Returns a new entry to record a partial pair into, or nullptr if there's no memory left.
+	Entry *startRecording(const PartialCacheKey &key, bool ringModulated);
+	// Records the inputs of the next sample, with the state of the pair before these are applied.
+	void recordInputs(Entry *entry, const LA32IntPartialPair &la32Pair, const PartialCacheInputs &master, const PartialCacheInputs &slave);
+	// Records the output for the last inputs. Returns true when the entry is full.
+	bool recordSample(Entry *entry, Bit16s sample);
+	// Makes the entry available to acquire(), the pair is in its state after the last sample.
+	void finishRecording(Entry *entry, const LA32IntPartialPair &la32Pair);
+	void abandonRecording(Entry *entry);
+
+private:
+	static const Bit32u BUCKET_COUNT = 256;
+
+	const Bit32u maxMemorySize;
+	Bit32u usedMemorySize;
+	Bit32u useCounter;
+	Entry *buckets[BUCKET_COUNT];
+
+	static Bit32u getEntryMemorySize(Bit32u length, bool ringModulated);
+	static void deleteEntry(Entry *entry);
+	bool evictLeastRecentlyUsed();
+}; // class PartialCache
+
+} // namespace MT32Emu
+
+#endif // #ifndef MT32EMU_PARTIAL_CACHE_H
@@ -27,6 +27,7 @@
 #include "MidiEventQueue.h"
 #include "Part.h"
 #include "Partial.h"
+#include "PartialCache.h"
 #include "PartialManager.h"
 #include "Poly.h"
 #include "ROMInfo.h"
@@ -209,6 +210,8 @@ public:
 
 	Bit32u midiEventQueueSize;
 	Bit32u midiEventQueueSysexStorageBufferSize;
+
+	Bit32u partialCacheSize; // ScummVM local patch
 };
 
 Bit32u Synth::getLibraryVersionInt() {
@@ -280,12 +283,14 @@ Synth::Synth(ReportHandler *useReportHandler) :
 	paddedTimbreMaxTable = nullptr;
 
 	partialManager = nullptr;
+	partialCache = nullptr;
 	pcmWaves = nullptr;
 	pcmROMData = nullptr;
 	soundGroupNames = nullptr;
 	midiQueue = nullptr;
 	extensions.midiEventQueueSize = DEFAULT_MIDI_EVENT_QUEUE_SIZE;
 	extensions.midiEventQueueSysexStorageBufferSize = 0;
+	extensions.partialCacheSize = 0;
 	lastReceivedMIDIEventTimestamp = 0;
 	memset(parts, 0, sizeof(parts));
 	renderedSampleCount = 0;
@@ -723,6 +728,11 @@ bool Synth::open(const ROMImage &controlROMImage, const ROMImage &pcmROMImage, B
 	// CM-64 seems to initialise all bytes in this bank to 0.
 	memset(&mt32ram.timbres[128], 0, sizeof(mt32ram.timbres[128]) * 64);
 
+	// ScummVM local patch: created before the partials, which check whether the cache is enabled
+	if (extensions.partialCacheSize > 0 && extensions.selectedRendererType == RendererType_BIT16S) {
+		partialCache = new PartialCache(extensions.partialCacheSize);
+	}
+
 	partialManager = new PartialManager(this, parts);
 
 	pcmWaves = new PCMWaveEntry[controlROMMap->pcmCount];
@@ -862,6 +872,9 @@ void Synth::dispose() {
 	delete partialManager;
 	partialManager = nullptr;
 
+	delete partialCache;
+	partialCache = nullptr;
+
 	for (int i = 0; i < 9; i++) {
 		delete parts[i];
 		parts[i] = nullptr;
@@ -1992,6 +2005,15 @@ RendererType Synth::getSelectedRendererType() const {
 	return extensions.selectedRendererType;
 }
 
+// ScummVM local patch
+void Synth::setPartialCacheSize(Bit32u memorySize) {
+	extensions.partialCacheSize = memorySize;
+}
+
+Bit32u Synth::getPartialCacheSize() const {
+	return extensions.partialCacheSize;
+}
+
 Bit32u Synth::getStereoOutputSampleRate() const {
 	return (analog == nullptr) ? SAMPLE_RATE : analog->getOutputSampleRate();
 }
@@ -48,6 +48,7 @@ class TimbresMemoryRegion;
 class SystemMemoryRegion;
 class DisplayMemoryRegion;
 class ResetMemoryRegion;
+class PartialCache;
 
 struct ControlROMFeatureSet;
 struct ControlROMMap;
@@ -181,6 +182,7 @@ private:
 	ReportHandler *reportHandler;
 
 	PartialManager *partialManager;
+	PartialCache *partialCache; // ScummVM local patch
 	Part *parts[9];
 
 	// When a partial needs to be aborted to free it up for use by a new Poly,
@@ -469,6 +471,20 @@ public:
 	// See RendererType for details.
 	MT32EMU_EXPORT RendererType getSelectedRendererType() const;
 
+	// ScummVM local patch, not part of upstream Munt.
+	// Sets the amount of memory in bytes used to keep the output of the wave generators at the start
+	// of the partials, which is replayed when the same partials are played again. While a partial is
+	// replayed, its TVA, TVP and TVF keep running and it's synthesised again as soon as their output
+	// is noticeably different from the recorded one. Since the TVP has a small random jitter, the replayed
+	// partials aren't bit-exact, though the differences are well below what can be heard.
+	// Each partial being recorded reserves room for a quarter of a second, so sizes below several MB
+	// leave little room for the partials to be kept.
+	// The cache is only used with RendererType_BIT16S, and takes effect during subsequent calls to open().
+	// By default, the size is 0 and the cache is disabled.
+	MT32EMU_EXPORT void setPartialCacheSize(Bit32u memorySize);
+	// Returns the size of the partial cache in bytes set with setPartialCacheSize().
+	MT32EMU_EXPORT Bit32u getPartialCacheSize() const;
+
 	// Returns actual sample rate used in emulation of stereo analog circuitry of hardware units.
 	// See comment for render() below.
 	MT32EMU_EXPORT Bit32u getStereoOutputSampleRate() const;
@@ -790,6 +790,15 @@ void mt32emu_preallocate_reverb_memory(mt32emu_const_context context, const mt32
 	return context->synth->preallocateReverbMemory(enabled != MT32EMU_BOOL_FALSE);
 }
 
+// ScummVM local patch: the partial cache isn't part of upstream Munt, nor of its service interface.
+void mt32emu_set_partial_cache_size(mt32emu_context context, const mt32emu_bit32u memory_size) {
+	context->synth->setPartialCacheSize(memory_size);
+}
+
+mt32emu_bit32u mt32emu_get_partial_cache_size(mt32emu_const_context context) {
+	return context->synth->getPartialCacheSize();
+}
+
 void mt32emu_set_dac_input_mode(mt32emu_const_context context, const mt32emu_dac_input_mode mode) {
 	context->synth->setDACInputMode(static_cast<DACInputMode>(mode));
 }
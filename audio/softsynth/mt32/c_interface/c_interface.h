@@ -424,6 +424,17 @@ MT32EMU_EXPORT mt32emu_boolean mt32emu_is_default_reverb_mt32_compatible(mt32emu
  */
 MT32EMU_EXPORT void mt32emu_preallocate_reverb_memory(mt32emu_const_context context, const mt32emu_boolean enabled);
 
+/**
+ * ScummVM local patch, not available in upstream Munt nor through mt32emu_service_i.
+ * Sets the amount of memory in bytes used to keep the output of the wave generators at the start of the partials,
+ * which is replayed when the same partials are played again. The replayed partials aren't bit-exact.
+ * The cache is only used with the integer renderer, and takes effect during subsequent calls to mt32emu_open_synth().
+ * By default, the size is 0 and the cache is disabled.
+ */
+MT32EMU_EXPORT void mt32emu_set_partial_cache_size(mt32emu_context context, const mt32emu_bit32u memory_size);
+/** Returns the size of the partial cache in bytes set with mt32emu_set_partial_cache_size(). */
+MT32EMU_EXPORT mt32emu_bit32u mt32emu_get_partial_cache_size(mt32emu_const_context context);
+
 /** Sets new DAC input mode. See mt32emu_dac_input_mode for details. */
 MT32EMU_EXPORT void mt32emu_set_dac_input_mode(mt32emu_const_context context, const mt32emu_dac_input_mode mode);
 /** Returns current DAC input mode. See mt32emu_dac_input_mode for details. */
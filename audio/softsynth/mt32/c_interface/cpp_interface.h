@@ -262,6 +262,11 @@ public:
 	bool isMT32ReverbCompatibilityMode() { return mt32emu_is_mt32_reverb_compatibility_mode(c) != MT32EMU_BOOL_FALSE; }
 	bool isDefaultReverbMT32Compatible() { return mt32emu_is_default_reverb_mt32_compatible(c) != MT32EMU_BOOL_FALSE; }
 	void preallocateReverbMemory(const bool enabled) { mt32emu_preallocate_reverb_memory(c, enabled ? MT32EMU_BOOL_TRUE : MT32EMU_BOOL_FALSE); }
+#if MT32EMU_API_TYPE != 2
+	// ScummVM local patch, only available when linked statically with the bundled library.
+	void setPartialCacheSize(const Bit32u memory_size) { mt32emu_set_partial_cache_size(c, memory_size); }
+	Bit32u getPartialCacheSize() { return mt32emu_get_partial_cache_size(c); }
+#endif
 
 	void setDACInputMode(const DACInputMode mode) { mt32emu_set_dac_input_mode(c, static_cast<mt32emu_dac_input_mode>(mode)); }
 	DACInputMode getDACInputMode() { return static_cast<DACInputMode>(mt32emu_get_dac_input_mode(c)); }
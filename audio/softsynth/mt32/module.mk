@@ -11,6 +11,7 @@ MODULE_OBJS := \
 	MidiStreamParser.o \
 	Part.o \
 	Partial.o \
+	PartialCache.o \
 	PartialManager.o \
 	Poly.o \
 	ROMInfo.o \
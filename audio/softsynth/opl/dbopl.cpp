@@ -429,16 +429,21 @@ Bits Operator::TemplateVolume(  ) {
 	return vol;
 }
 
-static const VolumeHandler VolumeHandlerTable[5] = {
-	&Operator::TemplateVolume< Operator::OFF >,
-	&Operator::TemplateVolume< Operator::RELEASE >,
-	&Operator::TemplateVolume< Operator::SUSTAIN >,
-	&Operator::TemplateVolume< Operator::DECAY >,
-	&Operator::TemplateVolume< Operator::ATTACK >
-};
-
+//Dispatch on the state here rather than through a member function pointer,
+//so the compiler can inline the envelope of every operator in the sample loops
 INLINE Bitu Operator::ForwardVolume() {
-	return currentLevel + (this->*volHandler)();
+	switch ( state ) {
+	case OFF:
+		return currentLevel + TemplateVolume< OFF >();
+	case RELEASE:
+		return currentLevel + TemplateVolume< RELEASE >();
+	case SUSTAIN:
+		return currentLevel + TemplateVolume< SUSTAIN >();
+	case DECAY:
+		return currentLevel + TemplateVolume< DECAY >();
+	default:
+		return currentLevel + TemplateVolume< ATTACK >();
+	}
 }
 
 
@@ -521,7 +526,6 @@ void Operator::WriteE0( const Chip* chip, Bit8u val ) {
 
 INLINE void Operator::SetState( Bit8u s ) {
 	state = s;
-	volHandler = VolumeHandlerTable[ s ];
 }
 
 INLINE bool Operator::Silent() const {
@@ -1040,7 +1044,8 @@ Chip::Chip() {
 INLINE Bit32u Chip::ForwardNoise() {
 	noiseCounter += noiseAdd;
 	Bitu count = noiseCounter >> LFO_SH;
-	noiseCounter &= WAVE_MASK;
+	//Only keep the fraction, the noise is clocked once per chip sample
+	noiseCounter &= ( 1 << LFO_SH ) - 1;
 	for ( ; count > 0; --count ) {
 		//Noise calculation from mame
 		noiseValue ^= ( 0x800302 ) & ( 0 - (noiseValue & 1 ) );
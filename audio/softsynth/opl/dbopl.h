@@ -66,7 +66,6 @@ struct Channel;
 typedef Bits ( DB_FASTCALL *WaveHandler) ( Bitu i, Bitu volume );
 #endif
 
-typedef Bits ( DBOPL::Operator::*VolumeHandler) ( );
 typedef Channel* ( DBOPL::Channel::*SynthHandler) ( Chip* chip, Bit32u samples, Bit32s* output );
 
 //Different synth modes that can generate blocks of data
@@ -109,8 +108,6 @@ public:
 		ATTACK
 	} State;
 
-	VolumeHandler volHandler;
-
 #if (DBOPL_WAVE == WAVE_HANDLER)
 	WaveHandler waveHandler;	//Routine that generate a wave
 #else
@@ -39,9 +39,37 @@
 #include <math.h>
 #include <string.h>
 
+// The chip output is clipped to 16 bits eight samples at a time with SSE2
+// or NEON
+#include "common/simd.h"
+
 namespace OPL {
 namespace DOSBox {
 
+/**
+ * Convert the sum of the channels to 16 bit samples. With all eighteen
+ * channels playing loudly, the sum exceeds the 16 bit range, so it is
+ * clipped rather than left to wrap around.
+ */
+static void clipSamples(const int32 *src, int16 *dst, uint count) {
+	uint i = 0;
+#if defined(USE_SSE2)
+	for (; i + 8 <= count; i += 8) {
+		const __m128i lo = _mm_loadu_si128((const __m128i *)(src + i));
+		const __m128i hi = _mm_loadu_si128((const __m128i *)(src + i + 4));
+		_mm_storeu_si128((__m128i *)(dst + i), _mm_packs_epi32(lo, hi));
+	}
+#elif defined(USE_NEON)
+	for (; i + 8 <= count; i += 8) {
+		const int16x4_t lo = vqmovn_s32(vld1q_s32(src + i));
+		const int16x4_t hi = vqmovn_s32(vld1q_s32(src + i + 4));
+		vst1q_s16(dst + i, vcombine_s16(lo, hi));
+	}
+#endif
+	for (; i < count; ++i)
+		dst[i] = CLIP<int32>(src[i], -32768, 32767);
+}
+
 Timer::Timer() {
 	masked = false;
 	overflow = false;
@@ -334,9 +362,7 @@ void OPL::generateSamples(int16 *buffer, int length) {
 			const uint readSamples = MIN<uint>(length, bufferLength);
 
 			_emulator->GenerateBlock3(readSamples, tempBuffer);
-
-			for (uint i = 0; i < (readSamples << 1); ++i)
-				buffer[i] = tempBuffer[i];
+			clipSamples(tempBuffer, buffer, readSamples << 1);
 
 			buffer += (readSamples << 1);
 			length -= readSamples;
@@ -346,9 +372,7 @@ void OPL::generateSamples(int16 *buffer, int length) {
 			const uint readSamples = MIN<uint>(length, bufferLength << 1);
 
 			_emulator->GenerateBlock2(readSamples, tempBuffer);
-
-			for (uint i = 0; i < readSamples; ++i)
-				buffer[i] = tempBuffer[i];
+			clipSamples(tempBuffer, buffer, readSamples);
 
 			buffer += readSamples;
 			length -= readSamples;
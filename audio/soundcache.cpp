@@ -0,0 +1,235 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "audio/soundcache.h"
+#include "audio/audiostream.h"
+
+#include "common/debug.h"
+#include "common/mutex.h"
+
+namespace Audio {
+
+/**
+ * The decoded samples of a sound, shared by the cache and the streams
+ * playing it. The mixer deletes streams from its own thread, so the
+ * reference count is guarded by a mutex.
+ */
+class CachedSound {
+public:
+	CachedSound(int16 *samples, uint32 count, int rate, bool stereo)
+		: _samples(samples), _count(count), _rate(rate), _stereo(stereo), _refCount(1) {}
+
+	void incRef() {
+		Common::StackLock lock(_mutex);
+		_refCount++;
+	}
+
+	void decRef() {
+		bool last;
+
+		{
+			Common::StackLock lock(_mutex);
+			last = --_refCount == 0;
+		}
+
+		if (last)
+			delete this;
+	}
+
+	const int16 *getSamples() const { return _samples; }
+	uint32 getCount() const { return _count; }
+	int getRate() const { return _rate; }
+	bool isStereo() const { return _stereo; }
+	uint32 getSize() const { return _count * sizeof(int16); }
+
+private:
+	~CachedSound() {
+		free(_samples);
+	}
+
+	int16 *_samples;
+	const uint32 _count;
+	const int _rate;
+	const bool _stereo;
+
+	Common::Mutex _mutex;
+	uint _refCount;
+};
+
+/**
+ * A stream playing from the samples of a cached sound.
+ */
+class CachedSoundStream : public SeekableAudioStream {
+public:
+	CachedSoundStream(CachedSound *sound) : _sound(sound), _pos(0) {
+		_sound->incRef();
+	}
+
+	~CachedSoundStream() {
+		_sound->decRef();
+	}
+
+	int readBuffer(int16 *buffer, const int numSamples) override {
+		const uint32 count = MIN<uint32>(numSamples, _sound->getCount() - _pos);
+		memcpy(buffer, _sound->getSamples() + _pos, count * sizeof(int16));
+		_pos += count;
+		return count;
+	}
+
+	bool isStereo() const override { return _sound->isStereo(); }
+	int getRate() const override { return _sound->getRate(); }
+	bool endOfData() const override { return _pos >= _sound->getCount(); }
+
+	bool seek(const Timestamp &where) override {
+		const uint32 channels = isStereo() ? 2 : 1;
+		const uint32 frame = where.convertToFramerate(getRate()).totalNumberOfFrames();
+
+		if (frame * channels > _sound->getCount())
+			return false;
+
+		_pos = frame * channels;
+		return true;
+	}
+
+	Timestamp getLength() const override {
+		return Timestamp(0, _sound->getCount() / (isStereo() ? 2 : 1), getRate());
+	}
+
+private:
+	CachedSound *_sound;
+	uint32 _pos;
+};
+
+SoundCache::SoundCache(uint32 maxBytes) : _maxBytes(maxBytes), _usedBytes(0), _useCounter(0) {
+}
+
+SoundCache::~SoundCache() {
+	clear();
+}
+
+SeekableAudioStream *SoundCache::makeStream(const Common::String &id) {
+	EntryMap::iterator it = _entries.find(id);
+	if (it == _entries.end())
+		return 0;
+
+	it->_value.lastUse = ++_useCounter;
+	return new CachedSoundStream(it->_value.sound);
+}
+
+SeekableAudioStream *SoundCache::cacheStream(const Common::String &id, SeekableAudioStream *stream) {
+	if (!stream)
+		return 0;
+
+	const uint32 channels = stream->isStereo() ? 2 : 1;
+	const uint64 frames = stream->getLength().convertToFramerate(stream->getRate()).totalNumberOfFrames();
+	const uint64 size = frames * channels * sizeof(int16);
+
+	if (!frames || size > _maxBytes) {
+		debug(5, "SoundCache: Not caching '%s' of %u frames", id.c_str(), (uint)frames);
+		stream->rewind();
+		return stream;
+	}
+
+	// The length may be estimated, so keep reading until the end
+	uint32 capacity = frames * channels;
+	uint32 count = 0;
+	int16 *samples = (int16 *)malloc(capacity * sizeof(int16));
+
+	stream->rewind();
+	while (samples && !stream->endOfData()) {
+		if (count == capacity) {
+			capacity *= 2;
+			int16 *grown = (int16 *)realloc(samples, capacity * sizeof(int16));
+			if (!grown) {
+				free(samples);
+				samples = 0;
+				break;
+			}
+
+			samples = grown;
+		}
+
+		const int read = stream->readBuffer(samples + count, capacity - count);
+		if (read <= 0)
+			break;
+
+		count += read;
+	}
+
+	if (!samples || count * sizeof(int16) > _maxBytes) {
+		free(samples);
+		stream->rewind();
+		return stream;
+	}
+
+	CachedSound *sound = new CachedSound(samples, count, stream->getRate(), stream->isStereo());
+	delete stream;
+
+	remove(id);
+	evict(sound->getSize());
+
+	Entry entry;
+	entry.sound = sound;
+	entry.lastUse = ++_useCounter;
+	_entries[id] = entry;
+	_usedBytes += sound->getSize();
+
+	return new CachedSoundStream(sound);
+}
+
+bool SoundCache::contains(const Common::String &id) const {
+	return _entries.contains(id);
+}
+
+void SoundCache::remove(const Common::String &id) {
+	EntryMap::iterator it = _entries.find(id);
+	if (it == _entries.end())
+		return;
+
+	_usedBytes -= it->_value.sound->getSize();
+	it->_value.sound->decRef();
+	_entries.erase(it);
+}
+
+void SoundCache::clear() {
+	for (EntryMap::iterator it = _entries.begin(); it != _entries.end(); ++it)
+		it->_value.sound->decRef();
+
+	_entries.clear();
+	_usedBytes = 0;
+}
+
+void SoundCache::evict(uint32 bytes) {
+	// The cache holds few sounds, so a linear search is cheap enough
+	while (!_entries.empty() && _usedBytes + bytes > _maxBytes) {
+		EntryMap::iterator oldest = _entries.begin();
+
+		for (EntryMap::iterator it = _entries.begin(); it != _entries.end(); ++it)
+			if (it->_value.lastUse < oldest->_value.lastUse)
+				oldest = it;
+
+		const Common::String id = oldest->_key;
+		debug(5, "SoundCache: Evicting '%s'", id.c_str());
+		remove(id);
+	}
+}
+
+} // End of namespace Audio
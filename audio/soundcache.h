@@ -0,0 +1,130 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef AUDIO_SOUNDCACHE_H
+#define AUDIO_SOUNDCACHE_H
+
+#include "common/hashmap.h"
+#include "common/hash-str.h"
+#include "common/str.h"
+#include "common/types.h"
+
+namespace Audio {
+
+/**
+ * @defgroup audio_soundcache Sound cache
+ * @ingroup audio
+ *
+ * @brief Cache of decoded sounds, for short sounds which are played often.
+ * @{
+ */
+
+class SeekableAudioStream;
+class CachedSound;
+
+/**
+ * A size-bounded cache of fully decoded sounds.
+ *
+ * Engines play short sound effects like footsteps or clicks over and
+ * over, opening, parsing and decoding the same resource every time.
+ * This cache keeps the decoded samples of such sounds, keyed by an id
+ * chosen by the caller, and hands out streams which play from the shared
+ * samples.
+ *
+ * The streams stay valid when their sound is evicted from the cache or
+ * the cache is destroyed, so they can be handed to the mixer like any
+ * other stream. The cache itself must only be used from one thread.
+ */
+class SoundCache {
+public:
+	/**
+	 * Create a cache.
+	 *
+	 * @param maxBytes  Memory budget for the decoded samples.
+	 */
+	SoundCache(uint32 maxBytes);
+	~SoundCache();
+
+	/**
+	 * Create a stream playing a cached sound.
+	 *
+	 * @param id  The id the sound was cached under.
+	 *
+	 * @return  A new stream, or 0 if the sound is not cached.
+	 */
+	SeekableAudioStream *makeStream(const Common::String &id);
+
+	/**
+	 * Decode a sound, cache it, and create a stream playing it.
+	 *
+	 * The sound is decoded from its start to its end. Sounds of unknown
+	 * length, and sounds larger than the budget, are not cached. In that
+	 * case the given stream is rewound and returned instead.
+	 *
+	 * Less recently used sounds are evicted to make room for the new one.
+	 *
+	 * @param id      The id to cache the sound under.
+	 * @param stream  The sound to decode. The cache takes ownership.
+	 *
+	 * @return  A stream playing the sound, or 0 if the stream was 0.
+	 */
+	SeekableAudioStream *cacheStream(const Common::String &id, SeekableAudioStream *stream);
+
+	/**
+	 * Check whether a sound is cached.
+	 */
+	bool contains(const Common::String &id) const;
+
+	/**
+	 * Remove a sound from the cache. Its streams keep playing.
+	 */
+	void remove(const Common::String &id);
+
+	/**
+	 * Remove all sounds from the cache. Their streams keep playing.
+	 */
+	void clear();
+
+	/**
+	 * Return the memory used by the cached samples, in bytes.
+	 */
+	uint32 getUsedBytes() const { return _usedBytes; }
+
+private:
+	struct Entry {
+		CachedSound *sound;
+		uint32 lastUse;
+	};
+
+	typedef Common::HashMap<Common::String, Entry> EntryMap;
+
+	void evict(uint32 bytes);
+
+	EntryMap _entries;
+	uint32 _maxBytes;
+	uint32 _usedBytes;
+	uint32 _useCounter;
+};
+
+/** @} */
+} // End of namespace Audio
+
+#endif
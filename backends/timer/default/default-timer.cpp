@@ -21,6 +21,7 @@
 
 #include "common/scummsys.h"
 #include "backends/timer/default/default-timer.h"
+#include "common/debug.h"
 #include "common/util.h"
 #include "common/system.h"
 
@@ -30,87 +31,159 @@ struct TimerSlot {
 	Common::String id;
 	uint32 interval;	// in microseconds
 
-	uint32 nextFireTime;	// in milliseconds
-	uint32 nextFireTimeMicro;	// microseconds part of nextFire
+	uint64 nextFireTime;	// in microseconds
+	uint32 order;	// breaks ties between timers due at the same time
 
-	TimerSlot *next;
-
-	TimerSlot() : callback(nullptr), refCon(nullptr), interval(0), nextFireTime(0), nextFireTimeMicro(0), next(nullptr) {}
+	TimerSlot() : callback(nullptr), refCon(nullptr), interval(0), nextFireTime(0), order(0) {}
 };
 
-void insertPrioQueue(TimerSlot *head, TimerSlot *newSlot) {
-	// The head points to a fake anchor TimerSlot; this common
-	// trick allows us to get rid of many special cases.
 
-	const uint32 nextFireTime = newSlot->nextFireTime;
-	TimerSlot *slot = head;
-	newSlot->next = nullptr;
+DefaultTimerManager::DefaultTimerManager() :
+	_nextOrder(0),
+	_time(0),
+	_lastMillis(0),
+	_latenessReportTime(0),
+	_totalLateness(0),
+	_maxLateness(0),
+	_lateCount(0),
+	_timerCallbackNext(0) {
+}
 
-	// Insert the new slot into the sorted list of already scheduled
-	// timers in such a way that the list stays sorted...
-	while (true) {
-		assert(slot);
-		if (slot->next == nullptr || nextFireTime < slot->next->nextFireTime) {
-			newSlot->next = slot->next;
-			slot->next = newSlot;
-			return;
-		}
-		slot = slot->next;
-	}
+DefaultTimerManager::~DefaultTimerManager() {
+	Common::StackLock lock(_mutex);
+
+	for (uint i = 0; i < _queue.size(); i++)
+		delete _queue[i];
+	_queue.clear();
 }
 
+uint64 DefaultTimerManager::updateTime() {
+	// The difference is right even when the milliseconds wrap around
+	const uint32 millis = g_system->getMillis(true);
+	_time += (uint64)(millis - _lastMillis) * 1000;
+	_lastMillis = millis;
+	return _time;
+}
 
-DefaultTimerManager::DefaultTimerManager() :
-	_timerCallbackNext(0),
-	_head(nullptr) {
+bool DefaultTimerManager::isEarlier(const TimerSlot *a, const TimerSlot *b) const {
+	if (a->nextFireTime != b->nextFireTime)
+		return a->nextFireTime < b->nextFireTime;
+	return (int32)(a->order - b->order) < 0;
+}
 
-	_head = new TimerSlot();
+void DefaultTimerManager::pushSlot(TimerSlot *slot) {
+	// Timers due at the same time fire in the order they were scheduled
+	slot->order = _nextOrder++;
+
+	uint index = _queue.size();
+	_queue.push_back(slot);
+
+	while (index > 0) {
+		const uint parent = (index - 1) / 2;
+		if (!isEarlier(slot, _queue[parent]))
+			break;
+		_queue[index] = _queue[parent];
+		index = parent;
+	}
+	_queue[index] = slot;
 }
 
-DefaultTimerManager::~DefaultTimerManager() {
-	Common::StackLock lock(_mutex);
+void DefaultTimerManager::removeSlot(uint index) {
+	TimerSlot *last = _queue.back();
+	_queue.pop_back();
+	if (index == _queue.size())
+		return;
+
+	// Move the last slot into the hole, either up or down
+	while (index > 0) {
+		const uint parent = (index - 1) / 2;
+		if (!isEarlier(last, _queue[parent]))
+			break;
+		_queue[index] = _queue[parent];
+		index = parent;
+	}
 
-	TimerSlot *slot = _head;
-	while (slot) {
-		TimerSlot *next = slot->next;
-		delete slot;
-		slot = next;
+	while (true) {
+		uint child = index * 2 + 1;
+		if (child >= _queue.size())
+			break;
+		if (child + 1 < _queue.size() && isEarlier(_queue[child + 1], _queue[child]))
+			child++;
+		if (!isEarlier(_queue[child], last))
+			break;
+		_queue[index] = _queue[child];
+		index = child;
 	}
-	_head = nullptr;
+	_queue[index] = last;
 }
 
-void DefaultTimerManager::handler() {
-	Common::StackLock lock(_mutex);
+void DefaultTimerManager::recordLateness(uint32 lateness) {
+	_totalLateness += lateness;
+	_maxLateness = MAX(_maxLateness, lateness);
+	_lateCount++;
 
-	uint32 curTime = g_system->getMillis(true);
+	if (_time - _latenessReportTime >= kLatenessReportInterval) {
+		debug(5, "DefaultTimerManager: %u timer calls, %u us late on average, %u us at most",
+			_lateCount, (uint32)(_totalLateness / _lateCount), _maxLateness);
 
-	// On slow systems this could still be run after destructor
-	if (!_head)
-		return;
+		_latenessReportTime = _time;
+		_totalLateness = 0;
+		_maxLateness = 0;
+		_lateCount = 0;
+	}
+}
+
+uint32 DefaultTimerManager::handler() {
+	// Timers can't be removed while their callback runs
+	Common::StackLock callbackLock(_callbackMutex);
+
+	// Only the timers due by now are fired, so that slow callbacks can't keep
+	// the handler from returning
+	uint64 startTime;
+	{
+		Common::StackLock lock(_mutex);
+		startTime = updateTime();
+	}
 
-	// Repeat as long as there is a TimerSlot that is scheduled to fire.
-	TimerSlot *slot = _head->next;
-	while (slot && slot->nextFireTime < curTime) {
-		// Remove the slot from the priority queue
-		_head->next = slot->next;
-
-		// Update the fire time and reinsert the TimerSlot into the priority
-		// queue.
-		assert(slot->interval > 0);
-		slot->nextFireTime += (slot->interval / 1000);
-		slot->nextFireTimeMicro += (slot->interval % 1000);
-		if (slot->nextFireTimeMicro > 1000) {
-			slot->nextFireTime += slot->nextFireTimeMicro / 1000;
-			slot->nextFireTimeMicro %= 1000;
+	// Fire the timers which are due one at a time, so that the callbacks can
+	// install and remove timers
+	while (true) {
+		TimerProc callback;
+		void *refCon;
+
+		{
+			Common::StackLock lock(_mutex);
+
+			if (_queue.empty())
+				return 0xFFFFFFFF;
+
+			const uint64 curTime = updateTime();
+			TimerSlot *slot = _queue[0];
+			if (slot->nextFireTime > startTime) {
+				// The timers which became due meanwhile wait for the next call
+				if (slot->nextFireTime <= curTime)
+					return 1;
+				return MAX<uint32>((slot->nextFireTime - curTime + 999) / 1000, 1);
+			}
+
+			recordLateness((uint32)MIN<uint64>(curTime - slot->nextFireTime, 0xFFFFFFFF));
+
+			// Schedule the next call from the time this one was due, unless
+			// the timer is so late that the missed calls would come in a burst
+			assert(slot->interval > 0);
+			removeSlot(0);
+			slot->nextFireTime += slot->interval;
+			if (slot->nextFireTime + kMaxLateness < curTime)
+				slot->nextFireTime = curTime + slot->interval;
+			pushSlot(slot);
+
+			callback = slot->callback;
+			refCon = slot->refCon;
 		}
-		insertPrioQueue(_head, slot);
 
 		// Invoke the timer callback
-		assert(slot->callback);
-		slot->callback(slot->refCon);
-
-		// Look at the next scheduled timer
-		slot = _head->next;
+		assert(callback);
+		callback(refCon);
 	}
 }
 
@@ -147,27 +220,26 @@ bool DefaultTimerManager::installTimerProc(TimerProc callback, int32 interval, v
 	slot->refCon = refCon;
 	slot->id = id;
 	slot->interval = interval;
-	slot->nextFireTime = g_system->getMillis() + interval / 1000;
-	slot->nextFireTimeMicro = interval % 1000;
-	slot->next = nullptr;
+	slot->nextFireTime = updateTime() + interval;
 
-	insertPrioQueue(_head, slot);
+	pushSlot(slot);
 
 	return true;
 }
 
 void DefaultTimerManager::removeTimerProc(TimerProc callback) {
+	// Wait for the callback to return if it's running on another thread
+	Common::StackLock callbackLock(_callbackMutex);
 	Common::StackLock lock(_mutex);
 
-	TimerSlot *slot = _head;
-
-	while (slot->next) {
-		if (slot->next->callback == callback) {
-			TimerSlot *next = slot->next->next;
-			delete slot->next;
-			slot->next = next;
+	for (uint i = 0; i < _queue.size();) {
+		if (_queue[i]->callback == callback) {
+			delete _queue[i];
+			removeSlot(i);
+			// The slots may have moved around
+			i = 0;
 		} else {
-			slot = slot->next;
+			i++;
 		}
 	}
 
@@ -22,6 +22,7 @@
 #ifndef BACKENDS_TIMER_DEFAULT_H
 #define BACKENDS_TIMER_DEFAULT_H
 
+#include "common/array.h"
 #include "common/str.h"
 #include "common/hash-str.h"
 #include "common/timer.h"
@@ -29,16 +30,54 @@
 
 struct TimerSlot;
 
+/**
+ * Timer manager keeping the timers in a priority queue sorted by the time
+ * they are due next. Each timer is rescheduled from the time it was due
+ * rather than from the time it fired, so it doesn't drift.
+ *
+ * The callbacks run without the lock of the queue, so installing a timer
+ * doesn't wait for them. Removing a timer waits for the callback running,
+ * so the callback never runs after removeTimerProc() returns.
+ */
 class DefaultTimerManager : public Common::TimerManager {
 private:
 	typedef Common::HashMap<Common::String, TimerProc, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> TimerSlotMap;
 
+	enum {
+		/** Timers later than this, in microseconds, skip the missed calls */
+		kMaxLateness = 1000000,
+		/** Time between the reports of the lateness, in microseconds */
+		kLatenessReportInterval = 10000000
+	};
+
+	/** Protects the queue, held only for short amounts of time */
 	Common::Mutex _mutex;
-	TimerSlot *_head;
+	/** Held while running callbacks */
+	Common::Mutex _callbackMutex;
+
+	/** Binary min-heap of the timers */
+	Common::Array<TimerSlot *> _queue;
+	uint32 _nextOrder;
 	TimerSlotMap _callbacks;
 
+	/** Time in microseconds, extended from getMillis() so it doesn't wrap */
+	uint64 _time;
+	uint32 _lastMillis;
+
+	/** How late the timers fired since the last report */
+	uint64 _latenessReportTime;
+	uint64 _totalLateness;
+	uint32 _maxLateness;
+	uint32 _lateCount;
+
 	uint32 _timerCallbackNext;
 
+	uint64 updateTime();
+	bool isEarlier(const TimerSlot *a, const TimerSlot *b) const;
+	void pushSlot(TimerSlot *slot);
+	void removeSlot(uint index);
+	void recordLateness(uint32 lateness);
+
 public:
 	DefaultTimerManager();
 	virtual ~DefaultTimerManager();
@@ -47,8 +86,12 @@ public:
 
 	/**
 	 * Timer callback, to be invoked at regular time intervals by the backend.
+	 * Fires the timers which are due when it is called.
+	 *
+	 * @return  The time in milliseconds until the next timer is due, at
+	 *          least 1, so that the backend can wait exactly that long.
 	 */
-	void handler();
+	uint32 handler();
 
 	/*
 	 * Ensure that the callback is called at regular time intervals.
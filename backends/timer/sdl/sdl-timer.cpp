@@ -27,10 +27,12 @@
 #include "backends/timer/sdl/sdl-timer.h"
 
 #include "common/textconsole.h"
+#include "common/util.h"
 
 static Uint32 timer_handler(Uint32 interval, void *param) {
-	((DefaultTimerManager *)param)->handler();
-	return interval;
+	// Wake up when the next timer is due, but at least every 10 ms to
+	// notice the timers installed in the meantime
+	return MIN<uint32>(((DefaultTimerManager *)param)->handler(), 10);
 }
 
 SdlTimerManager::SdlTimerManager() {
@@ -289,6 +289,9 @@ void registerDefaults() {
 	ConfMan.registerDefault("dump_midi", false);
 	ConfMan.registerDefault("enable_gs", false);
 	ConfMan.registerDefault("midi_gain", 100);
+	ConfMan.registerDefault("midi_prerender_path", "");
+	ConfMan.registerDefault("mt32_render_ahead", 0);
+	ConfMan.registerDefault("mt32_partial_cache", 0);
 
 	ConfMan.registerDefault("music_driver", "auto");
 	ConfMan.registerDefault("mt32_device", "null");
@@ -366,6 +369,9 @@ void registerDefaults() {
 	ConfMan.registerDefault("fluidsynth_reverb_level", 90);
 
 	ConfMan.registerDefault("fluidsynth_misc_interpolation", "4th");
+	ConfMan.registerDefault("fluidsynth_misc_polyphony", 256);
+	ConfMan.registerDefault("fluidsynth_misc_cpu_budget", 0);
+	ConfMan.registerDefault("fluidsynth_misc_dynamic_loading", false);
 #endif
 #ifdef USE_DISCORD
 	ConfMan.registerDefault("discord_rpc", true);
@@ -410,7 +410,11 @@ bool PluginManagerUncached::loadPluginFromEngineId(const Common::String &engineI
 	}
 	// Check for a plugin with the same name as the engine before starting
 	// to scan all plugins
-	Common::String tentativeEnginePluginFilename = engineId;
+	Common::String tentativeEnginePluginFilename;
+#ifdef PLUGIN_PREFIX
+	tentativeEnginePluginFilename += PLUGIN_PREFIX;
+#endif
+	tentativeEnginePluginFilename += engineId;
 #ifdef PLUGIN_SUFFIX
 	tentativeEnginePluginFilename += PLUGIN_SUFFIX;
 #endif
@@ -662,11 +666,9 @@ DECLARE_SINGLETON(EngineManager);
 }
 
 /**
- * This function works for both cached and uncached PluginManagers.
- * For the cached version, most of the logic here will short circuit.
- *
- * For the uncached version, we first try to find the plugin using the engineId
- * and only if we can't find it there, we loop through the plugins.
+ * This function works for both cached and uncached PluginManagers, as
+ * it only relies on the MetaEngineDetection plugins which are always
+ * kept in memory while the launcher is running.
  **/
 QualifiedGameList EngineManager::findGamesMatching(const Common::String &engineId, const Common::String &gameId) const {
 	QualifiedGameList results;
@@ -684,11 +686,9 @@ QualifiedGameList EngineManager::findGamesMatching(const Common::String &engineI
 			}
 		}
 	} else {
-		// This is a slow path, we have to scan the list of plugins
-		PluginMan.loadFirstPlugin();
-		do {
-			results.push_back(findGameInLoadedPlugins(gameId));
-		} while (PluginMan.loadNextPlugin());
+		// The detection tables of all engines are available without loading
+		// the engine plugins, so there is no need to scan those
+		results.push_back(findGameInLoadedPlugins(gameId));
 	}
 
 	return results;
@@ -828,6 +828,20 @@ const Plugin *PluginManager::findLoadedPlugin(const Common::String &engineId) {
 	return nullptr;
 }
 
+bool PluginManager::isEngineKnown(const Common::String &engineId) {
+	const PluginList &plugins = getPlugins(PLUGIN_TYPE_ENGINE_DETECTION);
+
+	// Without detection plugins in memory, we cannot tell
+	if (plugins.empty())
+		return true;
+
+	for (PluginList::const_iterator iter = plugins.begin(); iter != plugins.end(); iter++)
+		if (engineId == (*iter)->get<MetaEngineDetection>().getEngineId())
+			return true;
+
+	return false;
+}
+
 const Plugin *PluginManager::findEnginePlugin(const Common::String &engineId) {
 	// First look for the game using the plugins in memory. This is critical
 	// for calls coming from inside games
@@ -843,6 +857,11 @@ const Plugin *PluginManager::findEnginePlugin(const Common::String &engineId) {
 			return plugin;
 	}
 
+	// If the detection plugins are available, they tell us whether the engine
+	// has been built at all. Don't load every plugin just to find out it hasn't.
+	if (!isEngineKnown(engineId))
+		return nullptr;
+
 	// We failed to find it using the engine ID. Scan the list of plugins
 	PluginMan.loadFirstPlugin();
 	do {
@@ -306,6 +306,7 @@ protected:
 	void addToPluginsInMemList(Plugin *plugin);
 	const Plugin *findEnginePlugin(const Common::String &engineId);
 	const Plugin *findLoadedPlugin(const Common::String &engineId);
+	bool isEngineKnown(const Common::String &engineId);
 
 	static PluginManager *_instance;
 	PluginManager();
@@ -44,6 +44,8 @@ MODULE_OBJS := \
 	system.o \
 	textconsole.o \
 	text-to-speech.o \
+	thread.o \
+	threadpool.o \
 	tokenizer.o \
 	translation.o \
 	unarj.o \
@@ -26,6 +26,7 @@
 #include "common/noncopyable.h"
 #include "common/array.h" // For OSystem::getGlobalKeymaps()
 #include "common/list.h" // For OSystem::getSupportedFormats()
+#include "common/thread.h"
 #include "common/ustr.h"
 #include "graphics/pixelformat.h"
 #include "graphics/mode.h"
@@ -1451,6 +1452,9 @@ public:
 	 *
 	 * Hence, backends that do not use threads to implement the timers can simply
 	 * use dummy implementations for these methods.
+	 *
+	 * Backends that do have threads can additionally offer them through
+	 * createThread(). Code using it must keep working when it returns 0.
 	 */
 
 	/**
@@ -1460,6 +1464,35 @@ public:
 	 */
 	virtual Common::MutexInternal *createMutex() = 0;
 
+	/**
+	 * Start a new thread running proc(param).
+	 *
+	 * Threads are optional and only meant for work that can just as well
+	 * be done on the calling thread, like decoding ahead. The default
+	 * implementation does not support them.
+	 *
+	 * @return The new thread, or 0 if threads are not supported.
+	 */
+	virtual Common::ThreadInternal *createThread(Common::ThreadProc proc, void *param) { return nullptr; }
+
+	/**
+	 * Create a new semaphore with the given initial value.
+	 *
+	 * Backends implementing createThread() must implement this too. The
+	 * default implementation is meant for backends without threads.
+	 *
+	 * @return The new semaphore, or 0 if threads are not supported.
+	 */
+	virtual Common::SemaphoreInternal *createSemaphore(uint value) { return nullptr; }
+
+	/**
+	 * Return the number of threads that can usefully run at the same time.
+	 *
+	 * This is used to decide how to split work between threads. The default
+	 * implementation returns 1.
+	 */
+	virtual uint getCPUCount() const { return 1; }
+
 	/** @} */
 
 
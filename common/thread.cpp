@@ -0,0 +1,72 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/thread.h"
+#include "common/system.h"
+
+namespace Common {
+
+Thread::Thread() : _thread(nullptr) {
+}
+
+Thread::~Thread() {
+	join();
+}
+
+bool Thread::start(ThreadProc proc, void *param) {
+	assert(g_system);
+
+	if (_thread)
+		return false;
+
+	_thread = g_system->createThread(proc, param);
+	return _thread != nullptr;
+}
+
+void Thread::join() {
+	if (!_thread)
+		return;
+
+	_thread->join();
+	delete _thread;
+	_thread = nullptr;
+}
+
+Semaphore::Semaphore(uint value) {
+	assert(g_system);
+	_semaphore = g_system->createSemaphore(value);
+}
+
+Semaphore::~Semaphore() {
+	delete _semaphore;
+}
+
+void Semaphore::wait() {
+	if (_semaphore)
+		_semaphore->wait();
+}
+
+void Semaphore::signal() {
+	if (_semaphore)
+		_semaphore->signal();
+}
+
+} // End of namespace Common
@@ -0,0 +1,115 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef COMMON_THREAD_H
+#define COMMON_THREAD_H
+
+#include "common/scummsys.h"
+
+namespace Common {
+
+/**
+ * @defgroup common_thread Thread
+ * @ingroup common
+ *
+ * @brief API for running work on a separate thread.
+ *
+ * Threads are optional: backends that do not support them return 0 from
+ * OSystem::createThread(), and users are expected to do the work on the
+ * calling thread instead.
+ * @{
+ */
+
+/** Entry point of a thread, see OSystem::createThread(). */
+typedef void (*ThreadProc)(void *param);
+
+class ThreadInternal {
+public:
+	virtual ~ThreadInternal() {}
+
+	/** Wait for the thread to return from its entry point. */
+	virtual void join() = 0;
+};
+
+/**
+ * Wrapper class around the OSystem thread functions.
+ *
+ * The thread is joined when the object is destroyed.
+ */
+class Thread {
+	ThreadInternal *_thread;
+
+public:
+	Thread();
+	~Thread();
+
+	/**
+	 * Run proc(param) on a new thread.
+	 *
+	 * @return False if a thread is already running, or if the backend
+	 *         does not support threads.
+	 */
+	bool start(ThreadProc proc, void *param);
+
+	/** Wait for the running thread to finish. */
+	void join();
+
+	/** Return whether a thread was started and not joined yet. */
+	bool isRunning() const { return _thread != nullptr; }
+};
+
+class SemaphoreInternal {
+public:
+	virtual ~SemaphoreInternal() {}
+
+	/** Wait for the value to be positive, then decrement it. */
+	virtual void wait() = 0;
+
+	/** Increment the value, waking up one waiting thread. */
+	virtual void signal() = 0;
+};
+
+/**
+ * Wrapper class around the OSystem semaphore functions.
+ *
+ * Lets a thread sleep until another one has work for it, instead of
+ * polling. Backends without threads have nothing to wait for, so there
+ * wait() and signal() do nothing.
+ */
+class Semaphore {
+	SemaphoreInternal *_semaphore;
+
+public:
+	explicit Semaphore(uint value = 0);
+	~Semaphore();
+
+	/** Wait for the value to be positive, then decrement it. */
+	void wait();
+
+	/** Increment the value, waking up one waiting thread. */
+	void signal();
+};
+
+/** @} */
+
+} // End of namespace Common
+
+#endif
@@ -0,0 +1,112 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/threadpool.h"
+#include "common/util.h"
+
+namespace Common {
+
+ThreadPool::ThreadPool() : _canStartThreads(true), _proc(nullptr), _params(nullptr), _count(0), _next(0), _quit(false) {
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		StackLock lock(_mutex);
+		_quit = true;
+	}
+
+	for (uint i = 0; i < _threads.size(); i++)
+		_start.signal();
+
+	// Joins the threads
+	for (uint i = 0; i < _threads.size(); i++)
+		delete _threads[i];
+}
+
+void ThreadPool::run(ThreadProc proc, void *const *params, uint count) {
+	if (!count)
+		return;
+
+	// The calling thread takes a part itself
+	while (_canStartThreads && _threads.size() < count - 1) {
+		Thread *thread = new Thread();
+
+		if (!thread->start(workerProc, this)) {
+			delete thread;
+			_canStartThreads = false;
+			break;
+		}
+
+		_threads.push_back(thread);
+	}
+
+	{
+		StackLock lock(_mutex);
+		_proc = proc;
+		_params = params;
+		_count = count;
+		_next = 0;
+	}
+
+	const uint workers = MIN<uint>(_threads.size(), count - 1);
+	for (uint i = 0; i < workers; i++)
+		_start.signal();
+
+	work();
+
+	for (uint i = 0; i < workers; i++)
+		_done.wait();
+}
+
+void ThreadPool::workerProc(void *param) {
+	ThreadPool &pool = *(ThreadPool *)param;
+
+	for (;;) {
+		pool._start.wait();
+
+		{
+			StackLock lock(pool._mutex);
+			if (pool._quit)
+				return;
+		}
+
+		pool.work();
+		pool._done.signal();
+	}
+}
+
+void ThreadPool::work() {
+	for (;;) {
+		uint i;
+
+		{
+			StackLock lock(_mutex);
+			if (_next >= _count)
+				return;
+
+			i = _next++;
+		}
+
+		_proc(_params[i]);
+	}
+}
+
+} // End of namespace Common
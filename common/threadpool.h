@@ -0,0 +1,84 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef COMMON_THREADPOOL_H
+#define COMMON_THREADPOOL_H
+
+#include "common/array.h"
+#include "common/mutex.h"
+#include "common/noncopyable.h"
+#include "common/thread.h"
+
+namespace Common {
+
+/**
+ * @defgroup common_threadpool Thread pool
+ * @ingroup common
+ *
+ * @brief API for splitting repeated work between threads.
+ * @{
+ */
+
+/**
+ * Threads kept waiting to split work between.
+ *
+ * The threads are started on first use and kept until the pool is
+ * destroyed, so that work done for every frame does not start and join
+ * threads every time. Without thread support, the work runs on the
+ * calling thread.
+ *
+ * A pool runs one batch at a time, so it should have a single owner.
+ */
+class ThreadPool : NonCopyable {
+public:
+	ThreadPool();
+	~ThreadPool();
+
+	/**
+	 * Call proc(params[i]) for each of the given parameters and wait for
+	 * all calls to return.
+	 *
+	 * The calling thread takes part in the work. Use
+	 * OSystem::getCPUCount() to decide how many parts to split it into.
+	 */
+	void run(ThreadProc proc, void *const *params, uint count);
+
+private:
+	static void workerProc(void *param);
+	void work();
+
+	Array<Thread *> _threads;
+	bool _canStartThreads;
+
+	Semaphore _start, _done;
+
+	Mutex _mutex;
+	ThreadProc _proc;
+	void *const *_params;
+	uint _count, _next;
+	bool _quit;
+};
+
+/** @} */
+
+} // End of namespace Common
+
+#endif
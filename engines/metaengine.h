@@ -597,9 +597,8 @@ public:
 	/**
 	 * List games matching the specified criteria.
 	 *
-	 * If the engine ID is not specified, this scans all the plugins,
-	 * loading them from the disk if necessary. This is a slow operation on
-	 * some platforms and should not be used for the happy path.
+	 * If the engine ID is not specified, this searches the detection tables
+	 * of all engines. No engine plugin needs to be loaded for that.
 	 */
 	QualifiedGameList findGamesMatching(const Common::String &engineId, const Common::String &gameId) const;
 
@@ -36,8 +36,12 @@
 
 namespace Mohawk {
 
-RivenVideo::RivenVideo(MohawkEngine_Riven *vm, uint16 code) :
+// Memory budget for the frames of all looping movies
+static const uint32 kLoopFrameCacheSize = 16 * 1024 * 1024;
+
+RivenVideo::RivenVideo(MohawkEngine_Riven *vm, uint16 code, Video::FrameCacheBudget *frameCacheBudget) :
 		_vm(vm),
+		_frameCacheBudget(frameCacheBudget),
 		_id(0),
 		_slot(code),
 		_x(0),
@@ -109,6 +113,15 @@ void RivenVideo::seek(uint32 time) {
 	}
 }
 
+void RivenVideo::setLooping(bool loop) {
+	_loop = loop;
+
+	// Looping ambient movies are short, replay their frames from memory
+	// instead of decoding them again on every loop
+	if (_loop && _video && !_video->setFrameCache(_frameCacheBudget))
+		debug(2, "Movie %d can't cache its frames", _id);
+}
+
 void RivenVideo::pause(bool isPaused) {
 	if (_video) {
 		_video->pauseVideo(isPaused);
@@ -132,10 +145,12 @@ void RivenVideo::setVolume(int volume) {
 }
 
 RivenVideoManager::RivenVideoManager(MohawkEngine_Riven *vm) : _vm(vm) {
+	_frameCacheBudget = new Video::FrameCacheBudget(kLoopFrameCacheSize);
 }
 
 RivenVideoManager::~RivenVideoManager() {
 	removeVideos();
+	delete _frameCacheBudget;
 }
 
 void RivenVideoManager::pauseVideos() {
@@ -313,7 +328,7 @@ RivenVideo *RivenVideoManager::openSlot(uint16 slot) {
 		return oldHandle;
 
 	// Create the video
-	RivenVideo *video = new RivenVideo(_vm, slot);
+	RivenVideo *video = new RivenVideo(_vm, slot, _frameCacheBudget);
 
 	// Add it to the video list
 	_videos.push_back(video);
@@ -26,6 +26,7 @@
 #include "common/noncopyable.h"
 
 namespace Video {
+class FrameCacheBudget;
 class QuickTimeDecoder;
 }
 
@@ -38,7 +39,7 @@ class MohawkEngine_Riven;
  */
 class RivenVideo : private Common::NonCopyable {
 public:
-	RivenVideo(MohawkEngine_Riven *vm, uint16 code);
+	RivenVideo(MohawkEngine_Riven *vm, uint16 code, Video::FrameCacheBudget *frameCacheBudget);
 	~RivenVideo();
 
 	/** Load the video from the archive */
@@ -84,7 +85,7 @@ public:
 	void moveTo(uint16 x, uint16 y) { _x = x; _y = y; }
 
 	/** Set the video to loop (true) or not (false) */
-	void setLooping(bool loop) { _loop = loop; }
+	void setLooping(bool loop);
 
 	/** Enable the video */
 	void enable();
@@ -115,6 +116,7 @@ public:
 private:
 	// Non-changing variables
 	MohawkEngine_Riven *_vm;
+	Video::FrameCacheBudget *_frameCacheBudget;
 	Video::QuickTimeDecoder *_video;
 	uint16 _id;
 	uint16 _slot;
@@ -148,6 +150,9 @@ private:
 	// Keep tabs on any videos playing
 	typedef Common::List<RivenVideo *> VideoList;
 	VideoList _videos;
+
+	// Memory for the frames of the looping movies
+	Video::FrameCacheBudget *_frameCacheBudget;
 };
 
 } // End of namespace Mohawk
@@ -30,14 +30,13 @@ namespace Gfx {
 TinyGlTexture::TinyGlTexture() :
 	Texture(),
 	_id(0),
-	_levelCount(0) {
+	_levelCount(0),
+	_minFilter(TGL_NEAREST),
+	_magFilter(TGL_NEAREST) {
 	tglGenTextures(1, &_id);
 
 	bind();
 
-	tglTexParameteri(TGL_TEXTURE_2D, TGL_TEXTURE_MIN_FILTER, TGL_NEAREST);
-	tglTexParameteri(TGL_TEXTURE_2D, TGL_TEXTURE_MAG_FILTER, TGL_NEAREST);
-
 	tglTexParameteri(TGL_TEXTURE_2D, TGL_TEXTURE_WRAP_S, TGL_CLAMP_TO_EDGE);
 	tglTexParameteri(TGL_TEXTURE_2D, TGL_TEXTURE_WRAP_T, TGL_CLAMP_TO_EDGE);
 }
@@ -56,6 +55,9 @@ void TinyGlTexture::updateLevel(uint32 level, const Graphics::Surface *surface,
 		_height = surface->h;
 	}
 
+	tglTexParameteri(TGL_TEXTURE_2D, TGL_TEXTURE_MIN_FILTER, _minFilter);
+	tglTexParameteri(TGL_TEXTURE_2D, TGL_TEXTURE_MAG_FILTER, _magFilter);
+
 	if (surface->format.bytesPerPixel != 4) {
 		// Convert the surface to texture format
 		Graphics::Surface *convertedSurface = surface->convertTo(Driver::getRGBAPixelFormat(), palette);
@@ -80,12 +82,12 @@ void TinyGlTexture::setSamplingFilter(Texture::SamplingFilter filter) {
 
 	switch (filter) {
 	case kNearest:
-		tglTexParameteri(TGL_TEXTURE_2D, TGL_TEXTURE_MIN_FILTER, TGL_NEAREST);
-		tglTexParameteri(TGL_TEXTURE_2D, TGL_TEXTURE_MAG_FILTER, TGL_NEAREST);
+		_minFilter = TGL_NEAREST;
+		_magFilter = TGL_NEAREST;
 		break;
 	case kLinear:
-		tglTexParameteri(TGL_TEXTURE_2D, TGL_TEXTURE_MIN_FILTER, TGL_LINEAR);
-		tglTexParameteri(TGL_TEXTURE_2D, TGL_TEXTURE_MAG_FILTER, TGL_LINEAR);
+		_minFilter = TGL_LINEAR;
+		_magFilter = TGL_LINEAR;
 		break;
 	default:
 		warning("Unhandled sampling filter %d", filter);
@@ -96,6 +98,11 @@ void TinyGlTexture::setLevelCount(uint32 count) {
 	_levelCount = count;
 
 	if (count >= 1) {
+		// Like the OpenGL renderer. TinyGL generates the smaller levels
+		// from the first one rather than using the uploaded ones.
+		_minFilter = count > 1 ? TGL_LINEAR_MIPMAP_NEAREST : TGL_LINEAR;
+		_magFilter = TGL_LINEAR;
+
 		tglTexParameteri(TGL_TEXTURE_2D, TGL_TEXTURE_WRAP_S, TGL_MIRRORED_REPEAT);
 		tglTexParameteri(TGL_TEXTURE_2D, TGL_TEXTURE_WRAP_T, TGL_MIRRORED_REPEAT);
 	}
@@ -49,6 +49,11 @@ protected:
 
 	TGLuint _id;
 	uint32 _levelCount;
+
+	// TinyGL applies the filters of the context when the texture is
+	// uploaded, so they are kept here and set again before each upload
+	TGLint _minFilter;
+	TGLint _magFilter;
 };
 
 } // End of namespace Gfx
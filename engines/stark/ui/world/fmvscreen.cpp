@@ -82,6 +82,9 @@ void FMVScreen::play(const Common::String &name) {
 	if (!_decoder->isVideoLoaded()) {
 		error("Could not open %s", name.c_str());
 	}
+
+	// Decode a few frames ahead to even out the cost of the expensive ones
+	_decoder->setDecodeAhead(4);
 	_decoder->start();
 }
 
@@ -65,6 +65,11 @@ MusicPlayer::MusicPlayer(bool isGM) : _isGM(isGM), _buffer(NULL) {
 	}
 }
 
+MusicPlayer::~MusicPlayer() {
+	// The tracks are rendered through send()
+	stopPrerendering();
+}
+
 void MusicPlayer::send(uint32 b) {
 	if (_milesAudioMode) {
 		_driver->send(b);
@@ -83,6 +88,10 @@ void MusicPlayer::playMIDI(const byte *data, uint32 size, bool loop) {
 
 	stopAndClear();
 
+	// The Miles drivers set up instruments which aren't part of the tracks
+	if (!_milesAudioMode && playPrerendered(data, size, !memcmp(data, "FORM", 4) ? Audio::MidiPrerenderer::kFormatXMIDI : Audio::MidiPrerenderer::kFormatSMF, loop))
+		return;
+
 	_buffer = new byte[size];
 	memcpy(_buffer, data, size);
 
@@ -34,6 +34,7 @@ class ArchiveReader;
 class MusicPlayer : public Audio::MidiPlayer {
 public:
 	MusicPlayer(bool isGM = true);
+	~MusicPlayer() override;
 
 	void playMIDI(const byte *data, uint32 size, bool loop = false);
 	void stopAndClear();
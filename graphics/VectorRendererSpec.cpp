@@ -32,6 +32,10 @@
 
 #define VECTOR_RENDERER_FAST_TRIANGLES
 
+// The span fill and span blend loops below are vectorized with SSE2 or NEON;
+// other targets use the plain C++ loops.
+#include "common/simd.h"
+
 /** Fixed point SQUARE ROOT **/
 inline frac_t fp_sqroot(uint32 x) {
 #if 0
@@ -443,6 +447,31 @@ void colorFill(PixelType *first, PixelType *last, PixelType color) {
 	int count = (last - first);
 	if (!count)
 		return;
+
+#if defined(USE_SSE2) || defined(USE_NEON)
+	// Store 16 bytes at a time, the tail is handled by the loop below.
+	const int perVector = 16 / sizeof(PixelType);
+	if (count >= perVector) {
+#if defined(USE_SSE2)
+		const __m128i c = (sizeof(PixelType) == 2) ? _mm_set1_epi16((short)color) : _mm_set1_epi32((int)color);
+		do {
+			_mm_storeu_si128((__m128i *)first, c);
+			first += perVector;
+			count -= perVector;
+		} while (count >= perVector);
+#else
+		const uint8x16_t c = (sizeof(PixelType) == 2) ? vreinterpretq_u8_u16(vdupq_n_u16((uint16)color)) : vreinterpretq_u8_u32(vdupq_n_u32((uint32)color));
+		do {
+			vst1q_u8((uint8 *)first, c);
+			first += perVector;
+			count -= perVector;
+		} while (count >= perVector);
+#endif
+		if (!count)
+			return;
+	}
+#endif
+
 	int n = (count + 7) >> 3;
 	switch (count % 8) {
 	default:
@@ -481,24 +510,112 @@ void colorFillClip(PixelType *first, PixelType *last, PixelType color, int realX
 		count -= diff;
 	}
 
-	if (!count)
+	if (count <= 0)
 		return;
 
-	int n = (count + 7) >> 3;
-	switch (count % 8) {
-	default:
-	case 0:	do {
-	       		*first++ = color; // fall through
-	case 7:		*first++ = color; // fall through
-	case 6:		*first++ = color; // fall through
-	case 5:		*first++ = color; // fall through
-	case 4:		*first++ = color; // fall through
-	case 3:		*first++ = color; // fall through
-	case 2:		*first++ = color; // fall through
-	case 1:		*first++ = color;
-	       	} while (--n > 0);
+	colorFill<PixelType>(first, first + count, color);
+}
+
+#if defined(USE_SSE2) || defined(USE_NEON)
+/**
+ * Blends a constant color into a row of 32bpp pixels, four pixels at a time.
+ *
+ * Every channel must be stored as a whole byte. Each byte is blended with
+ * (s * alpha + d * (256 - alpha)) >> 8, which is the same value
+ * d + (((s - d) * alpha) >> 8) produces in blendPixelPtr, and the result is
+ * masked with the used channel bits afterwards.
+ *
+ * @return Pointer to the first pixel which was not processed.
+ */
+static uint32 *blendSpan32(uint32 *first, uint32 *last, uint32 color, uint32 channelMask, uint8 alpha) {
+#if defined(USE_SSE2)
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i src = _mm_mullo_epi16(_mm_unpacklo_epi8(_mm_set1_epi32((int)color), zero), _mm_set1_epi16(alpha));
+	const __m128i invAlpha = _mm_set1_epi16(256 - alpha);
+	const __m128i mask = _mm_set1_epi32((int)channelMask);
+
+	while (last - first >= 4) {
+		const __m128i d = _mm_loadu_si128((const __m128i *)first);
+		__m128i lo = _mm_unpacklo_epi8(d, zero);
+		__m128i hi = _mm_unpackhi_epi8(d, zero);
+		lo = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(lo, invAlpha), src), 8);
+		hi = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(hi, invAlpha), src), 8);
+		_mm_storeu_si128((__m128i *)first, _mm_and_si128(_mm_packus_epi16(lo, hi), mask));
+		first += 4;
+	}
+#else
+	const uint16x8_t src = vmulq_n_u16(vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(color))), alpha);
+	const uint16x8_t invAlpha = vdupq_n_u16(256 - alpha);
+	const uint8x16_t mask = vreinterpretq_u8_u32(vdupq_n_u32(channelMask));
+
+	while (last - first >= 4) {
+		const uint8x16_t d = vld1q_u8((const uint8 *)first);
+		const uint8x8_t lo = vshrn_n_u16(vmlaq_u16(src, vmovl_u8(vget_low_u8(d)), invAlpha), 8);
+		const uint8x8_t hi = vshrn_n_u16(vmlaq_u16(src, vmovl_u8(vget_high_u8(d)), invAlpha), 8);
+		vst1q_u8((uint8 *)first, vandq_u8(vcombine_u8(lo, hi), mask));
+		first += 4;
+	}
+#endif
+	return first;
+}
+
+/**
+ * Blends a constant color into a row of 16bpp pixels, eight pixels at a time.
+ *
+ * Channels are unpacked into their own 16-bit lanes, blended the same way as
+ * in blendSpan32 and packed again. Blending the unpacked channel gives the
+ * same result as the masked in-place arithmetic of blendPixelPtr.
+ *
+ * @return Pointer to the first pixel which was not processed.
+ */
+static uint16 *blendSpan16(uint16 *first, uint16 *last, uint16 color, const Graphics::PixelFormat &format, uint8 alpha) {
+	const int shifts[4] = { format.rShift, format.gShift, format.bShift, format.aShift };
+	const int maxes[4] = { 0xFF >> format.rLoss, 0xFF >> format.gLoss, 0xFF >> format.bLoss, 0xFF >> format.aLoss };
+	// The alpha channel is always blended towards fully opaque
+	const int sources[4] = {
+		(color >> format.rShift) & maxes[0],
+		(color >> format.gShift) & maxes[1],
+		(color >> format.bShift) & maxes[2],
+		maxes[3]
+	};
+
+#if defined(USE_SSE2)
+	const __m128i invAlpha = _mm_set1_epi16(256 - alpha);
+
+	while (last - first >= 8) {
+		const __m128i d = _mm_loadu_si128((const __m128i *)first);
+		__m128i result = _mm_setzero_si128();
+		for (int i = 0; i < 4; ++i) {
+			if (!maxes[i])
+				continue;
+			const __m128i shift = _mm_cvtsi32_si128(shifts[i]);
+			__m128i c = _mm_and_si128(_mm_srl_epi16(d, shift), _mm_set1_epi16(maxes[i]));
+			c = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(c, invAlpha), _mm_set1_epi16(sources[i] * alpha)), 8);
+			result = _mm_or_si128(result, _mm_sll_epi16(c, shift));
+		}
+		_mm_storeu_si128((__m128i *)first, result);
+		first += 8;
 	}
+#else
+	const uint16x8_t invAlpha = vdupq_n_u16(256 - alpha);
+
+	while (last - first >= 8) {
+		const uint16x8_t d = vld1q_u16(first);
+		uint16x8_t result = vdupq_n_u16(0);
+		for (int i = 0; i < 4; ++i) {
+			if (!maxes[i])
+				continue;
+			uint16x8_t c = vandq_u16(vshlq_u16(d, vdupq_n_s16(-shifts[i])), vdupq_n_u16(maxes[i]));
+			c = vshrq_n_u16(vmlaq_u16(vdupq_n_u16(sources[i] * alpha), c, invAlpha), 8);
+			result = vorrq_u16(result, vshlq_u16(c, vdupq_n_s16(shifts[i])));
+		}
+		vst1q_u16(first, result);
+		first += 8;
+	}
+#endif
+	return first;
 }
+#endif
 
 /**
  * Fills several pixels in a column with a given color.
@@ -907,6 +1024,47 @@ blendPixelPtr(PixelType *ptr, PixelType color, uint8 alpha) {
 	}
 }
 
+template<typename PixelType>
+void VectorRendererSpec<PixelType>::
+blendFill(PixelType *first, PixelType *last, PixelType color, uint8 alpha) {
+	if (alpha == 0xff) {
+		colorFill<PixelType>(first, last, color | _alphaMask);
+		return;
+	}
+
+#if defined(USE_SSE2) || defined(USE_NEON)
+	if (sizeof(PixelType) == 2) {
+		first = (PixelType *)blendSpan16((uint16 *)first, (uint16 *)last, (uint16)color, _format, alpha);
+	} else if (sizeof(PixelType) == 4 && _format.rLoss == 0 && _format.gLoss == 0 && _format.bLoss == 0 &&
+	           (_format.aLoss == 0 || _format.aLoss == 8) && !(_format.rShift & 7) && !(_format.gShift & 7) &&
+	           !(_format.bShift & 7) && !(_format.aShift & 7)) {
+		first = (PixelType *)blendSpan32((uint32 *)first, (uint32 *)last, (uint32)(color | _alphaMask),
+		                                 (uint32)(_redMask | _greenMask | _blueMask | _alphaMask), alpha);
+	}
+#endif
+
+	while (first < last)
+		blendPixelPtr(first++, color, alpha);
+}
+
+template<typename PixelType>
+void VectorRendererSpec<PixelType>::
+blendFillClip(PixelType *first, PixelType *last, PixelType color, uint8 alpha, int realX, int realY) {
+	if (realY < _clippingArea.top || realY >= _clippingArea.bottom)
+		return;
+
+	if (realX < _clippingArea.left) {
+		first += _clippingArea.left - realX;
+		realX = _clippingArea.left;
+	}
+
+	if (last - first > _clippingArea.right - realX)
+		last = first + (_clippingArea.right - realX);
+
+	if (first < last)
+		blendFill(first, last, color, alpha);
+}
+
 template<typename PixelType>
 inline void VectorRendererSpec<PixelType>::
 blendPixelPtrClip(PixelType *ptr, PixelType color, uint8 alpha, int x, int y) {
@@ -2013,8 +2171,9 @@ drawBevelSquareAlgClip(int x, int y, int w, int h, int bevel, PixelType top_colo
 		}
 	} else {
 		while (i-- ) {
-			blendFillClip(ptr_left, ptr_left + w, ptr_x, ptr_y, _bgColor, 200);
+			blendFillClip(ptr_left, ptr_left + w, _bgColor, 200, ptr_x, ptr_y);
 			ptr_left += pitch;
+			++ptr_y;
 		}
 	}
 
@@ -32,6 +32,10 @@
 #include "common/math.h"
 #include "common/rect.h"
 
+// crossBlit converts four pixels at a time with SSE2 or NEON; other targets
+// use the scalar loops.
+#include "common/simd.h"
+
 namespace Graphics {
 
 // TODO: YUV to RGB conversion function
@@ -195,6 +199,170 @@ inline void crossBlitLogic3BppSource(byte *dst, const byte *src, const uint w, c
 	}
 }
 
+/**
+ * Shifts and masks for converting between two pixel formats, fixed for a
+ * whole blit.
+ *
+ * This only handles source formats whose color channels have 4 to 8 bits
+ * each and whose alpha channel is absent or has 4 to 8 bits. Channels like
+ * that are expanded to 8 bits with (c << (8 - bits)) | (c >> (2 * bits - 8)),
+ * which gives the same values as PixelFormat::colorToARGB.
+ */
+struct FastConversion {
+	// Channels in A, R, G, B order; unused channels have a zero mask
+	uint32 srcShift[4], srcMask[4];
+	uint32 expandLeft[4], expandRight[4];
+	uint32 dstLoss[4], dstShift[4];
+	// Bits set in every destination pixel (opaque alpha for sources without one)
+	uint32 constant;
+
+#if defined(USE_SSE2)
+	__m128i vSrcShift[4], vSrcMask[4], vExpandLeft[4], vExpandRight[4], vDstLoss[4], vDstShift[4], vConstant;
+#elif defined(USE_NEON)
+	int32x4_t vSrcShift[4], vExpandLeft[4], vExpandRight[4], vDstLoss[4], vDstShift[4];
+	uint32x4_t vSrcMask[4], vConstant;
+#endif
+
+	bool init(const PixelFormat &dstFmt, const PixelFormat &srcFmt) {
+		const uint srcBits[4] = { srcFmt.aBits(), srcFmt.rBits(), srcFmt.gBits(), srcFmt.bBits() };
+		const uint srcShifts[4] = { srcFmt.aShift, srcFmt.rShift, srcFmt.gShift, srcFmt.bShift };
+		const uint dstLosses[4] = { dstFmt.aLoss, dstFmt.rLoss, dstFmt.gLoss, dstFmt.bLoss };
+		const uint dstShifts[4] = { dstFmt.aShift, dstFmt.rShift, dstFmt.gShift, dstFmt.bShift };
+
+		constant = 0;
+		for (int i = 0; i < 4; ++i) {
+			const uint bits = srcBits[i];
+			if (bits == 0 && i == 0) {
+				// No source alpha, colorToARGB uses 0xFF
+				constant = (0xFF >> dstLosses[0]) << dstShifts[0];
+			} else if (bits < 4 || bits > 8) {
+				return false;
+			}
+
+			srcShift[i] = srcShifts[i];
+			srcMask[i] = (bits && dstLosses[i] < 8) ? (1 << bits) - 1 : 0;
+			expandLeft[i] = bits ? 8 - bits : 0;
+			expandRight[i] = bits ? 2 * bits - 8 : 0;
+			dstLoss[i] = dstLosses[i] < 8 ? dstLosses[i] : 0;
+			dstShift[i] = dstShifts[i];
+		}
+
+#if defined(USE_SSE2)
+		for (int i = 0; i < 4; ++i) {
+			vSrcShift[i] = _mm_cvtsi32_si128(srcShift[i]);
+			vSrcMask[i] = _mm_set1_epi32(srcMask[i]);
+			vExpandLeft[i] = _mm_cvtsi32_si128(expandLeft[i]);
+			vExpandRight[i] = _mm_cvtsi32_si128(expandRight[i]);
+			vDstLoss[i] = _mm_cvtsi32_si128(dstLoss[i]);
+			vDstShift[i] = _mm_cvtsi32_si128(dstShift[i]);
+		}
+		vConstant = _mm_set1_epi32(constant);
+#elif defined(USE_NEON)
+		for (int i = 0; i < 4; ++i) {
+			// vshlq shifts right for negative counts
+			vSrcShift[i] = vdupq_n_s32(-(int32)srcShift[i]);
+			vSrcMask[i] = vdupq_n_u32(srcMask[i]);
+			vExpandLeft[i] = vdupq_n_s32(expandLeft[i]);
+			vExpandRight[i] = vdupq_n_s32(-(int32)expandRight[i]);
+			vDstLoss[i] = vdupq_n_s32(-(int32)dstLoss[i]);
+			vDstShift[i] = vdupq_n_s32(dstShift[i]);
+		}
+		vConstant = vdupq_n_u32(constant);
+#endif
+		return true;
+	}
+
+	inline uint32 convert(uint32 color) const {
+		uint32 result = constant;
+		for (int i = 0; i < 4; ++i) {
+			const uint32 c = (color >> srcShift[i]) & srcMask[i];
+			result |= (((c << expandLeft[i]) | (c >> expandRight[i])) >> dstLoss[i]) << dstShift[i];
+		}
+		return result;
+	}
+
+#if defined(USE_SSE2) || defined(USE_NEON)
+	/** Converts four pixels at once. */
+	template<typename SrcColor, typename DstColor>
+	inline void convert4(DstColor *dst, const SrcColor *src) const {
+#if defined(USE_SSE2)
+		const __m128i color = (sizeof(SrcColor) == 2)
+			? _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i *)src), _mm_setzero_si128())
+			: _mm_loadu_si128((const __m128i *)src);
+
+		__m128i result = vConstant;
+		for (int i = 0; i < 4; ++i) {
+			const __m128i c = _mm_and_si128(_mm_srl_epi32(color, vSrcShift[i]), vSrcMask[i]);
+			const __m128i e = _mm_or_si128(_mm_sll_epi32(c, vExpandLeft[i]), _mm_srl_epi32(c, vExpandRight[i]));
+			result = _mm_or_si128(result, _mm_sll_epi32(_mm_srl_epi32(e, vDstLoss[i]), vDstShift[i]));
+		}
+
+		if (sizeof(DstColor) == 2) {
+			// Sign extend so the saturating pack keeps the low 16 bits
+			result = _mm_srai_epi32(_mm_slli_epi32(result, 16), 16);
+			_mm_storel_epi64((__m128i *)dst, _mm_packs_epi32(result, result));
+		} else {
+			_mm_storeu_si128((__m128i *)dst, result);
+		}
+#else
+		const uint32x4_t color = (sizeof(SrcColor) == 2)
+			? vmovl_u16(vld1_u16((const uint16 *)src))
+			: vld1q_u32((const uint32 *)src);
+
+		uint32x4_t result = vConstant;
+		for (int i = 0; i < 4; ++i) {
+			const uint32x4_t c = vandq_u32(vshlq_u32(color, vSrcShift[i]), vSrcMask[i]);
+			const uint32x4_t e = vorrq_u32(vshlq_u32(c, vExpandLeft[i]), vshlq_u32(c, vExpandRight[i]));
+			result = vorrq_u32(result, vshlq_u32(vshlq_u32(e, vDstLoss[i]), vDstShift[i]));
+		}
+
+		if (sizeof(DstColor) == 2)
+			vst1_u16((uint16 *)dst, vmovn_u32(result));
+		else
+			vst1q_u32((uint32 *)dst, result);
+#endif
+	}
+#endif
+};
+
+/**
+ * Converts one row with a FastConversion. Backward rows are converted from
+ * right to left, which is safe for in place conversions to a larger pixel
+ * size.
+ */
+template<typename SrcColor, typename DstColor, bool backward>
+inline void crossBlitRowFast(DstColor *dst, const SrcColor *src, const uint w, const FastConversion &conv) {
+	uint x = 0;
+
+	if (backward) {
+		x = w;
+#if defined(USE_SSE2) || defined(USE_NEON)
+		while (x >= 4) {
+			x -= 4;
+			conv.convert4<SrcColor, DstColor>(dst + x, src + x);
+		}
+#endif
+		while (x-- > 0)
+			dst[x] = conv.convert(src[x]);
+	} else {
+#if defined(USE_SSE2) || defined(USE_NEON)
+		for (; x + 4 <= w; x += 4)
+			conv.convert4<SrcColor, DstColor>(dst + x, src + x);
+#endif
+		for (; x < w; ++x)
+			dst[x] = conv.convert(src[x]);
+	}
+}
+
+template<typename SrcColor, typename DstColor, bool backward>
+inline void crossBlitLogicFast(byte *dst, const byte *src, const uint w, const uint h,
+							   const uint dstPitch, const uint srcPitch, const FastConversion &conv) {
+	for (uint y = 0; y < h; ++y) {
+		const uint row = backward ? h - 1 - y : y;
+		crossBlitRowFast<SrcColor, DstColor, backward>((DstColor *)(dst + row * dstPitch), (const SrcColor *)(src + row * srcPitch), w, conv);
+	}
+}
+
 } // End of anonymous namespace
 
 // Function to blit a rect from one color format to another
@@ -218,7 +386,25 @@ bool crossBlit(byte *dst, const byte *src,
 	const uint srcDelta = (srcPitch - w * srcFmt.bytesPerPixel);
 	const uint dstDelta = (dstPitch - w * dstFmt.bytesPerPixel);
 
-	// TODO: optimized cases for dstDelta of 0
+	// Common formats have a faster path with shifts fixed for the whole blit.
+	// Conversions to a larger pixel size go backward, like below.
+	FastConversion conv;
+	if (srcFmt.bytesPerPixel != 3 && conv.init(dstFmt, srcFmt)) {
+		if (dstFmt.bytesPerPixel == 2) {
+			if (srcFmt.bytesPerPixel == 2)
+				crossBlitLogicFast<uint16, uint16, false>(dst, src, w, h, dstPitch, srcPitch, conv);
+			else
+				crossBlitLogicFast<uint32, uint16, false>(dst, src, w, h, dstPitch, srcPitch, conv);
+			return true;
+		} else if (dstFmt.bytesPerPixel == 4) {
+			if (srcFmt.bytesPerPixel == 2)
+				crossBlitLogicFast<uint16, uint32, true>(dst, src, w, h, dstPitch, srcPitch, conv);
+			else
+				crossBlitLogicFast<uint32, uint32, false>(dst, src, w, h, dstPitch, srcPitch, conv);
+			return true;
+		}
+	}
+
 	if (dstFmt.bytesPerPixel == 2) {
 		if (srcFmt.bytesPerPixel == 2) {
 			crossBlitLogic<uint16, uint16, false>(dst, src, w, h, srcFmt, dstFmt, srcDelta, dstDelta);
@@ -184,6 +184,21 @@ private:
 	bool _allowLateCaching;
 	void assureCached(uint32 chr) const;
 
+	// Glyph images are packed into shared atlas pages instead of being
+	// allocated one by one. The pages are filled shelf by shelf.
+	enum {
+		kAtlasPageSize = 256
+	};
+
+	Surface allocateGlyphImage(int w, int h) const;
+	mutable Common::Array<Surface *> _atlasPages;
+	mutable Surface *_atlasPage;
+	mutable int _atlasX, _atlasY, _atlasShelfHeight;
+
+	// Kerning offsets by pair of glyph indices, (left << 16) | right
+	typedef Common::HashMap<uint32, int> KerningCache;
+	mutable KerningCache _kerning;
+
 	Common::SeekableReadStream *readTTFTable(FT_ULong tag) const;
 
 	int computePointSize(int size, TTFSizeMode sizeMode) const;
@@ -203,7 +218,8 @@ private:
 TTFFont::TTFFont()
 	: _initialized(false), _face(), _ttfFile(0), _size(0), _width(0), _height(0), _ascent(0),
 	  _descent(0), _glyphs(), _loadFlags(FT_LOAD_TARGET_NORMAL), _renderMode(FT_RENDER_MODE_NORMAL),
-	  _hasKerning(false), _allowLateCaching(false), _fakeBold(false), _fakeItalic(false) {
+	  _hasKerning(false), _allowLateCaching(false), _fakeBold(false), _fakeItalic(false),
+	  _atlasPage(nullptr), _atlasX(0), _atlasY(0), _atlasShelfHeight(0) {
 }
 
 TTFFont::~TTFFont() {
@@ -213,11 +229,14 @@ TTFFont::~TTFFont() {
 		delete[] _ttfFile;
 		_ttfFile = 0;
 
-		for (GlyphCache::iterator i = _glyphs.begin(), end = _glyphs.end(); i != end; ++i)
-			i->_value.image.free();
-
 		_initialized = false;
 	}
+
+	// The glyph images point into the atlas pages
+	for (uint i = 0; i < _atlasPages.size(); ++i) {
+		_atlasPages[i]->free();
+		delete _atlasPages[i];
+	}
 }
 
 bool TTFFont::load(Common::SeekableReadStream &stream, int size, TTFSizeMode sizeMode,
@@ -588,9 +607,23 @@ int TTFFont::getKerningOffset(uint32 left, uint32 right) const {
 	if (!leftGlyph || !rightGlyph)
 		return 0;
 
+	// TrueType glyph indices fit into 16 bits, other formats are not cached
+	const bool cacheable = leftGlyph <= 0xFFFF && rightGlyph <= 0xFFFF;
+	const uint32 pair = (leftGlyph << 16) | (rightGlyph & 0xFFFF);
+	if (cacheable) {
+		KerningCache::const_iterator kerningEntry = _kerning.find(pair);
+		if (kerningEntry != _kerning.end())
+			return kerningEntry->_value;
+	}
+
 	FT_Vector kerningVector;
 	FT_Get_Kerning(_face, leftGlyph, rightGlyph, FT_KERNING_DEFAULT, &kerningVector);
-	return (kerningVector.x / 64);
+	const int offset = kerningVector.x / 64;
+
+	if (cacheable)
+		_kerning[pair] = offset;
+
+	return offset;
 }
 
 Common::Rect TTFFont::getBoundingBox(uint32 chr) const {
@@ -632,6 +665,20 @@ static void renderGlyph(uint8 *dstPos, const int dstPitch, const uint8 *srcPos,
 					dstFormat.colorToARGB(*rDst, dA, dR, dG, dB);
 				}
 
+				if (dA == 255) {
+					// Opaque destination, which is the common case. The blend
+					// below then simplifies to a plain integer interpolation.
+					dR = (sR * sA + dR * (255 - sA)) / 255;
+					dG = (sG * sA + dG * (255 - sA)) / 255;
+					dB = (sB * sA + dB * (255 - sA)) / 255;
+
+					*rDst = dstFormat.ARGBToColor(255, dR, dG, dB);
+
+					++rDst;
+					++src;
+					continue;
+				}
+
 				double sAn = (double)sA / 255.0;
 				double dAn = (double)dA / 255.0;
 				double oAn = sAn + dAn * (1.0 - sAn);
@@ -811,7 +858,7 @@ bool TTFFont::cacheGlyph(Glyph &glyph, uint32 chr) const {
 	}
 
 
-	glyph.image.create(bitmap->width, bitmap->rows, PixelFormat::createFormatCLUT8());
+	glyph.image = allocateGlyphImage(bitmap->width, bitmap->rows);
 
 	const uint8 *src = bitmap->buffer;
 	int srcPitch = bitmap->pitch;
@@ -839,6 +886,7 @@ bool TTFFont::cacheGlyph(Glyph &glyph, uint32 chr) const {
 				++dst;
 			}
 
+			dst += glyph.image.pitch - bitmap->width;
 			src += srcPitch;
 		}
 		break;
@@ -852,8 +900,8 @@ bool TTFFont::cacheGlyph(Glyph &glyph, uint32 chr) const {
 		break;
 
 	default:
+		// The space in the atlas is lost, but this should not happen anyway
 		warning("TTFFont::cacheGlyph: Unsupported pixel mode %d", bitmap->pixel_mode);
-		glyph.image.free();
 		return false;
 	}
 
@@ -866,6 +914,44 @@ bool TTFFont::cacheGlyph(Glyph &glyph, uint32 chr) const {
 	return true;
 }
 
+Surface TTFFont::allocateGlyphImage(int w, int h) const {
+	Surface image;
+	if (!w || !h) {
+		image.format = PixelFormat::createFormatCLUT8();
+		return image;
+	}
+
+	// Big glyphs get a page of their own
+	if (w > kAtlasPageSize || h > kAtlasPageSize) {
+		Surface *page = new Surface();
+		page->create(w, h, PixelFormat::createFormatCLUT8());
+		_atlasPages.push_back(page);
+		return *page;
+	}
+
+	// Start a new shelf if the glyph does not fit on the current one
+	if (_atlasPage && _atlasX + w > kAtlasPageSize) {
+		_atlasX = 0;
+		_atlasY += _atlasShelfHeight;
+		_atlasShelfHeight = 0;
+	}
+
+	if (!_atlasPage || _atlasY + h > kAtlasPageSize) {
+		_atlasPage = new Surface();
+		_atlasPage->create(kAtlasPageSize, kAtlasPageSize, PixelFormat::createFormatCLUT8());
+		_atlasPages.push_back(_atlasPage);
+
+		_atlasX = _atlasY = _atlasShelfHeight = 0;
+	}
+
+	image = _atlasPage->getSubArea(Common::Rect(_atlasX, _atlasY, _atlasX + w, _atlasY + h));
+
+	_atlasX += w;
+	_atlasShelfHeight = MAX(_atlasShelfHeight, h);
+
+	return image;
+}
+
 void TTFFont::assureCached(uint32 chr) const {
 	if (!chr || !_allowLateCaching || _glyphs.contains(chr)) {
 		return;
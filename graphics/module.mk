@@ -55,6 +55,7 @@ ifdef USE_TINYGL
 MODULE_OBJS += \
 	tinygl/api.o \
 	tinygl/arrays.o \
+	tinygl/capture.o \
 	tinygl/clear.o \
 	tinygl/clip.o \
 	tinygl/get.o \
@@ -0,0 +1,347 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "graphics/tinygl/capture.h"
+#include "graphics/tinygl/tinygl.h"
+#include "graphics/tinygl/zgl.h"
+#include "graphics/tinygl/zdirtyrect.h"
+#include "graphics/tinygl/texelbuffer.h"
+
+#include "common/debug.h"
+#include "common/endian.h"
+#include "common/stream.h"
+
+namespace TinyGL {
+
+// The capture is a header followed by records, each starting with a tag
+enum {
+	kCaptureTag = MKTAG('T', 'G', 'L', 'C'),
+	kCaptureVersion = 1,
+
+	kRecordTexture = MKTAG('T', 'E', 'X', 'R'),
+	kRecordBlitImage = MKTAG('B', 'I', 'M', 'G'),
+	kRecordClear = MKTAG('C', 'L', 'E', 'R'),
+	kRecordRasterization = MKTAG('R', 'A', 'S', 'T'),
+	kRecordBlitting = MKTAG('B', 'L', 'I', 'T'),
+	kRecordFrameEnd = MKTAG('F', 'R', 'M', 'E')
+};
+
+// Texels and image pixels are written as R, G, B, A bytes
+static Graphics::PixelFormat getCapturePixelFormat() {
+#if defined(SCUMM_LITTLE_ENDIAN)
+	return Graphics::PixelFormat(4, 8, 8, 8, 8, 0, 8, 16, 24);
+#else
+	return Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0);
+#endif
+}
+
+void beginCapture(Common::WriteStream *stream, int frameCount, int skipFrames) {
+	GLContext *c = gl_get_context();
+	endCapture();
+
+	// Frames already being drawn are skipped
+	if (!c->_drawCallsQueue.empty()) {
+		skipFrames++;
+	}
+	c->_capture = new Internal::CaptureWriter(c, stream, frameCount, skipFrames);
+}
+
+void endCapture() {
+	GLContext *c = gl_get_context();
+	delete c->_capture;
+	c->_capture = nullptr;
+}
+
+bool isCapturing() {
+	return gl_get_context()->_capture != nullptr;
+}
+
+namespace Internal {
+
+CaptureWriter::CaptureWriter(GLContext *c, Common::WriteStream *stream, int frameCount, int skipFrames) :
+		_stream(stream), _frameCount(frameCount), _skipFrames(skipFrames), _nextBlitImageId(1) {
+	const Graphics::PixelFormat format = c->fb->getPixelFormat();
+
+	_stream->writeUint32BE(kCaptureTag);
+	_stream->writeUint32LE(kCaptureVersion);
+	_stream->writeUint32LE(c->fb->getPixelBufferWidth());
+	_stream->writeUint32LE(c->fb->getPixelBufferHeight());
+	_stream->writeByte(format.bytesPerPixel);
+	_stream->writeByte(format.rLoss);
+	_stream->writeByte(format.gLoss);
+	_stream->writeByte(format.bLoss);
+	_stream->writeByte(format.aLoss);
+	_stream->writeByte(format.rShift);
+	_stream->writeByte(format.gShift);
+	_stream->writeByte(format.bShift);
+	_stream->writeByte(format.aShift);
+	_stream->writeUint32LE(c->_textureSize);
+	_stream->writeByte(c->fb->hasStencilBuffer());
+	_stream->writeByte(c->_enableDirtyRectangles);
+}
+
+CaptureWriter::~CaptureWriter() {
+	_stream->finalize();
+	if (_stream->err()) {
+		warning("TinyGL: Failed to write the capture");
+	}
+	delete _stream;
+}
+
+void CaptureWriter::writeDrawCall(const DrawCall *drawCall) {
+	switch (drawCall->getType()) {
+	case DrawCall::DrawCall_Clear:
+		_stream->writeUint32BE(kRecordClear);
+		break;
+	case DrawCall::DrawCall_Rasterization:
+		writeTexture(((const RasterizationDrawCall *)drawCall)->getTexture());
+		_stream->writeUint32BE(kRecordRasterization);
+		break;
+	case DrawCall::DrawCall_Blitting: {
+		BlitImage *image = ((const BlittingDrawCall *)drawCall)->getImage();
+		writeBlitImage(image);
+		_stream->writeUint32BE(kRecordBlitting);
+		_stream->writeUint32LE(_blitImages[image].id);
+		break;
+	}
+	default:
+		return;
+	}
+
+	drawCall->save(*_stream);
+}
+
+bool CaptureWriter::endFrame() {
+	if (_skipFrames > 0) {
+		_skipFrames--;
+		if (_skipFrames == 0) {
+			debug(1, "TinyGL: Capturing %d frames", _frameCount);
+		}
+		return true;
+	}
+
+	_stream->writeUint32BE(kRecordFrameEnd);
+	return _frameCount == 0 || --_frameCount > 0;
+}
+
+void CaptureWriter::forgetTexture(uint handle) {
+	_textureVersions.erase(handle);
+}
+
+void CaptureWriter::forgetBlitImage(BlitImage *image) {
+	_blitImages.erase(image);
+}
+
+void CaptureWriter::writeTexture(GLTexture *texture) {
+	if (_textureVersions.contains(texture->handle) && _textureVersions[texture->handle] == texture->versionNumber) {
+		return;
+	}
+	_textureVersions[texture->handle] = texture->versionNumber;
+
+	// Only the first level is used, the others are generated again
+	const TexelBuffer *pixmap = texture->images[0].pixmap;
+	_stream->writeUint32BE(kRecordTexture);
+	_stream->writeUint32LE(texture->handle);
+	_stream->writeUint32LE(pixmap ? pixmap->getWidth() : 0);
+	_stream->writeUint32LE(pixmap ? pixmap->getHeight() : 0);
+	if (!pixmap) {
+		return;
+	}
+
+	_stream->writeByte(pixmap->isBilinear());
+	_stream->writeByte(pixmap->hasMipmaps());
+	for (uint y = 0; y < pixmap->getHeight(); y++) {
+		for (uint x = 0; x < pixmap->getWidth(); x++) {
+			uint8 a, r, g, b;
+			pixmap->getTexel(x, y, a, r, g, b);
+			_stream->writeByte(r);
+			_stream->writeByte(g);
+			_stream->writeByte(b);
+			_stream->writeByte(a);
+		}
+	}
+}
+
+void CaptureWriter::writeBlitImage(BlitImage *image) {
+	const int version = tglGetBlitImageVersion(image);
+	if (_blitImages.contains(image) && _blitImages[image].version == version) {
+		return;
+	}
+
+	if (!_blitImages.contains(image)) {
+		_blitImages[image].id = _nextBlitImageId++;
+	}
+	_blitImages[image].version = version;
+
+	// Color keys are already applied to the pixels
+	Graphics::Surface *pixels = Internal::tglGetBlitImageSurface(image).convertTo(getCapturePixelFormat());
+	_stream->writeUint32BE(kRecordBlitImage);
+	_stream->writeUint32LE(_blitImages[image].id);
+	_stream->writeUint32LE(pixels->w);
+	_stream->writeUint32LE(pixels->h);
+	for (int y = 0; y < pixels->h; y++) {
+		_stream->write(pixels->getBasePtr(0, y), pixels->w * 4);
+	}
+
+	pixels->free();
+	delete pixels;
+}
+
+} // end of namespace Internal
+
+CaptureReplay::CaptureReplay(Common::SeekableReadStream *stream) :
+		_stream(stream), _valid(false), _started(false), _width(0), _height(0), _textureSize(0),
+		_enableStencilBuffer(false), _enableDirtyRectangles(false), _framesStart(0) {
+	if (_stream->readUint32BE() != kCaptureTag || _stream->readUint32LE() != kCaptureVersion) {
+		return;
+	}
+
+	_width = _stream->readUint32LE();
+	_height = _stream->readUint32LE();
+	_pixelFormat.bytesPerPixel = _stream->readByte();
+	_pixelFormat.rLoss = _stream->readByte();
+	_pixelFormat.gLoss = _stream->readByte();
+	_pixelFormat.bLoss = _stream->readByte();
+	_pixelFormat.aLoss = _stream->readByte();
+	_pixelFormat.rShift = _stream->readByte();
+	_pixelFormat.gShift = _stream->readByte();
+	_pixelFormat.bShift = _stream->readByte();
+	_pixelFormat.aShift = _stream->readByte();
+	_textureSize = _stream->readUint32LE();
+	_enableStencilBuffer = _stream->readByte();
+	_enableDirtyRectangles = _stream->readByte();
+	_framesStart = _stream->pos();
+
+	_valid = !_stream->err() && !_stream->eos();
+}
+
+CaptureReplay::~CaptureReplay() {
+	stop();
+	delete _stream;
+}
+
+void CaptureReplay::start() {
+	assert(_valid && !_started);
+
+	createContext(_width, _height, _pixelFormat, _textureSize, _enableStencilBuffer, _enableDirtyRectangles);
+	_stream->seek(_framesStart);
+	_started = true;
+}
+
+bool CaptureReplay::drawFrame() {
+	GLContext *c = gl_get_context();
+
+	while (true) {
+		const uint32 tag = _stream->readUint32BE();
+		if (_stream->eos() || _stream->err()) {
+			return false;
+		}
+
+		switch (tag) {
+		case kRecordTexture:
+			loadTexture();
+			break;
+		case kRecordBlitImage:
+			loadBlitImage();
+			break;
+		case kRecordClear:
+			c->issueDrawCall(ClearBufferDrawCall::load(*_stream));
+			break;
+		case kRecordRasterization:
+			c->issueDrawCall(RasterizationDrawCall::load(*_stream));
+			break;
+		case kRecordBlitting: {
+			const uint32 id = _stream->readUint32LE();
+			if (!_blitImages.contains(id)) {
+				error("CaptureReplay: Unknown blit image %d", id);
+			}
+			c->issueDrawCall(BlittingDrawCall::load(*_stream, _blitImages[id]));
+			break;
+		}
+		case kRecordFrameEnd:
+			presentBuffer();
+			return true;
+		default:
+			error("CaptureReplay: Unknown record %s", tag2str(tag));
+		}
+	}
+}
+
+void CaptureReplay::stop() {
+	if (!_started) {
+		return;
+	}
+
+	for (Common::HashMap<uint32, BlitImage *>::iterator it = _blitImages.begin(); it != _blitImages.end(); ++it) {
+		tglDeleteBlitImage(it->_value);
+	}
+	_blitImages.clear();
+
+	destroyContext();
+	_started = false;
+}
+
+void CaptureReplay::loadTexture() {
+	GLContext *c = gl_get_context();
+
+	const uint handle = _stream->readUint32LE();
+	const uint width = _stream->readUint32LE();
+	const uint height = _stream->readUint32LE();
+
+	GLTexture *texture = c->find_texture(handle);
+	if (!texture) {
+		texture = c->alloc_texture(handle);
+	}
+	texture->versionNumber++;
+
+	GLImage *image = &texture->images[0];
+	image->xsize = c->_textureSize;
+	image->ysize = c->_textureSize;
+	delete image->pixmap;
+	image->pixmap = nullptr;
+	if (!width || !height) {
+		return;
+	}
+
+	const bool bilinear = _stream->readByte();
+	const bool mipmaps = _stream->readByte();
+	Graphics::PixelBuffer pixels(getCapturePixelFormat(), width * height, DisposeAfterUse::YES);
+	_stream->read(pixels.getRawBuffer(), width * height * 4);
+	image->pixmap = new TexelBuffer(pixels, width, height, c->_textureSize, bilinear, mipmaps);
+}
+
+void CaptureReplay::loadBlitImage() {
+	const uint32 id = _stream->readUint32LE();
+	const int width = _stream->readUint32LE();
+	const int height = _stream->readUint32LE();
+
+	Graphics::Surface pixels;
+	pixels.create(width, height, getCapturePixelFormat());
+	_stream->read(pixels.getPixels(), width * height * 4);
+
+	if (!_blitImages.contains(id)) {
+		_blitImages[id] = tglGenBlitImage();
+	}
+	tglUploadBlitImage(_blitImages[id], pixels, 0, false);
+	pixels.free();
+}
+
+} // end of namespace TinyGL
@@ -0,0 +1,173 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef GRAPHICS_TINYGL_CAPTURE_H
+#define GRAPHICS_TINYGL_CAPTURE_H
+
+#include "common/hashmap.h"
+#include "common/hash-ptr.h"
+
+#include "graphics/pixelformat.h"
+
+namespace Common {
+class SeekableReadStream;
+class WriteStream;
+}
+
+namespace TinyGL {
+
+struct BlitImage;
+struct GLContext;
+struct GLTexture;
+class DrawCall;
+
+/**
+ * Start recording the frames of the current context to a stream: their
+ * draw calls, and the textures and blit images these use. The frames can
+ * then be replayed with CaptureReplay, to profile the rendering of a game
+ * without the game.
+ *
+ * Recording starts with the next frame, after skipping the given number
+ * of frames, and stops after the given number of frames or when the
+ * context is destroyed. Setting "tinygl_capture" to the path of a file
+ * starts a capture when the context is created, "tinygl_capture_frames"
+ * and "tinygl_capture_skip" give the frame counts.
+ *
+ * @param stream      The stream to write to, deleted when the capture ends.
+ * @param frameCount  Number of frames to record, or 0 to record until
+ *                    endCapture() is called.
+ * @param skipFrames  Number of frames to skip first.
+ */
+void beginCapture(Common::WriteStream *stream, int frameCount, int skipFrames = 0);
+
+/**
+ * Stop recording and delete the stream.
+ */
+void endCapture();
+
+bool isCapturing();
+
+/**
+ * Replays captured frames, on a context like the one they were captured
+ * with.
+ */
+class CaptureReplay {
+public:
+	/**
+	 * Read the header of a capture. The replay takes ownership of the
+	 * stream.
+	 */
+	CaptureReplay(Common::SeekableReadStream *stream);
+	~CaptureReplay();
+
+	/**
+	 * Return whether the stream is a capture this version can replay.
+	 */
+	bool isValid() const { return _valid; }
+
+	int getWidth() const { return _width; }
+	int getHeight() const { return _height; }
+	const Graphics::PixelFormat &getPixelFormat() const { return _pixelFormat; }
+
+	/**
+	 * Create the context and rewind to the first frame. There must be no
+	 * current context.
+	 */
+	void start();
+
+	/**
+	 * Issue the draw calls of the next frame, and present it.
+	 *
+	 * @return  false when there are no frames left.
+	 */
+	bool drawFrame();
+
+	/**
+	 * Destroy the context.
+	 */
+	void stop();
+
+private:
+	void loadTexture();
+	void loadBlitImage();
+
+	Common::SeekableReadStream *_stream;
+	bool _valid;
+	bool _started;
+	int _width, _height;
+	Graphics::PixelFormat _pixelFormat;
+	int _textureSize;
+	bool _enableStencilBuffer, _enableDirtyRectangles;
+	int64 _framesStart;
+
+	Common::HashMap<uint32, BlitImage *> _blitImages;
+};
+
+namespace Internal {
+
+/**
+ * Writes the frames of a context, see beginCapture().
+ *
+ * Textures and blit images are written before the first draw call using
+ * them, and again when they change.
+ */
+class CaptureWriter {
+public:
+	CaptureWriter(GLContext *c, Common::WriteStream *stream, int frameCount, int skipFrames);
+	~CaptureWriter();
+
+	bool isRecording() const { return _skipFrames == 0; }
+
+	void writeDrawCall(const DrawCall *drawCall);
+
+	/**
+	 * Called after presenting each frame.
+	 *
+	 * @return  false once all the frames are recorded.
+	 */
+	bool endFrame();
+
+	// Handles and addresses are reused once textures and images are deleted
+	void forgetTexture(uint handle);
+	void forgetBlitImage(BlitImage *image);
+
+private:
+	void writeTexture(GLTexture *texture);
+	void writeBlitImage(BlitImage *image);
+
+	Common::WriteStream *_stream;
+	int _frameCount, _skipFrames;
+
+	struct BlitImageEntry {
+		uint32 id;
+		int version;
+	};
+
+	Common::HashMap<uint, int> _textureVersions;
+	Common::HashMap<BlitImage *, BlitImageEntry> _blitImages;
+	uint32 _nextBlitImageId;
+};
+
+} // end of namespace Internal
+
+} // end of namespace TinyGL
+
+#endif
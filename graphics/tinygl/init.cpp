@@ -29,6 +29,10 @@
 #include "graphics/tinygl/zblit.h"
 #include "graphics/tinygl/zdirtyrect.h"
 
+#include "common/config-manager.h"
+#include "common/file.h"
+#include "common/system.h"
+
 namespace TinyGL {
 
 GLContext *gl_ctx;
@@ -58,6 +62,18 @@ void createContext(int screenW, int screenH, Graphics::PixelFormat pixelFormat,
 	assert(gl_ctx == nullptr);
 	gl_ctx = new GLContext();
 	gl_ctx->init(screenW, screenH, pixelFormat, textureSize, enableStencilBuffer, dirtyRectsEnable);
+
+	if (ConfMan.hasKey("tinygl_capture") && !ConfMan.get("tinygl_capture").empty()) {
+		Common::DumpFile *file = new Common::DumpFile();
+		if (file->open(ConfMan.get("tinygl_capture"), true)) {
+			const int frameCount = ConfMan.hasKey("tinygl_capture_frames") ? ConfMan.getInt("tinygl_capture_frames") : 100;
+			const int skipFrames = ConfMan.hasKey("tinygl_capture_skip") ? ConfMan.getInt("tinygl_capture_skip") : 0;
+			beginCapture(file, frameCount, skipFrames);
+		} else {
+			warning("TinyGL: Could not open '%s' for the capture", ConfMan.get("tinygl_capture").c_str());
+			delete file;
+		}
+	}
 }
 
 void GLContext::init(int screenW, int screenH, Graphics::PixelFormat pixelFormat, int textureSize, bool enableStencilBuffer, bool dirtyRectsEnable) {
@@ -259,8 +275,12 @@ void GLContext::init(int screenW, int screenH, Graphics::PixelFormat pixelFormat
 	_drawCallAllocator[0].initialize(kDrawCallMemory);
 	_drawCallAllocator[1].initialize(kDrawCallMemory);
 	_debugRectsEnabled = false;
+	_capture = nullptr;
+
+	TinyGL::Internal::tglBlitResetScissorRect(this);
 
-	TinyGL::Internal::tglBlitResetScissorRect();
+	// Rasterize horizontal bands of the screen on several threads
+	initRenderTiles(MIN<int>(g_system->getCPUCount(), MAX_RENDER_TILES));
 }
 
 GLContext *gl_get_context() {
@@ -276,6 +296,9 @@ void destroyContext() {
 }
 
 void GLContext::deinit() {
+	delete _capture;
+	_capture = nullptr;
+	deinitRenderTiles();
 	disposeDrawCallLists();
 	disposeResources();
 
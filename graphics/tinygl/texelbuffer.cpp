@@ -26,199 +26,121 @@
 
 namespace TinyGL {
 
-#define ZB_POINT_ST_UNIT (1 << ZB_POINT_ST_FRAC_BITS)
-#define ZB_POINT_ST_FRAC_MASK (ZB_POINT_ST_UNIT - 1)
+static_assert(TexelBuffer::kFracBits == ZB_POINT_ST_FRAC_BITS, "Texture coordinate precision mismatch");
 
-TexelBuffer::TexelBuffer(uint width, uint height, uint textureSize) {
+TexelBuffer::TexelBuffer(const Graphics::PixelBuffer &buf, uint width, uint height, uint textureSize, bool bilinear, bool mipmaps) {
 	assert(width);
 	assert(height);
 	assert(textureSize);
 
 	_width = width;
 	_height = height;
-	_fracTextureUnit = textureSize << ZB_POINT_ST_FRAC_BITS;
+	_fracTextureUnit = textureSize << kFracBits;
 	_fracTextureMask = _fracTextureUnit - 1;
-	_widthRatio = (float) width / textureSize;
-	_heightRatio = (float) height / textureSize;
-}
+	_textureSizeShift = 0;
+	while ((1u << _textureSizeShift) < textureSize)
+		_textureSizeShift++;
+	_bilinear = bilinear;
+	_mipmaps = mipmaps;
+
+	// Decode the first level, then average each level into the next one
+	uint8 *argb = new uint8[width * height * 4];
+	for (uint i = 0; i < width * height; i++)
+		buf.getARGBAt(i, argb[i * 4 + 0], argb[i * 4 + 1], argb[i * 4 + 2], argb[i * 4 + 3]);
+
+	_levelCount = 0;
+	while (true) {
+		Level &level = _levels[_levelCount++];
+		level.width = width;
+		level.height = height;
+		storeLevel(level, argb);
+
+		if (!mipmaps || (width == 1 && height == 1) || _levelCount == kMaxLevels)
+			break;
+
+		const uint nextWidth = (width + 1) / 2;
+		const uint nextHeight = (height + 1) / 2;
+		uint8 *next = new uint8[nextWidth * nextHeight * 4];
+		for (uint y = 0; y < nextHeight; y++) {
+			const uint y0 = y * 2, y1 = MIN(y * 2 + 1, height - 1);
+			for (uint x = 0; x < nextWidth; x++) {
+				const uint x0 = x * 2, x1 = MIN(x * 2 + 1, width - 1);
+				for (uint c = 0; c < 4; c++) {
+					const uint sum = argb[(y0 * width + x0) * 4 + c] + argb[(y0 * width + x1) * 4 + c] +
+					                 argb[(y1 * width + x0) * 4 + c] + argb[(y1 * width + x1) * 4 + c];
+					next[(y * nextWidth + x) * 4 + c] = (sum + 2) >> 2;
+				}
+			}
+		}
 
-static inline uint wrap(uint wrap_mode, int coord, uint _fracTextureUnit, uint _fracTextureMask) {
-	switch (wrap_mode) {
-	case TGL_MIRRORED_REPEAT:
-		if (coord & _fracTextureUnit)
-			return _fracTextureMask - (coord & _fracTextureMask);
-		return coord & _fracTextureMask;
-	case TGL_CLAMP_TO_EDGE:
-		if (coord < 0)
-			return 0;
-		if ((uint) coord > _fracTextureMask)
-			return _fracTextureMask;
-		return coord;
-	default:
-		// Fall through
-	case TGL_REPEAT:
-		return coord & _fracTextureMask;
+		delete[] argb;
+		argb = next;
+		width = nextWidth;
+		height = nextHeight;
 	}
-}
 
-void TexelBuffer::getARGBAt(
-	uint wrap_s, uint wrap_t,
-	int s, int t,
-	uint8 &a, uint8 &r, uint8 &g, uint8 &b
-) const {
-	uint x, y;
-	x = wrap(wrap_s, s, _fracTextureUnit, _fracTextureMask) * _widthRatio;
-	y = wrap(wrap_t, t, _fracTextureUnit, _fracTextureMask) * _heightRatio;
-	getARGBAt(
-		(x >> ZB_POINT_ST_FRAC_BITS) + (y >> ZB_POINT_ST_FRAC_BITS) * _width,
-		x & ZB_POINT_ST_FRAC_MASK, y & ZB_POINT_ST_FRAC_MASK,
-		a, r, g, b
-	);
+	delete[] argb;
 }
 
-// Nearest: store texture in original size.
-NearestTexelBuffer::NearestTexelBuffer(const Graphics::PixelBuffer &buf, uint width, uint height, uint textureSize) : TexelBuffer(width, height, textureSize) {
-	uint pixel_count = _width * _height;
-	_buf = Graphics::PixelBuffer(buf.getFormat(), pixel_count, DisposeAfterUse::NO);
-	_buf.copyBuffer(0, pixel_count, buf);
+TexelBuffer::~TexelBuffer() {
+	for (uint i = 0; i < _levelCount; i++)
+		delete[] _levels[i].texels;
 }
 
-NearestTexelBuffer::~NearestTexelBuffer() {
-	_buf.free();
-}
+void TexelBuffer::getTexel(uint x, uint y, uint8 &a, uint8 &r, uint8 &g, uint8 &b) const {
+	const uint index = tiledIndex(_levels[0], x, y);
 
-void NearestTexelBuffer::getARGBAt(
-	uint pixel,
-	uint, uint,
-	uint8 &a, uint8 &r, uint8 &g, uint8 &b
-) const {
-	_buf.getARGBAt(pixel, a, r, g, b);
-}
-
-// Bilinear: each texture coordinates corresponds to the 4 original image
-// pixels linear interpolation has to work on, so that they are near each
-// other in CPU data cache, and a single actual memory fetch happens. This
-// allows applying linear filtering at render time at a very low performance
-// cost. As we expect to work on small-ish textures (512*512 ?) the 4x memory
-// usage increase should be negligible.
-#define A_OFFSET (0 * 4)
-#define R_OFFSET (1 * 4)
-#define G_OFFSET (2 * 4)
-#define B_OFFSET (3 * 4)
-#define P00_OFFSET 0
-#define P01_OFFSET 1
-#define P10_OFFSET 2
-#define P11_OFFSET 3
-#define PIXEL_PER_TEXEL_SHIFT 2
-
-BilinearTexelBuffer::BilinearTexelBuffer(const Graphics::PixelBuffer &buf, uint width, uint height, uint textureSize) : TexelBuffer(width, height, textureSize) {
-	uint pixel00_offset = 0, pixel11_offset, pixel01_offset, pixel10_offset;
-	uint8 *texel8;
-	uint32 *texel32;
-
-	texel32 = _texels = new uint32[_width * _height << PIXEL_PER_TEXEL_SHIFT];
-	for (uint y = 0; y < _height; y++) {
-		for (uint x = 0; x < _width; x++) {
-			texel8 = (uint8 *)texel32;
-			pixel11_offset = pixel00_offset + _width + 1;
-			buf.getARGBAt(
-				pixel00_offset,
-				*(texel8 + P00_OFFSET + A_OFFSET),
-				*(texel8 + P00_OFFSET + R_OFFSET),
-				*(texel8 + P00_OFFSET + G_OFFSET),
-				*(texel8 + P00_OFFSET + B_OFFSET)
-			);
-			if ((x + 1) == _width) {
-				pixel11_offset -= 1;
-				pixel01_offset = pixel00_offset;
-			} else
-				pixel01_offset = pixel00_offset + 1;
-			buf.getARGBAt(
-				pixel01_offset,
-				*(texel8 + P01_OFFSET + A_OFFSET),
-				*(texel8 + P01_OFFSET + R_OFFSET),
-				*(texel8 + P01_OFFSET + G_OFFSET),
-				*(texel8 + P01_OFFSET + B_OFFSET)
-			);
-			if ((y + 1) == _height) {
-				pixel11_offset -= _width;
-				pixel10_offset = pixel00_offset;
-			} else
-				pixel10_offset = pixel00_offset + _width;
-			buf.getARGBAt(
-				pixel10_offset,
-				*(texel8 + P10_OFFSET + A_OFFSET),
-				*(texel8 + P10_OFFSET + R_OFFSET),
-				*(texel8 + P10_OFFSET + G_OFFSET),
-				*(texel8 + P10_OFFSET + B_OFFSET)
-			);
-			buf.getARGBAt(
-				pixel11_offset,
-				*(texel8 + P11_OFFSET + A_OFFSET),
-				*(texel8 + P11_OFFSET + R_OFFSET),
-				*(texel8 + P11_OFFSET + G_OFFSET),
-				*(texel8 + P11_OFFSET + B_OFFSET)
-			);
-			texel32 += 1 << PIXEL_PER_TEXEL_SHIFT;
-			pixel00_offset++;
-		}
+	// The first pixel of a bilinear texel is the texel itself
+	if (_bilinear) {
+		const uint8 *texel = (const uint8 *)(_levels[0].texels + (index << 2));
+		a = texel[0];
+		r = texel[4];
+		g = texel[8];
+		b = texel[12];
+	} else {
+		const uint8 *texel = (const uint8 *)(_levels[0].texels + index);
+		a = texel[0];
+		r = texel[1];
+		g = texel[2];
+		b = texel[3];
 	}
 }
 
-BilinearTexelBuffer::~BilinearTexelBuffer() {
-	delete[] _texels;
-}
-
-static inline int interpolate(int v00, int v01, int v10, int xf, int yf) {
-	return v00 + (((v01 - v00) * xf + (v10 - v00) * yf) >> ZB_POINT_ST_FRAC_BITS);
-}
-
-void BilinearTexelBuffer::getARGBAt(
-	uint pixel,
-	uint ds, uint dt,
-	uint8 &a, uint8 &r, uint8 &g, uint8 &b
-) const {
-	uint p00_offset, p01_offset, p10_offset;
-	uint8 *texel = (uint8 *)(_texels + (pixel << PIXEL_PER_TEXEL_SHIFT));
-	if ((ds + dt) > ZB_POINT_ST_UNIT) {
-		p00_offset = P11_OFFSET;
-		p10_offset = P01_OFFSET;
-		p01_offset = P10_OFFSET;
-		ds = ZB_POINT_ST_UNIT - ds;
-		dt = ZB_POINT_ST_UNIT - dt;
-	} else {
-		p00_offset = P00_OFFSET;
-		p10_offset = P10_OFFSET;
-		p01_offset = P01_OFFSET;
+// Bilinear: each texel holds the 4 pixels linear interpolation has to work
+// on, channel by channel, so that they are near each other in CPU data
+// cache, and a single actual memory fetch happens. This allows applying
+// linear filtering at render time at a very low performance cost. As we
+// expect to work on small-ish textures (512*512 ?) the 4x memory usage
+// increase should be negligible.
+void TexelBuffer::storeLevel(Level &level, const uint8 *argb) {
+	const uint tilesPerColumn = (level.height + 3) >> 2;
+	level.tilesPerRow = (level.width + 3) >> 2;
+
+	const uint texelSize = _bilinear ? 4 : 1;
+	level.texels = new uint32[level.tilesPerRow * tilesPerColumn * 16 * texelSize]();
+
+	for (uint y = 0; y < level.height; y++) {
+		for (uint x = 0; x < level.width; x++) {
+			uint8 *texel = (uint8 *)(level.texels + tiledIndex(level, x, y) * texelSize);
+			const uint8 *p00 = argb + (y * level.width + x) * 4;
+
+			if (!_bilinear) {
+				memcpy(texel, p00, 4);
+				continue;
+			}
+
+			// The neighbours are clamped to the edges
+			const uint8 *p01 = x + 1 < level.width ? p00 + 4 : p00;
+			const uint8 *p10 = y + 1 < level.height ? p00 + level.width * 4 : p00;
+			const uint8 *p11 = x + 1 < level.width ? p10 + 4 : p10;
+			for (uint c = 0; c < 4; c++) {
+				texel[c * 4 + 0] = p00[c];
+				texel[c * 4 + 1] = p01[c];
+				texel[c * 4 + 2] = p10[c];
+				texel[c * 4 + 3] = p11[c];
+			}
+		}
 	}
-	a = interpolate(
-		*(texel + p00_offset + A_OFFSET),
-		*(texel + p01_offset + A_OFFSET),
-		*(texel + p10_offset + A_OFFSET),
-		ds,
-		dt
-	);
-	r = interpolate(
-		*(texel + p00_offset + R_OFFSET),
-		*(texel + p01_offset + R_OFFSET),
-		*(texel + p10_offset + R_OFFSET),
-		ds,
-		dt
-	);
-	g = interpolate(
-		*(texel + p00_offset + G_OFFSET),
-		*(texel + p01_offset + G_OFFSET),
-		*(texel + p10_offset + G_OFFSET),
-		ds,
-		dt
-	);
-	b = interpolate(
-		*(texel + p00_offset + B_OFFSET),
-		*(texel + p01_offset + B_OFFSET),
-		*(texel + p10_offset + B_OFFSET),
-		ds,
-		dt
-	);
 }
 
 } // end of namespace TinyGL
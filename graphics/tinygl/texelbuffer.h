@@ -22,63 +22,191 @@
 #ifndef GRAPHICS_TEXELBUFFER_H
 #define GRAPHICS_TEXELBUFFER_H
 
+#include "common/util.h"
+
 #include "graphics/tinygl/pixelbuffer.h"
+#include "graphics/tinygl/gl.h"
 
 namespace TinyGL {
 
+/**
+ * A texture, stored for sampling.
+ *
+ * The texels are stored in tiles of 4x4, so that texels which are near
+ * each other on screen are near each other in memory as well, whatever
+ * the orientation of the texture. Textures using a mipmapped minification
+ * filter also store the smaller levels, generated by averaging, so that
+ * minified textures read a fraction of the texels. Only such textures get
+ * levels: NEAREST and LINEAR keep sampling the first level, as they would
+ * with OpenGL.
+ *
+ * Nearest texels are stored as ARGB in 4 bytes, even for RGB textures
+ * which used to take 3. The sampler then reads a texel with one aligned
+ * load, instead of converting it from the pixel format on every fetch.
+ * Bilinear texels take 16 bytes, as they did before, for the four pixels
+ * they interpolate.
+ *
+ * The sampler is not virtual: the filter is chosen when the texture is
+ * created, and tested for each texel with a branch which is always taken
+ * the same way while drawing a triangle.
+ */
 class TexelBuffer {
 public:
-	TexelBuffer(uint width, uint height, uint textureSize);
-	virtual ~TexelBuffer() {};
+	// Fractional bits of the texture coordinates, ZB_POINT_ST_FRAC_BITS
+	enum {
+		kFracBits = 14,
+		kFracUnit = 1 << kFracBits,
+		kFracMask = kFracUnit - 1
+	};
+
+	TexelBuffer(const Graphics::PixelBuffer &buf, uint width, uint height, uint textureSize, bool bilinear, bool mipmaps);
+	~TexelBuffer();
 
-	void getARGBAt(
+	FORCEINLINE void getARGBAt(
 		uint wrap_s, uint wrap_t,
 		int s, int t,
 		uint8 &a, uint8 &r, uint8 &g, uint8 &b
-	) const;
+	) const {
+		getARGBAt(wrap_s, wrap_t, s, t, 0, a, r, g, b);
+	}
 
-protected:
-	virtual void getARGBAt(
-		uint pixel,
-		uint ds, uint dt,
+	/**
+	 * Sample the texture at the given level, which must be lower than
+	 * getLevelCount().
+	 */
+	FORCEINLINE void getARGBAt(
+		uint wrap_s, uint wrap_t,
+		int s, int t, uint level,
 		uint8 &a, uint8 &r, uint8 &g, uint8 &b
-	) const = 0;
-	uint _width, _height, _fracTextureUnit, _fracTextureMask;
-	float _widthRatio, _heightRatio;
-};
+	) const;
 
-class NearestTexelBuffer : public TexelBuffer {
-public:
-	NearestTexelBuffer(const Graphics::PixelBuffer &buf, uint width, uint height, uint textureSize);
-	~NearestTexelBuffer();
+	/**
+	 * Return the level to sample for the given change of the texture
+	 * coordinates from one pixel to the next.
+	 */
+	FORCEINLINE uint getLevel(int dsdx, int dtdx) const;
 
-protected:
-	void getARGBAt(
-		uint pixel,
-		uint, uint,
-		uint8 &a, uint8 &r, uint8 &g, uint8 &b
-	) const override;
+	uint getLevelCount() const { return _levelCount; }
+
+	uint getWidth() const { return _width; }
+	uint getHeight() const { return _height; }
+	bool isBilinear() const { return _bilinear; }
+	bool hasMipmaps() const { return _mipmaps; }
+
+	/**
+	 * Return a texel of the first level, unfiltered.
+	 */
+	void getTexel(uint x, uint y, uint8 &a, uint8 &r, uint8 &g, uint8 &b) const;
 
 private:
-	Graphics::PixelBuffer _buf;
-};
+	static const uint kMaxLevels = 16;
 
-class BilinearTexelBuffer : public TexelBuffer {
-public:
-	BilinearTexelBuffer(const Graphics::PixelBuffer &buf, uint width, uint height, uint textureSize);
-	~BilinearTexelBuffer();
+	struct Level {
+		uint width, height;
+		uint tilesPerRow;
+		uint32 *texels;
+	};
 
-protected:
-	void getARGBAt(
-		uint pixel,
-		uint ds, uint dt,
-		uint8 &a, uint8 &r, uint8 &g, uint8 &b
-	) const override;
+	static uint wrap(uint wrap_mode, int coord, uint fracTextureUnit, uint fracTextureMask);
 
-private:
-	uint32 *_texels;
+	// Index of the texel in the tiled storage of a level
+	static FORCEINLINE uint tiledIndex(const Level &level, uint x, uint y) {
+		return (((y >> 2) * level.tilesPerRow + (x >> 2)) << 4) | ((y & 3) << 2) | (x & 3);
+	}
+
+	void storeLevel(Level &level, const uint8 *argb);
+
+	uint _width, _height, _fracTextureUnit, _fracTextureMask, _textureSizeShift;
+	bool _bilinear, _mipmaps;
+	uint _levelCount;
+	Level _levels[kMaxLevels];
 };
 
+FORCEINLINE uint TexelBuffer::wrap(uint wrap_mode, int coord, uint fracTextureUnit, uint fracTextureMask) {
+	switch (wrap_mode) {
+	case TGL_MIRRORED_REPEAT:
+		if (coord & fracTextureUnit)
+			return fracTextureMask - (coord & fracTextureMask);
+		return coord & fracTextureMask;
+	case TGL_CLAMP_TO_EDGE:
+		if (coord < 0)
+			return 0;
+		if ((uint) coord > fracTextureMask)
+			return fracTextureMask;
+		return coord;
+	default:
+		// Fall through
+	case TGL_REPEAT:
+		return coord & fracTextureMask;
+	}
+}
+
+static FORCEINLINE int interpolateTexel(int v00, int v01, int v10, int xf, int yf) {
+	return v00 + (((v01 - v00) * xf + (v10 - v00) * yf) >> TexelBuffer::kFracBits);
+}
+
+FORCEINLINE void TexelBuffer::getARGBAt(
+	uint wrap_s, uint wrap_t,
+	int s, int t, uint level,
+	uint8 &a, uint8 &r, uint8 &g, uint8 &b
+) const {
+	// Scale the coordinates from the texture size of the context to the
+	// size of the texture, and then to the level
+	const uint x = (uint)(((uint64)wrap(wrap_s, s, _fracTextureUnit, _fracTextureMask) * _width) >> _textureSizeShift) >> level;
+	const uint y = (uint)(((uint64)wrap(wrap_t, t, _fracTextureUnit, _fracTextureMask) * _height) >> _textureSizeShift) >> level;
+	const Level &l = _levels[level];
+	const uint index = tiledIndex(l, MIN(x >> kFracBits, l.width - 1), MIN(y >> kFracBits, l.height - 1));
+
+	if (!_bilinear) {
+		const uint8 *texel = (const uint8 *)(l.texels + index);
+		a = texel[0];
+		r = texel[1];
+		g = texel[2];
+		b = texel[3];
+		return;
+	}
+
+	// Each bilinear texel holds the four pixels to interpolate, channel by
+	// channel, so that a single memory fetch happens
+	const uint8 *texel = (const uint8 *)(l.texels + (index << 2));
+	uint ds = x & kFracMask;
+	uint dt = y & kFracMask;
+	uint p00, p01, p10;
+	if ((ds + dt) > kFracUnit) {
+		p00 = 3;
+		p10 = 1;
+		p01 = 2;
+		ds = kFracUnit - ds;
+		dt = kFracUnit - dt;
+	} else {
+		p00 = 0;
+		p10 = 2;
+		p01 = 1;
+	}
+	a = interpolateTexel(texel[p00], texel[p01], texel[p10], ds, dt);
+	r = interpolateTexel(texel[4 + p00], texel[4 + p01], texel[4 + p10], ds, dt);
+	g = interpolateTexel(texel[8 + p00], texel[8 + p01], texel[8 + p10], ds, dt);
+	b = interpolateTexel(texel[12 + p00], texel[12 + p01], texel[12 + p10], ds, dt);
+}
+
+FORCEINLINE uint TexelBuffer::getLevel(int dsdx, int dtdx) const {
+	if (_levelCount == 1) {
+		return 0;
+	}
+
+	// The larger of the steps in texels of the first level, as an integer
+	const uint64 stepS = ((uint64)ABS(dsdx) * _width) >> _textureSizeShift;
+	const uint64 stepT = ((uint64)ABS(dtdx) * _height) >> _textureSizeShift;
+	uint step = (uint)(MAX(stepS, stepT) >> kFracBits);
+
+	uint level = 0;
+	while (step > 1 && level < _levelCount - 1) {
+		step >>= 1;
+		level++;
+	}
+	return level;
+}
+
 } // end of namespace TinyGL
 
 #endif
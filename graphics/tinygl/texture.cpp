@@ -55,6 +55,10 @@ void GLContext::free_texture(GLTexture *t) {
 
 	assert(t);
 
+	if (_capture) {
+		_capture->forgetTexture(t->handle);
+	}
+
 	if (!t->prev) {
 		ht = &shared_state.texture_hash_table[t->handle % TEXTURE_HASH_TABLE_SIZE];
 		*ht = t->next;
@@ -174,24 +178,16 @@ void GLContext::glopTexImage2D(GLParam *p) {
 			filter = texture_mag_filter;
 		else
 			filter = texture_min_filter;
-		switch (filter) {
-		case TGL_LINEAR_MIPMAP_NEAREST:
-		case TGL_LINEAR_MIPMAP_LINEAR:
-		case TGL_LINEAR:
-			im->pixmap = new BilinearTexelBuffer(
-				srcInternal,
-				width, height,
-				_textureSize
-			);
-			break;
-		default:
-			im->pixmap = new NearestTexelBuffer(
-				srcInternal,
-				width, height,
-				_textureSize
-			);
-			break;
-		}
+		// Levels are generated rather than uploaded, and the nearest one
+		// is sampled for the MIPMAP_LINEAR filters too
+		const bool mipmaps = texture_min_filter != TGL_NEAREST && texture_min_filter != TGL_LINEAR;
+		const bool bilinear = filter == TGL_LINEAR || filter == TGL_LINEAR_MIPMAP_NEAREST || filter == TGL_LINEAR_MIPMAP_LINEAR;
+		im->pixmap = new TexelBuffer(
+			srcInternal,
+			width, height,
+			_textureSize,
+			bilinear, mipmaps
+		);
 	}
 }
 
@@ -90,6 +90,9 @@ FrameBuffer::FrameBuffer(int width, int height, const Graphics::PixelFormat &for
 	_zbuf = (uint *)gl_zalloc(_pbufWidth * _pbufHeight * sizeof(uint));
 	if (enableStencilBuffer)
 		_sbuf = (byte *)gl_zalloc(_pbufWidth * _pbufHeight * sizeof(byte));
+	else
+		_sbuf = nullptr;
+	_ownsBuffers = true;
 
 	_offscreenBuffer.pbuf = _pbuf.getRawBuffer();
 	_offscreenBuffer.zbuf = _zbuf;
@@ -99,7 +102,15 @@ FrameBuffer::FrameBuffer(int width, int height, const Graphics::PixelFormat &for
 	_enableScissor = false;
 }
 
+FrameBuffer::FrameBuffer(const FrameBuffer &other) {
+	*this = other;
+	_ownsBuffers = false;
+}
+
 FrameBuffer::~FrameBuffer() {
+	if (!_ownsBuffers)
+		return;
+
 	_pbuf.free();
 	gl_free(_zbuf);
 	if (_sbuf)
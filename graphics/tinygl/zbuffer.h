@@ -102,6 +102,12 @@ struct ZBufferPoint {
 
 struct FrameBuffer {
 	FrameBuffer(int width, int height, const Graphics::PixelFormat &format, bool enableStencilBuffer);
+
+	/**
+	 * Create a frame buffer drawing into the buffers of another one, with
+	 * its own state. The other frame buffer must outlive this one.
+	 */
+	FrameBuffer(const FrameBuffer &other);
 	~FrameBuffer();
 
 	Graphics::PixelFormat getPixelFormat() {
@@ -124,6 +130,10 @@ struct FrameBuffer {
 		return _zbuf;
 	}
 
+	bool hasStencilBuffer() const {
+		return _sbuf != nullptr;
+	}
+
 	Graphics::Surface *copyToBuffer(const Graphics::PixelFormat &dstFormat) {
 		Graphics::Surface tmp;
 		tmp.init(_pbufWidth, _pbufHeight, _pbufPitch, _pbuf.getRawBuffer(), _pbufFormat);
@@ -136,6 +146,9 @@ struct FrameBuffer {
 
 private:
 
+	// Only used to create views of other frame buffers
+	FrameBuffer &operator=(const FrameBuffer &other) = default;
+
 	FORCEINLINE bool compareDepth(uint &zSrc, uint &zDst) {
 		if (!_depthTestEnabled)
 			return true;
@@ -311,7 +324,7 @@ private:
 
 	template <bool kDepthWrite, bool kLightsMode, bool kSmoothMode, bool kEnableAlphaTest, bool kEnableScissor, bool kEnableBlending, bool kStencilEnabled, bool kDepthTestEnabled>
 	FORCEINLINE void putPixelTexture(int fbOffset, const TexelBuffer *texture,
-	                                 uint wrap_s, uint wrap_t, uint *pz, byte *ps, int _a,
+	                                 uint wrap_s, uint wrap_t, uint level, uint *pz, byte *ps, int _a,
 	                                 int x, int y, uint &z, int &t, int &s,
 	                                 uint &r, uint &g, uint &b, uint &a,
 	                                 int &dzdx, int &dsdx, int &dtdx, int &drdx, int &dgdx, int &dbdx, uint dadx);
@@ -319,6 +332,15 @@ private:
 	template <bool kDepthWrite, bool kEnableScissor, bool kStencilEnabled, bool kDepthTestEnabled>
 	FORCEINLINE void putPixelDepth(uint *pz, byte *ps, int _a, int x, int y, uint &z, int &dzdx);
 
+	// Draw the leading groups of four fragments of an opaque untextured
+	// span with SSE2 or NEON, and return the number of fragments drawn
+	template <bool kInterpRGB, bool kSmoothMode, bool kDepthWrite, bool kDepthTestEnabled>
+	int fillSpanVector(int pixel, uint *pz, int count, uint &z, uint &r, uint &g, uint &b, uint &a,
+	                   int dzdx, int drdx, int dgdx, int dbdx, int dadx);
+
+	// Return whether none of eight fragments passes the depth test
+	bool isBlockHidden(const uint *pz, uint z, int dzdx);
+
 
 	template <bool kEnableAlphaTest>
 	FORCEINLINE void writePixel(int pixel, int value) {
@@ -651,6 +673,7 @@ private:
 
 	uint *_zbuf;
 	byte *_sbuf;
+	bool _ownsBuffers;
 
 	bool _enableStencil;
 	int _textureSize;
@@ -25,12 +25,17 @@
 
 #include "common/debug.h"
 #include "common/math.h"
+#include "common/serializer.h"
+#include "common/system.h"
+#include "common/threadpool.h"
 
 namespace TinyGL {
 
 void GLContext::issueDrawCall(DrawCall *drawCall) {
 	if (_enableDirtyRectangles && drawCall->getDirtyRegion().isEmpty())
 		return;
+	if (_capture && _capture->isRecording())
+		_capture->writeDrawCall(drawCall);
 	_drawCallsQueue.push_back(drawCall);
 }
 
@@ -193,12 +198,20 @@ void GLContext::presentBufferDirtyRects(Common::List<Common::Rect> &dirtyAreas)
 		}
 
 		// Execute draw calls.
-		for (DrawCallIterator it = _drawCallsQueue.begin(); it != _drawCallsQueue.end(); ++it) {
-			Common::Rect drawCallRegion = (*it)->getDirtyRegion();
+		if (useRenderTiles()) {
+			Common::Array<Common::Rect> regions;
 			for (RectangleIterator itRect = rectangles.begin(); itRect != rectangles.end(); ++itRect) {
-				Common::Rect dirtyRegion = (*itRect).rectangle;
-				if (dirtyRegion.intersects(drawCallRegion)) {
-					(*it)->execute(dirtyRegion, true);
+				regions.push_back((*itRect).rectangle);
+			}
+			executeDrawCallsTiled(regions);
+		} else {
+			for (DrawCallIterator it = _drawCallsQueue.begin(); it != _drawCallsQueue.end(); ++it) {
+				Common::Rect drawCallRegion = (*it)->getDirtyRegion();
+				for (RectangleIterator itRect = rectangles.begin(); itRect != rectangles.end(); ++itRect) {
+					Common::Rect dirtyRegion = (*itRect).rectangle;
+					if (dirtyRegion.intersects(drawCallRegion)) {
+						(*it)->execute(this, dirtyRegion, true);
+					}
 				}
 			}
 		}
@@ -240,8 +253,17 @@ void GLContext::presentBufferSimple(Common::List<Common::Rect> &dirtyAreas) {
 
 	dirtyAreas.push_back(Common::Rect(fb->getPixelBufferWidth(), fb->getPixelBufferHeight()));
 
+	if (useRenderTiles()) {
+		Common::Array<Common::Rect> regions;
+		regions.push_back(renderRect);
+		executeDrawCallsTiled(regions);
+	} else {
+		for (DrawCallIterator it = _drawCallsQueue.begin(); it != _drawCallsQueue.end(); ++it) {
+			(*it)->execute(this, true);
+		}
+	}
+
 	for (DrawCallIterator it = _drawCallsQueue.begin(); it != _drawCallsQueue.end(); ++it) {
-		(*it)->execute(true);
 		delete *it;
 	}
 
@@ -252,6 +274,111 @@ void GLContext::presentBufferSimple(Common::List<Common::Rect> &dirtyAreas) {
 	_drawCallAllocator[_currentAllocatorIndex].reset();
 }
 
+void GLContext::initRenderTiles(int count) {
+	const int width = fb->getPixelBufferWidth();
+	const int height = fb->getPixelBufferHeight();
+
+	_renderTilePool = nullptr;
+
+	count = MIN(count, height);
+	if (count <= 1) {
+		return;
+	}
+
+	_renderTilePool = new Common::ThreadPool();
+
+	for (int i = 0; i < count; i++) {
+		RenderTile *tile = new RenderTile();
+		tile->rect = Common::Rect(0, height * i / count, width, height * (i + 1) / count);
+
+		GLContext *context = new GLContext();
+		context->fb = new FrameBuffer(*fb);
+		context->renderRect = renderRect;
+		context->vertex_max = POLYGON_MAX_VERTEX;
+		context->vertex = (GLVertex *)gl_malloc(POLYGON_MAX_VERTEX * sizeof(GLVertex));
+		context->render_mode = TGL_RENDER;
+		tile->context = context;
+
+		_renderTiles.push_back(tile);
+	}
+}
+
+void GLContext::deinitRenderTiles() {
+	for (uint i = 0; i < _renderTiles.size(); i++) {
+		GLContext *context = _renderTiles[i]->context;
+		delete context->fb;
+		gl_free(context->vertex);
+		delete context;
+		delete _renderTiles[i];
+	}
+	_renderTiles.clear();
+
+	delete _renderTilePool;
+	_renderTilePool = nullptr;
+}
+
+void GLContext::executeDrawCallsTiled(const Common::Array<Common::Rect> &regions) {
+	typedef Common::List<DrawCall *>::const_iterator DrawCallIterator;
+
+	void *params[MAX_RENDER_TILES];
+	uint paramCount = 0;
+
+	// Bin the draw calls by the bands their dirty region touches. Every
+	// band only writes its own rows, so the bands can be drawn at once,
+	// each with the draw calls in their original order.
+	for (uint i = 0; i < _renderTiles.size(); i++) {
+		RenderTile *tile = _renderTiles[i];
+		tile->regions.clear();
+		tile->drawCalls.clear();
+
+		for (uint r = 0; r < regions.size(); r++) {
+			Common::Rect region = regions[r].findIntersectingRect(tile->rect);
+			if (!region.isEmpty()) {
+				tile->regions.push_back(region);
+			}
+		}
+		if (tile->regions.empty()) {
+			continue;
+		}
+
+		for (DrawCallIterator it = _drawCallsQueue.begin(); it != _drawCallsQueue.end(); ++it) {
+			Common::Rect drawCallRegion = (*it)->getDirtyRegion();
+			for (uint r = 0; r < tile->regions.size(); r++) {
+				if (tile->regions[r].intersects(drawCallRegion)) {
+					tile->drawCalls.push_back(*it);
+					break;
+				}
+			}
+		}
+		if (tile->drawCalls.empty()) {
+			continue;
+		}
+
+		// The state which is not part of the draw calls
+		tile->context->current_cull_face = current_cull_face;
+		tile->context->renderRect = renderRect;
+		tile->context->vertex_n = vertex_n;
+
+		params[paramCount++] = tile;
+	}
+
+	_renderTilePool->run(&executeRenderTile, params, paramCount);
+}
+
+void GLContext::executeRenderTile(void *param) {
+	RenderTile *tile = (RenderTile *)param;
+
+	for (uint i = 0; i < tile->drawCalls.size(); i++) {
+		DrawCall *call = tile->drawCalls[i];
+		Common::Rect drawCallRegion = call->getDirtyRegion();
+		for (uint r = 0; r < tile->regions.size(); r++) {
+			if (tile->regions[r].intersects(drawCallRegion)) {
+				call->execute(tile->context, tile->regions[r], false);
+			}
+		}
+	}
+}
+
 void presentBuffer(Common::List<Common::Rect> &dirtyAreas) {
 	GLContext *c = gl_get_context();
 	if (c->_enableDirtyRectangles) {
@@ -259,6 +386,10 @@ void presentBuffer(Common::List<Common::Rect> &dirtyAreas) {
 	} else {
 		c->presentBufferSimple(dirtyAreas);
 	}
+
+	if (c->_capture && !c->_capture->endFrame()) {
+		endCapture();
+	}
 }
 
 void presentBuffer() {
@@ -294,8 +425,8 @@ RasterizationDrawCall::RasterizationDrawCall() : DrawCall(DrawCall_Rasterization
 	_drawTriangleFront = c->draw_triangle_front;
 	_drawTriangleBack = c->draw_triangle_back;
 	memcpy(_vertex, c->vertex, sizeof(GLVertex) * _vertexCount);
-	_state = captureState();
-	if (c->_enableDirtyRectangles) {
+	_state = captureState(c);
+	if (c->needsDirtyRegions()) {
 		computeDirtyRegion();
 	}
 }
@@ -333,19 +464,25 @@ void RasterizationDrawCall::computeDirtyRegion() {
 	}
 }
 
-void RasterizationDrawCall::execute(bool restoreState) const {
-	GLContext *c = gl_get_context();
-
+void RasterizationDrawCall::execute(GLContext *c, bool restoreState) const {
 	RasterizationDrawCall::RasterizationState backupState;
 	if (restoreState) {
-		backupState = captureState();
+		backupState = captureState(c);
 	}
-	applyState(_state);
+	applyState(c, _state);
+
+	// Drawing modifies the vertices, and the call may be executed several
+	// times, possibly on several threads at once, so draw a copy
+	if (c->vertex_max < _vertexCount) {
+		gl_free(c->vertex);
+		c->vertex_max = _vertexCount;
+		c->vertex = (GLVertex *)gl_malloc(sizeof(GLVertex) * c->vertex_max);
+	}
+	memcpy(c->vertex, _vertex, sizeof(GLVertex) * _vertexCount);
 
 	GLVertex *prevVertex = c->vertex;
 	int prevVertexCount = c->vertex_cnt;
 
-	c->vertex = _vertex;
 	c->vertex_cnt = _vertexCount;
 	c->draw_triangle_front = (gl_draw_triangle_func)_drawTriangleFront;
 	c->draw_triangle_back = (gl_draw_triangle_func)_drawTriangleBack;
@@ -429,13 +566,12 @@ void RasterizationDrawCall::execute(bool restoreState) const {
 	c->vertex_cnt = prevVertexCount;
 
 	if (restoreState) {
-		applyState(backupState);
+		applyState(c, backupState);
 	}
 }
 
-RasterizationDrawCall::RasterizationState RasterizationDrawCall::captureState() const {
+RasterizationDrawCall::RasterizationState RasterizationDrawCall::captureState(GLContext *c) {
 	RasterizationState state;
-	GLContext *c = gl_get_context();
 	state.enableBlending = c->blending_enabled;
 	state.sfactor = c->source_blending_factor;
 	state.dfactor = c->destination_blending_factor;
@@ -480,8 +616,7 @@ RasterizationDrawCall::RasterizationState RasterizationDrawCall::captureState()
 	return state;
 }
 
-void RasterizationDrawCall::applyState(const RasterizationDrawCall::RasterizationState &state) const {
-	GLContext *c = gl_get_context();
+void RasterizationDrawCall::applyState(GLContext *c, const RasterizationDrawCall::RasterizationState &state) {
 	c->fb->enableBlending(state.enableBlending);
 	c->fb->setBlendingFactors(state.sfactor, state.dfactor);
 	c->fb->enableAlphaTest(state.alphaTestEnabled);
@@ -538,13 +673,105 @@ void RasterizationDrawCall::applyState(const RasterizationDrawCall::Rasterizatio
 	memcpy(c->viewport.trans._v, state.viewportTranslation, sizeof(c->viewport.trans._v));
 }
 
-void RasterizationDrawCall::execute(const Common::Rect &clippingRectangle, bool restoreState) const {
-	TinyGL::GLContext *c = gl_get_context();
+void RasterizationDrawCall::execute(GLContext *c, const Common::Rect &clippingRectangle, bool restoreState) const {
 	c->fb->setScissorRectangle(clippingRectangle);
-	execute(restoreState);
+	execute(c, restoreState);
 	c->fb->resetScissorRectangle();
 }
 
+static const gl_draw_triangle_func drawTriangleFuncs[] = {
+	GLContext::gl_draw_triangle_point,
+	GLContext::gl_draw_triangle_line,
+	GLContext::gl_draw_triangle_fill,
+	GLContext::gl_draw_triangle_select
+};
+
+static void syncVector(Common::Serializer &s, float *v, int size) {
+	for (int i = 0; i < size; i++) {
+		s.syncAsFloatLE(v[i]);
+	}
+}
+
+static void syncVertex(Common::Serializer &s, GLVertex &v) {
+	s.syncAsSint32LE(v.edge_flag);
+	syncVector(s, v.normal._v, 3);
+	syncVector(s, v.coord._v, 4);
+	syncVector(s, v.tex_coord._v, 4);
+	syncVector(s, v.color._v, 4);
+	syncVector(s, v.ec._v, 4);
+	syncVector(s, v.pc._v, 4);
+	s.syncAsSint32LE(v.clip_code);
+	s.syncAsSint32LE(v.zp.x);
+	s.syncAsSint32LE(v.zp.y);
+	s.syncAsSint32LE(v.zp.z);
+	s.syncAsSint32LE(v.zp.s);
+	s.syncAsSint32LE(v.zp.t);
+	s.syncAsSint32LE(v.zp.r);
+	s.syncAsSint32LE(v.zp.g);
+	s.syncAsSint32LE(v.zp.b);
+	s.syncAsSint32LE(v.zp.a);
+	s.syncAsFloatLE(v.zp.sz);
+	s.syncAsFloatLE(v.zp.tz);
+}
+
+void RasterizationDrawCall::save(Common::WriteStream &stream) const {
+	Common::Serializer s(nullptr, &stream);
+
+	RasterizationState state = _state;
+	state.sync(s);
+
+	byte front = 0, back = 0;
+	for (uint i = 0; i < ARRAYSIZE(drawTriangleFuncs); i++) {
+		if (_drawTriangleFront == drawTriangleFuncs[i])
+			front = i;
+		if (_drawTriangleBack == drawTriangleFuncs[i])
+			back = i;
+	}
+	s.syncAsByte(front);
+	s.syncAsByte(back);
+
+	int vertexCount = _vertexCount;
+	s.syncAsSint32LE(vertexCount);
+	for (int i = 0; i < _vertexCount; i++) {
+		GLVertex vertex = _vertex[i];
+		syncVertex(s, vertex);
+	}
+}
+
+RasterizationDrawCall *RasterizationDrawCall::load(Common::SeekableReadStream &stream) {
+	GLContext *c = gl_get_context();
+	Common::Serializer s(&stream, nullptr);
+
+	RasterizationState state;
+	state.sync(s);
+
+	byte front = 0, back = 0;
+	s.syncAsByte(front);
+	s.syncAsByte(back);
+	if (front >= ARRAYSIZE(drawTriangleFuncs) || back >= ARRAYSIZE(drawTriangleFuncs))
+		error("RasterizationDrawCall: Invalid triangle function");
+
+	int vertexCount = 0;
+	s.syncAsSint32LE(vertexCount);
+	if (vertexCount < 0)
+		error("RasterizationDrawCall: Invalid vertex count %d", vertexCount);
+	if (c->vertex_max < vertexCount) {
+		gl_free(c->vertex);
+		c->vertex_max = vertexCount;
+		c->vertex = (GLVertex *)gl_malloc(sizeof(GLVertex) * c->vertex_max);
+	}
+	for (int i = 0; i < vertexCount; i++) {
+		syncVertex(s, c->vertex[i]);
+	}
+
+	// The call is made from the context, like when it was issued
+	applyState(c, state);
+	c->vertex_cnt = vertexCount;
+	c->draw_triangle_front = drawTriangleFuncs[front];
+	c->draw_triangle_back = drawTriangleFuncs[back];
+	return new RasterizationDrawCall();
+}
+
 bool RasterizationDrawCall::operator==(const RasterizationDrawCall &other) const {
 	if (_vertexCount == other._vertexCount &&
 		_drawTriangleFront == other._drawTriangleFront &&
@@ -563,9 +790,9 @@ bool RasterizationDrawCall::operator==(const RasterizationDrawCall &other) const
 
 BlittingDrawCall::BlittingDrawCall(BlitImage *image, const BlitTransform &transform, BlittingMode blittingMode) : DrawCall(DrawCall_Blitting), _transform(transform), _mode(blittingMode), _image(image) {
 	tglIncBlitImageRef(image);
-	_blitState = captureState();
+	_blitState = captureState(gl_get_context());
 	_imageVersion = tglGetBlitImageVersion(image);
-	if (gl_get_context()->_enableDirtyRectangles) {
+	if (gl_get_context()->needsDirtyRegions()) {
 		computeDirtyRegion();
 	}
 }
@@ -574,43 +801,42 @@ BlittingDrawCall::~BlittingDrawCall() {
 	tglDeleteBlitImage(_image);
 }
 
-void BlittingDrawCall::execute(bool restoreState) const {
+void BlittingDrawCall::execute(GLContext *c, bool restoreState) const {
 	BlittingState backupState;
 	if (restoreState) {
-		backupState = captureState();
+		backupState = captureState(c);
 	}
-	applyState(_blitState);
+	applyState(c, _blitState);
 
 	switch (_mode) {
 	case BlittingDrawCall::BlitMode_Regular:
-		Internal::tglBlit(_image, _transform);
+		Internal::tglBlit(c, _image, _transform);
 		break;
 	case BlittingDrawCall::BlitMode_NoBlend:
-		Internal::tglBlitNoBlend(_image, _transform);
+		Internal::tglBlitNoBlend(c, _image, _transform);
 		break;
 	case BlittingDrawCall::BlitMode_Fast:
-		Internal::tglBlitFast(_image, _transform._destinationRectangle.left, _transform._destinationRectangle.top);
+		Internal::tglBlitFast(c, _image, _transform._destinationRectangle.left, _transform._destinationRectangle.top);
 		break;
 	case BlittingDrawCall::BlitMode_ZBuffer:
-		Internal::tglBlitZBuffer(_image, _transform._destinationRectangle.left, _transform._destinationRectangle.top);
+		Internal::tglBlitZBuffer(c, _image, _transform._destinationRectangle.left, _transform._destinationRectangle.top);
 		break;
 	default:
 		break;
 	}
 	if (restoreState) {
-		applyState(backupState);
+		applyState(c, backupState);
 	}
 }
 
-void BlittingDrawCall::execute(const Common::Rect &clippingRectangle, bool restoreState) const {
-	Internal::tglBlitSetScissorRect(clippingRectangle);
-	execute(restoreState);
-	Internal::tglBlitResetScissorRect();
+void BlittingDrawCall::execute(GLContext *c, const Common::Rect &clippingRectangle, bool restoreState) const {
+	Internal::tglBlitSetScissorRect(c, clippingRectangle);
+	execute(c, restoreState);
+	Internal::tglBlitResetScissorRect(c);
 }
 
-BlittingDrawCall::BlittingState BlittingDrawCall::captureState() const {
+BlittingDrawCall::BlittingState BlittingDrawCall::captureState(GLContext *c) {
 	BlittingState state;
-	TinyGL::GLContext *c = gl_get_context();
 	state.enableBlending = c->blending_enabled;
 	state.sfactor = c->source_blending_factor;
 	state.dfactor = c->destination_blending_factor;
@@ -621,8 +847,7 @@ BlittingDrawCall::BlittingState BlittingDrawCall::captureState() const {
 	return state;
 }
 
-void BlittingDrawCall::applyState(const BlittingState &state) const {
-	TinyGL::GLContext *c = gl_get_context();
+void BlittingDrawCall::applyState(GLContext *c, const BlittingState &state) {
 	c->fb->enableBlending(state.enableBlending);
 	c->fb->setBlendingFactors(state.sfactor, state.dfactor);
 	c->fb->enableAlphaTest(state.alphaTest);
@@ -668,6 +893,65 @@ void BlittingDrawCall::computeDirtyRegion() {
 	}
 }
 
+static void syncRect(Common::Serializer &s, Common::Rect &rect) {
+	s.syncAsSint16LE(rect.left);
+	s.syncAsSint16LE(rect.top);
+	s.syncAsSint16LE(rect.right);
+	s.syncAsSint16LE(rect.bottom);
+}
+
+static void syncTransform(Common::Serializer &s, BlitTransform &transform) {
+	syncRect(s, transform._sourceRectangle);
+	syncRect(s, transform._destinationRectangle);
+	s.syncAsSint32LE(transform._rotation);
+	s.syncAsSint32LE(transform._originX);
+	s.syncAsSint32LE(transform._originY);
+	s.syncAsFloatLE(transform._aTint);
+	s.syncAsFloatLE(transform._rTint);
+	s.syncAsFloatLE(transform._gTint);
+	s.syncAsFloatLE(transform._bTint);
+	s.syncAsByte(transform._flipHorizontally);
+	s.syncAsByte(transform._flipVertically);
+}
+
+void BlittingDrawCall::save(Common::WriteStream &stream) const {
+	Common::Serializer s(nullptr, &stream);
+
+	BlittingState state = _blitState;
+	state.sync(s);
+	BlitTransform transform = _transform;
+	syncTransform(s, transform);
+	uint32 mode = _mode;
+	s.syncAsUint32LE(mode);
+}
+
+BlittingDrawCall *BlittingDrawCall::load(Common::SeekableReadStream &stream, BlitImage *image) {
+	Common::Serializer s(&stream, nullptr);
+
+	BlittingState state;
+	state.sync(s);
+	BlitTransform transform(0, 0);
+	syncTransform(s, transform);
+	uint32 mode = 0;
+	s.syncAsUint32LE(mode);
+	if (mode > BlitMode_ZBuffer)
+		error("BlittingDrawCall: Invalid blitting mode %d", mode);
+
+	// The call is made from the context, like when it was issued
+	applyState(gl_get_context(), state);
+	return new BlittingDrawCall(image, transform, (BlittingMode)mode);
+}
+
+void BlittingDrawCall::BlittingState::sync(Common::Serializer &s) {
+	s.syncAsByte(enableBlending);
+	s.syncAsSint32LE(sfactor);
+	s.syncAsSint32LE(dfactor);
+	s.syncAsByte(alphaTest);
+	s.syncAsSint32LE(alphaFunc);
+	s.syncAsSint32LE(alphaRefValue);
+	s.syncAsSint32LE(depthTestEnabled);
+}
+
 bool BlittingDrawCall::operator==(const BlittingDrawCall &other) const {
 	return
 		_mode == other._mode &&
@@ -685,24 +969,46 @@ ClearBufferDrawCall::ClearBufferDrawCall(bool clearZBuffer, int zValue,
 	  _rValue(rValue), _gValue(gValue), _bValue(bValue), _clearStencilBuffer(clearStencilBuffer),
 	  _stencilValue(stencilValue), DrawCall(DrawCall_Clear) {
 	TinyGL::GLContext *c = gl_get_context();
-	if (c->_enableDirtyRectangles) {
+	if (c->needsDirtyRegions()) {
 		_dirtyRegion = c->renderRect;
 	}
 }
 
-void ClearBufferDrawCall::execute(bool restoreState) const {
-	TinyGL::GLContext *c = gl_get_context();
+void ClearBufferDrawCall::execute(GLContext *c, bool restoreState) const {
 	c->fb->clear(_clearZBuffer, _zValue, _clearColorBuffer, _rValue, _gValue, _bValue, _clearStencilBuffer, _stencilValue);
 }
 
-void ClearBufferDrawCall::execute(const Common::Rect &clippingRectangle, bool restoreState) const {
-	TinyGL::GLContext *c = gl_get_context();
+void ClearBufferDrawCall::execute(GLContext *c, const Common::Rect &clippingRectangle, bool restoreState) const {
 	Common::Rect clearRect = clippingRectangle.findIntersectingRect(getDirtyRegion());
 	c->fb->clearRegion(clearRect.left, clearRect.top, clearRect.width(), clearRect.height(),
 	                   _clearZBuffer, _zValue, _clearColorBuffer, _rValue, _gValue, _bValue,
 	                   _clearStencilBuffer, _stencilValue);
 }
 
+void ClearBufferDrawCall::save(Common::WriteStream &stream) const {
+	Common::Serializer s(nullptr, &stream);
+	ClearBufferDrawCall call(*this);
+	call.sync(s);
+}
+
+ClearBufferDrawCall *ClearBufferDrawCall::load(Common::SeekableReadStream &stream) {
+	Common::Serializer s(&stream, nullptr);
+	ClearBufferDrawCall *call = new ClearBufferDrawCall(false, 0, false, 0, 0, 0, false, 0);
+	call->sync(s);
+	return call;
+}
+
+void ClearBufferDrawCall::sync(Common::Serializer &s) {
+	s.syncAsByte(_clearZBuffer);
+	s.syncAsSint32LE(_zValue);
+	s.syncAsByte(_clearColorBuffer);
+	s.syncAsSint32LE(_rValue);
+	s.syncAsSint32LE(_gValue);
+	s.syncAsSint32LE(_bValue);
+	s.syncAsByte(_clearStencilBuffer);
+	s.syncAsSint32LE(_stencilValue);
+}
+
 bool ClearBufferDrawCall::operator==(const ClearBufferDrawCall &other) const {
 	return
 		_clearZBuffer == other._clearZBuffer &&
@@ -760,6 +1066,56 @@ bool RasterizationDrawCall::RasterizationState::operator==(const RasterizationSt
 		viewportScaling[2] == other.viewportScaling[2];
 }
 
+void RasterizationDrawCall::RasterizationState::sync(Common::Serializer &s) {
+	s.syncAsSint32LE(beginType);
+	s.syncAsSint32LE(currentFrontFace);
+	s.syncAsSint32LE(cullFaceEnabled);
+	s.syncAsByte(colorMaskRed);
+	s.syncAsByte(colorMaskGreen);
+	s.syncAsByte(colorMaskBlue);
+	s.syncAsByte(colorMaskAlpha);
+	s.syncAsByte(depthTestEnabled);
+	s.syncAsSint32LE(depthFunction);
+	s.syncAsSint32LE(depthWriteMask);
+	s.syncAsByte(texture2DEnabled);
+	s.syncAsSint32LE(currentShadeModel);
+	s.syncAsSint32LE(polygonModeBack);
+	s.syncAsSint32LE(polygonModeFront);
+	s.syncAsSint32LE(lightingEnabled);
+	s.syncAsByte(enableBlending);
+	s.syncAsSint32LE(sfactor);
+	s.syncAsSint32LE(dfactor);
+	s.syncAsSint32LE(offsetStates);
+	s.syncAsFloatLE(offsetFactor);
+	s.syncAsFloatLE(offsetUnits);
+	syncVector(s, viewportTranslation, 3);
+	syncVector(s, viewportScaling, 3);
+	s.syncAsByte(alphaTestEnabled);
+	s.syncAsSint32LE(alphaFunc);
+	s.syncAsSint32LE(alphaRefValue);
+	s.syncAsByte(stencilTestEnabled);
+	s.syncAsSint32LE(stencilTestFunc);
+	s.syncAsSint32LE(stencilValue);
+	s.syncAsUint32LE(stencilMask);
+	s.syncAsUint32LE(stencilWriteMask);
+	s.syncAsSint32LE(stencilSfail);
+	s.syncAsSint32LE(stencilDpfail);
+	s.syncAsSint32LE(stencilDppass);
+	s.syncAsUint32LE(wrapS);
+	s.syncAsUint32LE(wrapT);
+
+	// Textures are saved by handle, and created when missing
+	uint32 handle = s.isSaving() ? texture->handle : 0;
+	s.syncAsUint32LE(handle);
+	if (s.isLoading()) {
+		GLContext *c = gl_get_context();
+		texture = c->find_texture(handle);
+		if (!texture)
+			texture = c->alloc_texture(handle);
+		textureVersion = texture->versionNumber;
+	}
+}
+
 void *Internal::allocateFrame(int size) {
 	GLContext *c = gl_get_context();
 	return c->_drawCallAllocator[c->_currentAllocatorIndex].allocate(size);
@@ -28,6 +28,12 @@
 
 #include "graphics/tinygl/zblit.h"
 
+namespace Common {
+class Serializer;
+class SeekableReadStream;
+class WriteStream;
+}
+
 namespace TinyGL {
 
 namespace Internal {
@@ -53,8 +59,12 @@ public:
 	bool operator!=(const DrawCall &other) const {
 		return !(*this == other);
 	}
-	virtual void execute(bool restoreState) const = 0;
-	virtual void execute(const Common::Rect &clippingRectangle, bool restoreState) const = 0;
+	virtual void execute(GLContext *c, bool restoreState) const = 0;
+	virtual void execute(GLContext *c, const Common::Rect &clippingRectangle, bool restoreState) const = 0;
+	// Write the call for replaying it, see capture.h. The calls are read
+	// back by the load() functions of the subclasses, which issue them
+	// on the current context.
+	virtual void save(Common::WriteStream &stream) const = 0;
 	DrawCallType getType() const { return _type; }
 	virtual const Common::Rect getDirtyRegion() const { return _dirtyRegion; }
 protected:
@@ -68,8 +78,10 @@ public:
 	ClearBufferDrawCall(bool clearZBuffer, int zValue, bool clearColorBuffer, int rValue, int gValue, int bValue, bool clearStencilBuffer, int stencilValue);
 	virtual ~ClearBufferDrawCall() { }
 	bool operator==(const ClearBufferDrawCall &other) const;
-	virtual void execute(bool restoreState) const;
-	virtual void execute(const Common::Rect &clippingRectangle, bool restoreState) const;
+	virtual void execute(GLContext *c, bool restoreState) const;
+	virtual void execute(GLContext *c, const Common::Rect &clippingRectangle, bool restoreState) const;
+	virtual void save(Common::WriteStream &stream) const;
+	static ClearBufferDrawCall *load(Common::SeekableReadStream &stream);
 
 	void *operator new(size_t size) {
 		return Internal::allocateFrame(size);
@@ -77,6 +89,8 @@ public:
 
 	void operator delete(void *p) { }
 private:
+	void sync(Common::Serializer &s);
+
 	bool _clearZBuffer, _clearColorBuffer, _clearStencilBuffer;
 	int _rValue, _gValue, _bValue, _zValue, _stencilValue;
 };
@@ -87,8 +101,12 @@ public:
 	RasterizationDrawCall();
 	virtual ~RasterizationDrawCall() { }
 	bool operator==(const RasterizationDrawCall &other) const;
-	virtual void execute(bool restoreState) const;
-	virtual void execute(const Common::Rect &clippingRectangle, bool restoreState) const;
+	virtual void execute(GLContext *c, bool restoreState) const;
+	virtual void execute(GLContext *c, const Common::Rect &clippingRectangle, bool restoreState) const;
+	virtual void save(Common::WriteStream &stream) const;
+	static RasterizationDrawCall *load(Common::SeekableReadStream &stream);
+
+	GLTexture *getTexture() const { return _state.texture; }
 
 	void *operator new(size_t size) {
 		return Internal::allocateFrame(size);
@@ -142,12 +160,13 @@ private:
 		uint wrapS, wrapT;
 
 		bool operator==(const RasterizationState &other) const;
+		void sync(Common::Serializer &s);
 	};
 
 	RasterizationState _state;
 
-	RasterizationState captureState() const;
-	void applyState(const RasterizationState &state) const;
+	static RasterizationState captureState(GLContext *c);
+	static void applyState(GLContext *c, const RasterizationState &state);
 };
 
 // Encapsulate a blit call: it might execute either a color buffer or z buffer blit.
@@ -163,10 +182,14 @@ public:
 	BlittingDrawCall(BlitImage *image, const BlitTransform &transform, BlittingMode blittingMode);
 	virtual ~BlittingDrawCall();
 	bool operator==(const BlittingDrawCall &other) const;
-	virtual void execute(bool restoreState) const;
-	virtual void execute(const Common::Rect &clippingRectangle, bool restoreState) const;
+	virtual void execute(GLContext *c, bool restoreState) const;
+	virtual void execute(GLContext *c, const Common::Rect &clippingRectangle, bool restoreState) const;
+	// The image is not part of the saved call
+	virtual void save(Common::WriteStream &stream) const;
+	static BlittingDrawCall *load(Common::SeekableReadStream &stream, BlitImage *image);
 
 	BlittingMode getBlittingMode() const { return _mode; }
+	BlitImage *getImage() const { return _image; }
 
 	void *operator new(size_t size) {
 		return Internal::allocateFrame(size);
@@ -197,10 +220,12 @@ private:
 				alphaRefValue == other.alphaRefValue &&
 				depthTestEnabled == other.depthTestEnabled;
 		}
+
+		void sync(Common::Serializer &s);
 	};
 
-	BlittingState captureState() const;
-	void applyState(const BlittingState &state) const;
+	static BlittingState captureState(GLContext *c);
+	static void applyState(GLContext *c, const BlittingState &state);
 
 	BlittingState _blitState;
 };
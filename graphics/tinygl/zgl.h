@@ -42,6 +42,11 @@
 #include "graphics/tinygl/zblit.h"
 #include "graphics/tinygl/zdirtyrect.h"
 #include "graphics/tinygl/texelbuffer.h"
+#include "graphics/tinygl/capture.h"
+
+namespace Common {
+class ThreadPool;
+}
 
 namespace TinyGL {
 
@@ -74,6 +79,7 @@ enum {
 #define VERTEX_HASH_SIZE 1031
 
 #define MAX_DISPLAY_LISTS 1024
+#define MAX_RENDER_TILES 8
 #define OP_BUFFER_MAX_SIZE 512
 
 #define TGL_OFFSET_FILL    0x1
@@ -256,6 +262,18 @@ private:
 
 struct GLContext;
 
+// A horizontal band of the screen, rasterized on its own thread
+struct RenderTile {
+	// Context drawing into the band, with its own rasterization state
+	GLContext *context;
+	Common::Rect rect;
+
+	// The parts of the regions to redraw which lie in the band, and the
+	// draw calls touching them
+	Common::Array<Common::Rect> regions;
+	Common::Array<DrawCall *> drawCalls;
+};
+
 typedef void (*gl_draw_triangle_func)(GLContext *c, GLVertex *p0, GLVertex *p1, GLVertex *p2);
 
 // display context
@@ -434,6 +452,13 @@ struct GLContext {
 	LinearAllocator _drawCallAllocator[2];
 	bool _debugRectsEnabled;
 
+	// Parallel rasterization
+	Common::Array<RenderTile *> _renderTiles;
+	Common::ThreadPool *_renderTilePool;
+
+	// Frame capture, see capture.h
+	Internal::CaptureWriter *_capture;
+
 	void gl_vertex_transform(GLVertex *v);
 
 public:
@@ -483,6 +508,21 @@ public:
 	void presentBufferDirtyRects(Common::List<Common::Rect> &dirtyAreas);
 	void presentBufferSimple(Common::List<Common::Rect> &dirtyAreas);
 
+	void initRenderTiles(int count);
+	void deinitRenderTiles();
+	void executeDrawCallsTiled(const Common::Array<Common::Rect> &regions);
+	static void executeRenderTile(void *tile);
+
+	// Tiled rendering bins the draw calls by their dirty region
+	bool needsDirtyRegions() const {
+		return _enableDirtyRectangles || !_renderTiles.empty();
+	}
+
+	// Selection needs the draw calls to run on this context
+	bool useRenderTiles() const {
+		return !_renderTiles.empty() && render_mode == TGL_RENDER;
+	}
+
 	void debugDrawRectangle(Common::Rect rect, int r, int g, int b);
 
 	GLSpecBuf *specbuf_get_buffer(const int shininess_i, const float shininess);
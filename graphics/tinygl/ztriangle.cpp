@@ -30,10 +30,185 @@
 #include "graphics/tinygl/zbuffer.h"
 #include "graphics/tinygl/zgl.h"
 
+// Opaque untextured spans are drawn, and hidden blocks of textured spans
+// skipped, four fragments at a time with SSE2 or NEON
+#include "common/simd.h"
+
 namespace TinyGL {
 
 static const int NB_INTERP = 8;
 
+#if defined(USE_SSE2) || defined(USE_NEON)
+
+static const bool kHasVectorSpans = true;
+
+// Four fragments with one unsigned 32-bit lane per fragment
+#if defined(USE_SSE2)
+typedef __m128i Lanes32;
+typedef __m128i ShiftCount;
+
+static inline Lanes32 l32Set(uint32 v) { return _mm_set1_epi32((int32)v); }
+static inline Lanes32 l32Ramp(uint32 v, int32 step) {
+	return _mm_setr_epi32((int32)v, (int32)(v + step), (int32)(v + 2 * (uint32)step), (int32)(v + 3 * (uint32)step));
+}
+static inline Lanes32 l32Add(Lanes32 a, Lanes32 b) { return _mm_add_epi32(a, b); }
+static inline Lanes32 l32Or(Lanes32 a, Lanes32 b) { return _mm_or_si128(a, b); }
+static inline Lanes32 l32Load(const uint32 *p) { return _mm_loadu_si128((const __m128i *)p); }
+static inline void l32Store(uint32 *p, Lanes32 a) { _mm_storeu_si128((__m128i *)p, a); }
+static inline Lanes32 l32Select(Lanes32 mask, Lanes32 a, Lanes32 b) { return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b)); }
+static inline Lanes32 l32Less(Lanes32 a, Lanes32 b) {
+	const __m128i bias = _mm_set1_epi32((int32)0x80000000);
+	return _mm_cmplt_epi32(_mm_xor_si128(a, bias), _mm_xor_si128(b, bias));
+}
+static inline Lanes32 l32Not(Lanes32 a) { return _mm_xor_si128(a, _mm_set1_epi32(-1)); }
+static inline bool l32Any(Lanes32 mask) { return _mm_movemask_epi8(mask) != 0; }
+static inline ShiftCount shiftCount(int n) { return _mm_cvtsi32_si128(n); }
+static inline Lanes32 l32Channel(Lanes32 c, ShiftCount loss, ShiftCount shift) {
+	const __m128i value = _mm_and_si128(_mm_srli_epi32(c, 8), _mm_set1_epi32(0xFF));
+	return _mm_sll_epi32(_mm_srl_epi32(value, loss), shift);
+}
+static inline void l32StoreMasked16(uint16 *p, Lanes32 value, Lanes32 mask) {
+	// The values fit in 16 bits, sign extend them to survive the saturation
+	const __m128i value16 = _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(value, 16), 16), _mm_setzero_si128());
+	const __m128i mask16 = _mm_packs_epi32(mask, _mm_setzero_si128());
+	const __m128i old = _mm_loadl_epi64((const __m128i *)p);
+	_mm_storel_epi64((__m128i *)p, _mm_or_si128(_mm_and_si128(mask16, value16), _mm_andnot_si128(mask16, old)));
+}
+#else
+typedef uint32x4_t Lanes32;
+typedef int32x4_t ShiftCount;
+
+static inline Lanes32 l32Set(uint32 v) { return vdupq_n_u32(v); }
+static inline Lanes32 l32Ramp(uint32 v, int32 step) {
+	const uint32 lanes[4] = { v, v + step, v + 2 * (uint32)step, v + 3 * (uint32)step };
+	return vld1q_u32(lanes);
+}
+static inline Lanes32 l32Add(Lanes32 a, Lanes32 b) { return vaddq_u32(a, b); }
+static inline Lanes32 l32Or(Lanes32 a, Lanes32 b) { return vorrq_u32(a, b); }
+static inline Lanes32 l32Load(const uint32 *p) { return vld1q_u32(p); }
+static inline void l32Store(uint32 *p, Lanes32 a) { vst1q_u32(p, a); }
+static inline Lanes32 l32Select(Lanes32 mask, Lanes32 a, Lanes32 b) { return vbslq_u32(mask, a, b); }
+static inline Lanes32 l32Less(Lanes32 a, Lanes32 b) { return vcltq_u32(a, b); }
+static inline Lanes32 l32Not(Lanes32 a) { return vmvnq_u32(a); }
+static inline bool l32Any(Lanes32 mask) {
+	const uint32x2_t halves = vorr_u32(vget_low_u32(mask), vget_high_u32(mask));
+	return (vget_lane_u32(halves, 0) | vget_lane_u32(halves, 1)) != 0;
+}
+static inline ShiftCount shiftCount(int n) { return vdupq_n_s32(n); }
+static inline Lanes32 l32Channel(Lanes32 c, ShiftCount loss, ShiftCount shift) {
+	const uint32x4_t value = vandq_u32(vshrq_n_u32(c, 8), vdupq_n_u32(0xFF));
+	return vshlq_u32(vshlq_u32(value, vnegq_s32(loss)), shift);
+}
+static inline void l32StoreMasked16(uint16 *p, Lanes32 value, Lanes32 mask) {
+	vst1_u16(p, vbsl_u16(vmovn_u32(mask), vmovn_u32(value), vld1_u16(p)));
+}
+#endif
+
+static inline void l32StoreMasked32(uint32 *p, Lanes32 value, Lanes32 mask) {
+	l32Store(p, l32Select(mask, value, l32Load(p)));
+}
+
+// The fragments passing the depth test, for the LESS and LEQUAL functions
+static inline Lanes32 depthTestMask(int depthFunc, Lanes32 zSrc, Lanes32 zDst) {
+	if (depthFunc == TGL_LEQUAL)
+		return l32Not(l32Less(zSrc, zDst));
+	return l32Less(zDst, zSrc);
+}
+
+template <bool kInterpRGB, bool kSmoothMode, bool kDepthWrite, bool kDepthTestEnabled>
+int FrameBuffer::fillSpanVector(int pixel, uint *pz, int count, uint &z, uint &r, uint &g, uint &b, uint &a,
+	                            int dzdx, int drdx, int dgdx, int dbdx, int dadx) {
+	const int groups = count / 4;
+	if (groups == 0) {
+		return 0;
+	}
+
+	// The colors are packed like PixelFormat::ARGBToColor() does
+	const ShiftCount aLoss = shiftCount(_pbufFormat.aLoss), aShift = shiftCount(_pbufFormat.aShift);
+	const ShiftCount rLoss = shiftCount(_pbufFormat.rLoss), rShift = shiftCount(_pbufFormat.rShift);
+	const ShiftCount gLoss = shiftCount(_pbufFormat.gLoss), gShift = shiftCount(_pbufFormat.gShift);
+	const ShiftCount bLoss = shiftCount(_pbufFormat.bLoss), bShift = shiftCount(_pbufFormat.bShift);
+
+	Lanes32 zv = l32Ramp(z, dzdx);
+	Lanes32 rv = l32Ramp(r, drdx), gv = l32Ramp(g, dgdx), bv = l32Ramp(b, dbdx), av = l32Ramp(a, dadx);
+	const Lanes32 zStep = l32Set(4 * (uint32)dzdx);
+	const Lanes32 rStep = l32Set(4 * (uint32)drdx), gStep = l32Set(4 * (uint32)dgdx);
+	const Lanes32 bStep = l32Set(4 * (uint32)dbdx), aStep = l32Set(4 * (uint32)dadx);
+	const Lanes32 allSet = l32Set(0xFFFFFFFF);
+
+	Lanes32 color = allSet;
+	if (kInterpRGB && !kSmoothMode) {
+		color = l32Or(l32Or(l32Channel(av, aLoss, aShift), l32Channel(rv, rLoss, rShift)),
+		              l32Or(l32Channel(gv, gLoss, gShift), l32Channel(bv, bLoss, bShift)));
+	}
+
+	for (int i = 0; i < groups; i++) {
+		Lanes32 mask = allSet;
+		if (kDepthTestEnabled || kDepthWrite) {
+			const Lanes32 zDst = l32Load(pz);
+			if (kDepthTestEnabled) {
+				mask = depthTestMask(_depthFunc, zv, zDst);
+			}
+			if (kDepthWrite) {
+				l32Store(pz, l32Select(mask, zv, zDst));
+			}
+		}
+
+		if (kInterpRGB) {
+			if (kSmoothMode) {
+				color = l32Or(l32Or(l32Channel(av, aLoss, aShift), l32Channel(rv, rLoss, rShift)),
+				              l32Or(l32Channel(gv, gLoss, gShift), l32Channel(bv, bLoss, bShift)));
+				rv = l32Add(rv, rStep);
+				gv = l32Add(gv, gStep);
+				bv = l32Add(bv, bStep);
+				av = l32Add(av, aStep);
+			}
+			if (_pbufBpp == 2) {
+				l32StoreMasked16((uint16 *)_pbuf.getRawBuffer(pixel), color, mask);
+			} else {
+				l32StoreMasked32((uint32 *)_pbuf.getRawBuffer(pixel), color, mask);
+			}
+		}
+
+		zv = l32Add(zv, zStep);
+		pixel += 4;
+		pz += 4;
+	}
+
+	const uint drawn = groups * 4;
+	z += drawn * dzdx;
+	if (kSmoothMode) {
+		r += drawn * drdx;
+		g += drawn * dgdx;
+		b += drawn * dbdx;
+		a += drawn * dadx;
+	}
+	return drawn;
+}
+
+bool FrameBuffer::isBlockHidden(const uint *pz, uint z, int dzdx) {
+	const Lanes32 zv = l32Ramp(z, dzdx);
+	const Lanes32 zv2 = l32Add(zv, l32Set(4 * (uint32)dzdx));
+	return !l32Any(depthTestMask(_depthFunc, zv, l32Load(pz))) &&
+	       !l32Any(depthTestMask(_depthFunc, zv2, l32Load(pz + 4)));
+}
+
+#else
+
+static const bool kHasVectorSpans = false;
+
+template <bool kInterpRGB, bool kSmoothMode, bool kDepthWrite, bool kDepthTestEnabled>
+int FrameBuffer::fillSpanVector(int pixel, uint *pz, int count, uint &z, uint &r, uint &g, uint &b, uint &a,
+	                            int dzdx, int drdx, int dgdx, int dbdx, int dadx) {
+	return 0;
+}
+
+bool FrameBuffer::isBlockHidden(const uint *pz, uint z, int dzdx) {
+	return false;
+}
+
+#endif
+
 template <bool kDepthWrite, bool kSmoothMode, bool kEnableAlphaTest, bool kEnableScissor, bool kEnableBlending, bool kStencilEnabled, bool kDepthTestEnabled>
 FORCEINLINE void FrameBuffer::putPixelNoTexture(int fbOffset, uint *pz, byte *ps, int _a,
 	                                        int x, int y, uint &z, uint &r, uint &g, uint &b, uint &a,
@@ -71,7 +246,7 @@ FORCEINLINE void FrameBuffer::putPixelNoTexture(int fbOffset, uint *pz, byte *ps
 
 template <bool kDepthWrite, bool kLightsMode, bool kSmoothMode, bool kEnableAlphaTest, bool kEnableScissor, bool kEnableBlending, bool kStencilEnabled, bool kDepthTestEnabled>
 FORCEINLINE void FrameBuffer::putPixelTexture(int fbOffset, const TexelBuffer *texture,
-	                                      uint wrap_s, uint wrap_t, uint *pz, byte *ps, int _a,
+	                                      uint wrap_s, uint wrap_t, uint level, uint *pz, byte *ps, int _a,
 	                                      int x, int y, uint &z, int &t, int &s,
 	                                      uint &r, uint &g, uint &b, uint &a,
 	                                      int &dzdx, int &dsdx, int &dtdx, int &drdx, int &dgdx, int &dbdx, uint dadx) {
@@ -96,7 +271,7 @@ FORCEINLINE void FrameBuffer::putPixelTexture(int fbOffset, const TexelBuffer *t
 	}
 	if (depthTestResult) {
 		uint8 c_a, c_r, c_g, c_b;
-		texture->getARGBAt(wrap_s, wrap_t, s, t, c_a, c_r, c_g, c_b);
+		texture->getARGBAt(wrap_s, wrap_t, s, t, level, c_a, c_r, c_g, c_b);
 		if (kLightsMode) {
 			uint l_a = (a >> (ZB_POINT_ALPHA_BITS - 8));
 			uint l_r = (r >> (ZB_POINT_RED_BITS - 8));
@@ -313,6 +488,14 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 		pr1 = p0;
 		pr2 = p2;
 	}
+	// Only the LESS and LEQUAL depth functions are vectorized, they are the
+	// ones used for drawing scenes. Hidden blocks of a textured span can
+	// only be skipped without stencil operations to apply.
+	const bool vectorDepthTest = kHasVectorSpans && (!kDepthTestEnabled || _depthFunc == TGL_LESS || _depthFunc == TGL_LEQUAL);
+	const bool vectorSpans = vectorDepthTest && !kAlphaTestEnabled && !kBlendingEnabled && !kStencilEnabled &&
+	                         (!kInterpRGB || _pbufBpp == 2 || _pbufBpp == 4);
+	const bool skipHiddenBlocks = vectorDepthTest && kDepthTestEnabled && !kStencilEnabled;
+
 	nb_lines = p1->y - p0->y;
 	y = p0->y;
 	for (part = 0; part < 2; part++) {
@@ -395,7 +578,9 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 		// we draw all the scan line of the part
 		while (nb_lines > 0) {
 			int x = x1;
-			if (!kInterpRGB) {
+			if (kEnableScissor && (y < _clipRectangle.top || y >= _clipRectangle.bottom)) {
+				// The line is outside of the scissor rectangle, only step the edges
+			} else if (!kInterpRGB) {
 				int n;
 				uint *pz;
 				byte *ps = nullptr;
@@ -408,6 +593,13 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 				if (kStencilEnabled) {
 					ps = ps1 + x1;
 				}
+				if (vectorSpans && (!kEnableScissor || (x >= _clipRectangle.left && x + n < _clipRectangle.right))) {
+					uint unused = 0;
+					const int drawn = fillSpanVector<false, false, kDepthWrite, kDepthTestEnabled>(0, pz, n + 1, z, unused, unused, unused, unused, dzdx, 0, 0, 0, 0);
+					pz += drawn;
+					n -= drawn;
+					x += drawn;
+				}
 				while (n >= 3) {
 					putPixelDepth<kDepthWrite, kEnableScissor, kStencilEnabled, kDepthTestEnabled>(pz, ps, 0, x, y, z, dzdx);
 					putPixelDepth<kDepthWrite, kEnableScissor, kStencilEnabled, kDepthTestEnabled>(pz, ps, 1, x, y, z, dzdx);
@@ -451,6 +643,13 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 				if (kStencilEnabled) {
 					ps = ps1 + x1;
 				}
+				if (vectorSpans && (!kEnableScissor || (x >= _clipRectangle.left && x + n < _clipRectangle.right))) {
+					const int drawn = fillSpanVector<true, kSmoothMode, kDepthWrite, kDepthTestEnabled>(pp, pz, n + 1, z, r, g, b, a, dzdx, drdx, dgdx, dbdx, dadx);
+					pp += drawn;
+					pz += drawn;
+					n -= drawn;
+					x += drawn;
+				}
 				while (n >= 3) {
 					putPixelNoTexture<kDepthWrite, kSmoothMode, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled, kStencilEnabled, kDepthTestEnabled>(pp, pz, ps, 0, x, y, z, r, g, b, a, dzdx, drdx, dgdx, dbdx, dadx);
 					putPixelNoTexture<kDepthWrite, kSmoothMode, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled, kStencilEnabled, kDepthTestEnabled>(pp, pz, ps, 1, x, y, z, r, g, b, a, dzdx, drdx, dgdx, dbdx, dadx);
@@ -486,6 +685,7 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 				int n, pp;
 				float sz, tz, fz, zinv;
 				int dsdx, dtdx;
+				uint level;
 
 				n = (x2 >> 16) - x1;
 				fz = (float)z1;
@@ -514,12 +714,27 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 						t = (int)tt;
 						dsdx = (int)((dszdx - ss * fdzdx) * zinv);
 						dtdx = (int)((dtzdx - tt * fdzdx) * zinv);
+						level = texture->getLevel(dsdx, dtdx);
 						fz += fndzdx;
 						zinv = (float)(1.0 / fz);
 					}
-					for (int _a = 0; _a < NB_INTERP; _a++) {
-						putPixelTexture<kDepthWrite, kInterpRGB, kSmoothMode, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled, kStencilEnabled, kDepthTestEnabled>
-						               (pp, texture, _wrapS, _wrapT, pz, ps, _a, x, y, z, t, s, r, g, b, a, dzdx, dsdx, dtdx, drdx, dgdx, dbdx, dadx);
+					if (skipHiddenBlocks && (!kEnableScissor || (x >= _clipRectangle.left && x + NB_INTERP <= _clipRectangle.right)) &&
+					    isBlockHidden(pz, z, dzdx)) {
+						// None of the fragments is visible, only step the values
+						z += NB_INTERP * (uint)dzdx;
+						s += NB_INTERP * dsdx;
+						t += NB_INTERP * dtdx;
+						if (kSmoothMode) {
+							r += NB_INTERP * drdx;
+							g += NB_INTERP * dgdx;
+							b += NB_INTERP * dbdx;
+							a += NB_INTERP * dadx;
+						}
+					} else {
+						for (int _a = 0; _a < NB_INTERP; _a++) {
+							putPixelTexture<kDepthWrite, kInterpRGB, kSmoothMode, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled, kStencilEnabled, kDepthTestEnabled>
+							               (pp, texture, _wrapS, _wrapT, level, pz, ps, _a, x, y, z, t, s, r, g, b, a, dzdx, dsdx, dtdx, drdx, dgdx, dbdx, dadx);
+						}
 					}
 					pp += NB_INTERP;
 					if (kInterpZ) {
@@ -542,11 +757,12 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 					t = (int)tt;
 					dsdx = (int)((dszdx - ss * fdzdx) * zinv);
 					dtdx = (int)((dtzdx - tt * fdzdx) * zinv);
+					level = texture->getLevel(dsdx, dtdx);
 				}
 
 				while (n >= 0) {
 					putPixelTexture<kDepthWrite, kInterpRGB, kSmoothMode, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled, kStencilEnabled, kDepthTestEnabled>
-					               (pp, texture, _wrapS, _wrapT, pz, ps, 0, x, y, z, t, s, r, g, b, a, dzdx, dsdx, dtdx, drdx, dgdx, dbdx, dadx);
+					               (pp, texture, _wrapS, _wrapT, level, pz, ps, 0, x, y, z, t, s, r, g, b, a, dzdx, dsdx, dtdx, drdx, dgdx, dbdx, dadx);
 					pp += 1;
 					if (kInterpZ) {
 						pz += 1;
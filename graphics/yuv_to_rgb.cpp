@@ -85,6 +85,11 @@
 #include "graphics/surface.h"
 #include "graphics/yuv_to_rgb.h"
 
+// The converters handle eight pixels at a time with SSE2 or NEON. The
+// lookup tables convert the rest of each row and are used on other targets
+// and for YUVA.
+#include "common/simd.h"
+
 namespace Common {
 DECLARE_SINGLETON(Graphics::YUVToRGBManager);
 }
@@ -97,12 +102,14 @@ public:
 
 	Graphics::PixelFormat getFormat() const { return _format; }
 	YUVToRGBManager::LuminanceScale getScale() const { return _scale; }
+	bool getAlphaMode() const { return _alphaMode; }
 	const uint32 *getRGBToPix() const { return _rgbToPix; }
 	const uint32 *getAlphaToPix() const { return _alphaToPix; }
 
 private:
 	Graphics::PixelFormat _format;
 	YUVToRGBManager::LuminanceScale _scale;
+	bool _alphaMode;
 	uint32 _rgbToPix[3 * 768]; // 9216 bytes
 	uint32 _alphaToPix[256];   // 958 bytes
 };
@@ -110,6 +117,7 @@ private:
 YUVToRGBLookup::YUVToRGBLookup(Graphics::PixelFormat format, YUVToRGBManager::LuminanceScale scale, bool alphaMode) {
 	_format = format;
 	_scale = scale;
+	_alphaMode = alphaMode;
 
 	int alphaValue = alphaMode ? 0 : 255;
 
@@ -166,9 +174,6 @@ YUVToRGBLookup::YUVToRGBLookup(Graphics::PixelFormat format, YUVToRGBManager::Lu
 }
 
 YUVToRGBManager::YUVToRGBManager() {
-	_lookup = 0;
-	_alphaMode = false;
-
 	int16 *Cr_r_tab = &_colorTab[0 * 256];
 	int16 *Cr_g_tab = &_colorTab[1 * 256];
 	int16 *Cb_g_tab = &_colorTab[2 * 256];
@@ -189,18 +194,335 @@ YUVToRGBManager::YUVToRGBManager() {
 }
 
 YUVToRGBManager::~YUVToRGBManager() {
-	delete _lookup;
+	for (uint i = 0; i < _lookups.size(); i++)
+		delete _lookups[i];
 }
 
 const YUVToRGBLookup *YUVToRGBManager::getLookup(Graphics::PixelFormat format, YUVToRGBManager::LuminanceScale scale, bool alphaMode) {
-	if (_lookup && _lookup->getFormat() == format && _lookup->getScale() == scale && _alphaMode == alphaMode)
-		return _lookup;
+	Common::StackLock lock(_lookupMutex);
 
-	_alphaMode = alphaMode;
-	delete _lookup;
-	_lookup = new YUVToRGBLookup(format, scale, alphaMode);
-	return _lookup;
+	for (uint i = 0; i < _lookups.size(); i++) {
+		const YUVToRGBLookup *lookup = _lookups[i];
+
+		if (lookup->getFormat() == format && lookup->getScale() == scale && lookup->getAlphaMode() == alphaMode)
+			return lookup;
+	}
+
+	_lookups.push_back(new YUVToRGBLookup(format, scale, alphaMode));
+	return _lookups.back();
+}
+
+#if defined(USE_SSE2) || defined(USE_NEON)
+
+// Eight pixels with one signed 16-bit lane per pixel, and their 32-bit
+// halves for composing 32bpp pixels
+#if defined(USE_SSE2)
+typedef __m128i Lanes16;
+typedef __m128i Lanes32;
+typedef __m128i ShiftCount;
+
+static inline Lanes16 l16Set(int16 v) { return _mm_set1_epi16(v); }
+static inline Lanes16 l16Load8(const byte *p) { return _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)p), _mm_setzero_si128()); }
+static inline Lanes16 l16Load4Doubled(const byte *p) {
+	int32 v;
+	memcpy(&v, p, 4);
+	const __m128i bytes = _mm_cvtsi32_si128(v);
+	return _mm_unpacklo_epi8(_mm_unpacklo_epi8(bytes, bytes), _mm_setzero_si128());
+}
+static inline Lanes16 l16Pair(int16 a, int16 b) { return _mm_setr_epi16(a, a, a, a, b, b, b, b); }
+static inline Lanes16 l16Add(Lanes16 a, Lanes16 b) { return _mm_add_epi16(a, b); }
+static inline Lanes16 l16Sub(Lanes16 a, Lanes16 b) { return _mm_sub_epi16(a, b); }
+static inline Lanes16 l16Mul(Lanes16 a, Lanes16 b) { return _mm_mullo_epi16(a, b); }
+static inline Lanes16 l16MulHiU(Lanes16 a, uint16 b) { return _mm_mulhi_epu16(a, _mm_set1_epi16((int16)b)); }
+static inline Lanes16 l16Shr4(Lanes16 a) { return _mm_srli_epi16(a, 4); }
+static inline Lanes16 l16Clamp(Lanes16 a, int16 lo, int16 hi) { return _mm_min_epi16(_mm_max_epi16(a, _mm_set1_epi16(lo)), _mm_set1_epi16(hi)); }
+static inline Lanes16 l16Sign(Lanes16 a) { return _mm_srai_epi16(a, 15); }
+static inline Lanes16 l16ApplySign(Lanes16 a, Lanes16 sign) { return _mm_sub_epi16(_mm_xor_si128(a, sign), sign); }
+static inline Lanes16 l16Or(Lanes16 a, Lanes16 b) { return _mm_or_si128(a, b); }
+static inline ShiftCount shiftCount(int n) { return _mm_cvtsi32_si128(n); }
+static inline Lanes16 l16Place(Lanes16 a, ShiftCount loss, ShiftCount shift) { return _mm_sll_epi16(_mm_srl_epi16(a, loss), shift); }
+static inline void l16Store(uint16 *p, Lanes16 a) { _mm_storeu_si128((__m128i *)p, a); }
+static inline Lanes32 l16Low(Lanes16 a) { return _mm_unpacklo_epi16(a, _mm_setzero_si128()); }
+static inline Lanes32 l16High(Lanes16 a) { return _mm_unpackhi_epi16(a, _mm_setzero_si128()); }
+static inline Lanes32 l32Set(uint32 v) { return _mm_set1_epi32((int32)v); }
+static inline Lanes32 l32Or(Lanes32 a, Lanes32 b) { return _mm_or_si128(a, b); }
+static inline Lanes32 l32Place(Lanes32 a, ShiftCount loss, ShiftCount shift) { return _mm_sll_epi32(_mm_srl_epi32(a, loss), shift); }
+static inline void l32Store(uint32 *p, Lanes32 a) { _mm_storeu_si128((__m128i *)p, a); }
+static inline void l32StoreHalves(uint32 *p, Lanes16 low, Lanes16 high) {
+	_mm_storeu_si128((__m128i *)p, _mm_unpacklo_epi16(low, high));
+	_mm_storeu_si128((__m128i *)p + 1, _mm_unpackhi_epi16(low, high));
 }
+#else
+typedef int16x8_t Lanes16;
+typedef uint32x4_t Lanes32;
+struct ShiftCount {
+	int16x8_t n16;
+	int32x4_t n32;
+};
+
+static inline Lanes16 l16Set(int16 v) { return vdupq_n_s16(v); }
+static inline Lanes16 l16Load8(const byte *p) { return vreinterpretq_s16_u16(vmovl_u8(vld1_u8(p))); }
+static inline Lanes16 l16Load4Doubled(const byte *p) {
+	uint32 v;
+	memcpy(&v, p, 4);
+	const uint8x8_t bytes = vreinterpret_u8_u32(vdup_n_u32(v));
+	return vreinterpretq_s16_u16(vmovl_u8(vzip_u8(bytes, bytes).val[0]));
+}
+static inline Lanes16 l16Pair(int16 a, int16 b) { return vcombine_s16(vdup_n_s16(a), vdup_n_s16(b)); }
+static inline Lanes16 l16Add(Lanes16 a, Lanes16 b) { return vaddq_s16(a, b); }
+static inline Lanes16 l16Sub(Lanes16 a, Lanes16 b) { return vsubq_s16(a, b); }
+static inline Lanes16 l16Mul(Lanes16 a, Lanes16 b) { return vmulq_s16(a, b); }
+static inline Lanes16 l16MulHiU(Lanes16 a, uint16 b) {
+	const uint16x8_t u = vreinterpretq_u16_s16(a);
+	return vreinterpretq_s16_u16(vcombine_u16(vshrn_n_u32(vmull_n_u16(vget_low_u16(u), b), 16),
+	                                          vshrn_n_u32(vmull_n_u16(vget_high_u16(u), b), 16)));
+}
+static inline Lanes16 l16Shr4(Lanes16 a) { return vreinterpretq_s16_u16(vshrq_n_u16(vreinterpretq_u16_s16(a), 4)); }
+static inline Lanes16 l16Clamp(Lanes16 a, int16 lo, int16 hi) { return vminq_s16(vmaxq_s16(a, vdupq_n_s16(lo)), vdupq_n_s16(hi)); }
+static inline Lanes16 l16Sign(Lanes16 a) { return vshrq_n_s16(a, 15); }
+static inline Lanes16 l16ApplySign(Lanes16 a, Lanes16 sign) { return vsubq_s16(veorq_s16(a, sign), sign); }
+static inline Lanes16 l16Or(Lanes16 a, Lanes16 b) { return vorrq_s16(a, b); }
+static inline ShiftCount shiftCount(int n) {
+	ShiftCount c;
+	c.n16 = vdupq_n_s16(n);
+	c.n32 = vdupq_n_s32(n);
+	return c;
+}
+static inline Lanes16 l16Place(Lanes16 a, ShiftCount loss, ShiftCount shift) {
+	const uint16x8_t u = vreinterpretq_u16_s16(a);
+	return vreinterpretq_s16_u16(vshlq_u16(vshlq_u16(u, vnegq_s16(loss.n16)), shift.n16));
+}
+static inline void l16Store(uint16 *p, Lanes16 a) { vst1q_u16(p, vreinterpretq_u16_s16(a)); }
+static inline Lanes32 l16Low(Lanes16 a) { return vmovl_u16(vget_low_u16(vreinterpretq_u16_s16(a))); }
+static inline Lanes32 l16High(Lanes16 a) { return vmovl_u16(vget_high_u16(vreinterpretq_u16_s16(a))); }
+static inline Lanes32 l32Set(uint32 v) { return vdupq_n_u32(v); }
+static inline Lanes32 l32Or(Lanes32 a, Lanes32 b) { return vorrq_u32(a, b); }
+static inline Lanes32 l32Place(Lanes32 a, ShiftCount loss, ShiftCount shift) { return vshlq_u32(vshlq_u32(a, vnegq_s32(loss.n32)), shift.n32); }
+static inline void l32Store(uint32 *p, Lanes32 a) { vst1q_u32(p, a); }
+static inline void l32StoreHalves(uint32 *p, Lanes16 low, Lanes16 high) {
+	int16x8x2_t halves;
+	halves.val[0] = low;
+	halves.val[1] = high;
+	vst2q_s16((int16 *)p, halves);
+}
+#endif
+
+/**
+ * Computes the same values as the lookup tables, eight pixels at a time.
+ *
+ * The chroma tables hold (int16)(factor * (c - 128)). The integer part of
+ * each factor is 0 or 1, and the fraction is applied to |c - 128| with a
+ * 16-bit fixed point multiplier. The multipliers were chosen to match the
+ * truncated products for all 256 inputs. Luminance is clamped like the
+ * spread out ends of the RGB tables, and the ITU scale of (i - 16) * 255 / 219
+ * is computed as i + i * 36 / 219.
+ */
+class YUVToRGBVector {
+public:
+	YUVToRGBVector(const YUVToRGBLookup *lookup) {
+		const Graphics::PixelFormat format = lookup->getFormat();
+		_itu = lookup->getScale() == YUVToRGBManager::kScaleITU;
+		_rLoss = shiftCount(format.rLoss);
+		_gLoss = shiftCount(format.gLoss);
+		_bLoss = shiftCount(format.bLoss);
+		_rShift = shiftCount(format.rShift);
+		_gShift = shiftCount(format.gShift);
+		_bShift = shiftCount(format.bShift);
+		_alpha = format.ARGBToColor(255, 0, 0, 0);
+
+		// 32bpp pixels are composed from two 16-bit halves when no channel
+		// crosses the middle, which holds for all the usual formats
+		_rHigh = format.rShift >= 16;
+		_gHigh = format.gShift >= 16;
+		_bHigh = format.bShift >= 16;
+		_halves = format.bytesPerPixel == 4 &&
+		          (format.rShift & 15) + 8 - format.rLoss <= 16 &&
+		          (format.gShift & 15) + 8 - format.gLoss <= 16 &&
+		          (format.bShift & 15) + 8 - format.bLoss <= 16;
+		_rHalfShift = shiftCount(format.rShift & 15);
+		_gHalfShift = shiftCount(format.gShift & 15);
+		_bHalfShift = shiftCount(format.bShift & 15);
+	}
+
+	/** Computes the chroma terms of eight pixels from their U and V values. */
+	inline void chroma(Lanes16 u, Lanes16 v, Lanes16 &crR, Lanes16 &crbG, Lanes16 &cbB) const {
+		const Lanes16 cr = l16Sub(v, l16Set(128));
+		const Lanes16 cb = l16Sub(u, l16Set(128));
+		const Lanes16 crSign = l16Sign(cr);
+		const Lanes16 cbSign = l16Sign(cb);
+		const Lanes16 crAbs = l16ApplySign(cr, crSign);
+		const Lanes16 cbAbs = l16ApplySign(cb, cbSign);
+
+		crR = l16ApplySign(l16Add(crAbs, l16MulHiU(crAbs, 26302)), crSign);  // 0.419 / 0.299
+		cbB = l16ApplySign(l16Add(cbAbs, l16MulHiU(cbAbs, 50686)), cbSign);  // 0.587 / 0.331
+		crbG = l16Add(l16ApplySign(l16MulHiU(crAbs, 46767), crSign),         // 0.299 / 0.419
+		              l16ApplySign(l16MulHiU(cbAbs, 22571), cbSign));        // 0.114 / 0.331
+	}
+
+	template<typename PixelInt>
+	inline void put(PixelInt *dst, Lanes16 y, Lanes16 crR, Lanes16 crbG, Lanes16 cbB) const {
+		const Lanes16 r = luminance(l16Add(y, crR));
+		const Lanes16 g = luminance(l16Sub(y, crbG));
+		const Lanes16 b = luminance(l16Add(y, cbB));
+
+		if (sizeof(PixelInt) == 2) {
+			Lanes16 pixels = l16Or(l16Set((int16)_alpha), l16Place(r, _rLoss, _rShift));
+			pixels = l16Or(pixels, l16Place(g, _gLoss, _gShift));
+			pixels = l16Or(pixels, l16Place(b, _bLoss, _bShift));
+			l16Store((uint16 *)dst, pixels);
+		} else if (_halves) {
+			Lanes16 low = l16Set((int16)(_alpha & 0xffff));
+			Lanes16 high = l16Set((int16)(_alpha >> 16));
+			const Lanes16 rPart = l16Place(r, _rLoss, _rHalfShift);
+			const Lanes16 gPart = l16Place(g, _gLoss, _gHalfShift);
+			const Lanes16 bPart = l16Place(b, _bLoss, _bHalfShift);
+			if (_rHigh)
+				high = l16Or(high, rPart);
+			else
+				low = l16Or(low, rPart);
+			if (_gHigh)
+				high = l16Or(high, gPart);
+			else
+				low = l16Or(low, gPart);
+			if (_bHigh)
+				high = l16Or(high, bPart);
+			else
+				low = l16Or(low, bPart);
+			l32StoreHalves((uint32 *)dst, low, high);
+		} else {
+			Lanes32 low = l32Or(l32Set(_alpha), l32Place(l16Low(r), _rLoss, _rShift));
+			low = l32Or(low, l32Place(l16Low(g), _gLoss, _gShift));
+			low = l32Or(low, l32Place(l16Low(b), _bLoss, _bShift));
+			Lanes32 high = l32Or(l32Set(_alpha), l32Place(l16High(r), _rLoss, _rShift));
+			high = l32Or(high, l32Place(l16High(g), _gLoss, _gShift));
+			high = l32Or(high, l32Place(l16High(b), _bLoss, _bShift));
+			l32Store((uint32 *)dst, low);
+			l32Store((uint32 *)dst + 4, high);
+		}
+	}
+
+private:
+	inline Lanes16 luminance(Lanes16 value) const {
+		if (!_itu)
+			return l16Clamp(value, 0, 255);
+
+		value = l16Sub(l16Clamp(value, 16, 235), l16Set(16));
+		return l16Add(value, l16MulHiU(value, 10774));
+	}
+
+	bool _itu;
+	ShiftCount _rLoss, _gLoss, _bLoss, _rShift, _gShift, _bShift;
+	uint32 _alpha;
+	bool _halves, _rHigh, _gHigh, _bHigh;
+	ShiftCount _rHalfShift, _gHalfShift, _bHalfShift;
+};
+
+/**
+ * Converts the leading part of a row of YUV444 pixels.
+ *
+ * @return Number of pixels converted; the caller converts the rest.
+ */
+template<typename PixelInt>
+static int convertYUV444RowVector(const YUVToRGBVector &vec, byte *dstPtr, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth) {
+	int x = 0;
+	for (; x + 8 <= yWidth; x += 8) {
+		Lanes16 crR, crbG, cbB;
+		vec.chroma(l16Load8(uSrc + x), l16Load8(vSrc + x), crR, crbG, cbB);
+		vec.put<PixelInt>((PixelInt *)dstPtr + x, l16Load8(ySrc + x), crR, crbG, cbB);
+	}
+	return x;
+}
+
+/**
+ * Converts the leading part of a pair of YUV420 rows.
+ *
+ * @return Number of chroma samples converted; the caller converts the rest.
+ */
+template<typename PixelInt>
+static int convertYUV420RowVector(const YUVToRGBVector &vec, byte *dstPtr, int dstPitch, const byte *ySrc, int yPitch, const byte *uSrc, const byte *vSrc, int halfWidth) {
+	int x = 0;
+	for (; x + 4 <= halfWidth; x += 4) {
+		Lanes16 crR, crbG, cbB;
+		vec.chroma(l16Load4Doubled(uSrc + x), l16Load4Doubled(vSrc + x), crR, crbG, cbB);
+		vec.put<PixelInt>((PixelInt *)dstPtr + 2 * x, l16Load8(ySrc + 2 * x), crR, crbG, cbB);
+		vec.put<PixelInt>((PixelInt *)(dstPtr + dstPitch) + 2 * x, l16Load8(ySrc + yPitch + 2 * x), crR, crbG, cbB);
+	}
+	return x;
+}
+
+/** Bilinear chroma interpolation for two chroma samples, see DO_INTERPOLATION. */
+static inline Lanes16 interpolate(const byte *src, int uvPitch, Lanes16 wA, Lanes16 wB, Lanes16 wC, Lanes16 wD) {
+	Lanes16 sum = l16Mul(l16Pair(src[0], src[1]), wA);
+	sum = l16Add(sum, l16Mul(l16Pair(src[1], src[2]), wB));
+	sum = l16Add(sum, l16Mul(l16Pair(src[uvPitch], src[uvPitch + 1]), wC));
+	sum = l16Add(sum, l16Mul(l16Pair(src[uvPitch + 1], src[uvPitch + 2]), wD));
+	return l16Shr4(sum);
+}
+
+/**
+ * Converts the leading part of a row of YUV410 pixels, interpolating the
+ * chroma like DO_INTERPOLATION.
+ *
+ * @return Number of chroma samples converted; the caller converts the rest.
+ */
+template<typename PixelInt>
+static int convertYUV410RowVector(const YUVToRGBVector &vec, byte *dstPtr, const byte *ySrc, const byte *uSrc, const byte *vSrc, int uvPitch, int yDiff, int quarterWidth) {
+	// Weights of the four chroma samples for xDiff 0 to 3, twice
+	int16 weights[4][8];
+	for (int i = 0; i < 8; ++i) {
+		const int xDiff = i & 3;
+		weights[0][i] = (4 - xDiff) * (4 - yDiff);
+		weights[1][i] = xDiff * (4 - yDiff);
+		weights[2][i] = yDiff * (4 - xDiff);
+		weights[3][i] = xDiff * yDiff;
+	}
+
+#if defined(USE_SSE2)
+	const Lanes16 wA = _mm_loadu_si128((const __m128i *)weights[0]);
+	const Lanes16 wB = _mm_loadu_si128((const __m128i *)weights[1]);
+	const Lanes16 wC = _mm_loadu_si128((const __m128i *)weights[2]);
+	const Lanes16 wD = _mm_loadu_si128((const __m128i *)weights[3]);
+#else
+	const Lanes16 wA = vld1q_s16(weights[0]);
+	const Lanes16 wB = vld1q_s16(weights[1]);
+	const Lanes16 wC = vld1q_s16(weights[2]);
+	const Lanes16 wD = vld1q_s16(weights[3]);
+#endif
+
+	int x = 0;
+	for (; x + 2 <= quarterWidth; x += 2) {
+		Lanes16 crR, crbG, cbB;
+		vec.chroma(interpolate(uSrc + x, uvPitch, wA, wB, wC, wD), interpolate(vSrc + x, uvPitch, wA, wB, wC, wD), crR, crbG, cbB);
+		vec.put<PixelInt>((PixelInt *)dstPtr + 4 * x, l16Load8(ySrc + 4 * x), crR, crbG, cbB);
+	}
+	return x;
+}
+
+#else
+
+// Without SIMD support the lookup table loops convert everything
+
+class YUVToRGBVector {
+public:
+	YUVToRGBVector(const YUVToRGBLookup *lookup) {}
+};
+
+template<typename PixelInt>
+static inline int convertYUV444RowVector(const YUVToRGBVector &vec, byte *dstPtr, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth) {
+	return 0;
+}
+
+template<typename PixelInt>
+static inline int convertYUV420RowVector(const YUVToRGBVector &vec, byte *dstPtr, int dstPitch, const byte *ySrc, int yPitch, const byte *uSrc, const byte *vSrc, int halfWidth) {
+	return 0;
+}
+
+template<typename PixelInt>
+static inline int convertYUV410RowVector(const YUVToRGBVector &vec, byte *dstPtr, const byte *ySrc, const byte *uSrc, const byte *vSrc, int uvPitch, int yDiff, int quarterWidth) {
+	return 0;
+}
+
+#endif
 
 #define PUT_PIXEL(s, d) \
 	L = &rgbToPix[(s)]; \
@@ -214,9 +536,16 @@ void convertYUV444ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup
 	const int16 *Cb_g_tab = Cr_g_tab + 256;
 	const int16 *Cb_b_tab = Cb_g_tab + 256;
 	const uint32 *rgbToPix = lookup->getRGBToPix();
+	const YUVToRGBVector vec(lookup);
 
 	for (int h = 0; h < yHeight; h++) {
-		for (int w = 0; w < yWidth; w++) {
+		int w = convertYUV444RowVector<PixelInt>(vec, dstPtr, ySrc, uSrc, vSrc, yWidth);
+		dstPtr += w * sizeof(PixelInt);
+		ySrc += w;
+		uSrc += w;
+		vSrc += w;
+
+		for (; w < yWidth; w++) {
 			const uint32 *L;
 
 			int16 cr_r  = Cr_r_tab[*vSrc];
@@ -263,9 +592,16 @@ void convertYUV420ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup
 	const int16 *Cb_g_tab = Cr_g_tab + 256;
 	const int16 *Cb_b_tab = Cb_g_tab + 256;
 	const uint32 *rgbToPix = lookup->getRGBToPix();
+	const YUVToRGBVector vec(lookup);
 
 	for (int h = 0; h < halfHeight; h++) {
-		for (int w = 0; w < halfWidth; w++) {
+		int w = convertYUV420RowVector<PixelInt>(vec, dstPtr, dstPitch, ySrc, yPitch, uSrc, vSrc, halfWidth);
+		dstPtr += 2 * w * sizeof(PixelInt);
+		ySrc += 2 * w;
+		uSrc += w;
+		vSrc += w;
+
+		for (; w < halfWidth; w++) {
 			const uint32 *L;
 
 			int16 cr_r  = Cr_r_tab[*vSrc];
@@ -405,10 +741,16 @@ void convertYUV410ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup
 	const int16 *Cb_b_tab = Cb_g_tab + 256;
 	const uint32 *rgbToPix = lookup->getRGBToPix();
 
+	const YUVToRGBVector vec(lookup);
+
 	int quarterWidth = yWidth >> 2;
 
 	for (int y = 0; y < yHeight; y++) {
-		for (int x = 0; x < quarterWidth; x++) {
+		int x = convertYUV410RowVector<PixelInt>(vec, dstPtr, ySrc, uSrc + (y >> 2) * uvPitch, vSrc + (y >> 2) * uvPitch, uvPitch, y & 3, quarterWidth);
+		dstPtr += 4 * x * sizeof(PixelInt);
+		ySrc += 4 * x;
+
+		for (; x < quarterWidth; x++) {
 			// Perform bilinear interpolation on the the chroma values
 			// Based on the algorithm found here: http://tech-algorithm.com/articles/bilinear-image-scaling/
 			// Feel free to optimize further
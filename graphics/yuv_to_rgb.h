@@ -38,6 +38,8 @@
 #define GRAPHICS_YUV_TO_RGB_H
 
 #include "common/scummsys.h"
+#include "common/array.h"
+#include "common/mutex.h"
 #include "common/singleton.h"
 #include "graphics/surface.h"
 
@@ -127,9 +129,11 @@ private:
 
 	const YUVToRGBLookup *getLookup(Graphics::PixelFormat format, LuminanceScale scale, bool alphaMode = false);
 
-	YUVToRGBLookup *_lookup;
+	// The lookups are kept until destruction, so that the conversion
+	// functions can be called from several threads at once
+	Common::Array<YUVToRGBLookup *> _lookups;
+	Common::Mutex _lookupMutex;
 	int16 _colorTab[4 * 256]; // 2048 bytes
-	bool _alphaMode;
 };
  /** @} */
 } // End of namespace Graphics
@@ -975,6 +975,10 @@ void ThemeEngine::drawDDText(TextData type, TextColor color, const Common::Rect
 
 	if (!_clip.isEmpty()) {
 		dirty.clip(_clip);
+
+		// Cull the text not in the clip rect
+		if (dirty.isEmpty())
+			return;
 	}
 
 	// HACK: One small pixel should be invisible enough
@@ -44,6 +44,9 @@ enum {
 	kReverbWidthChangedCmd		= 'rwic',
 	kReverbLevelChangedCmd		= 'rlec',
 
+	kPolyphonyChangedCmd		= 'mpoc',
+	kCpuBudgetChangedCmd		= 'mcbc',
+
 	kResetSettingsCmd		= 'rese'
 };
 
@@ -145,6 +148,22 @@ FluidSynthSettingsDialog::FluidSynthSettingsDialog()
 	_miscInterpolationPopUp->appendEntry(_("Fourth-order"), kInterpolation4thOrder);
 	_miscInterpolationPopUp->appendEntry(_("Seventh-order"), kInterpolation7thOrder);
 
+	_miscPolyphonyDesc = new StaticTextWidget(_tabWidget, "FluidSynthSettings_Misc.PolyphonyText", _("Voices:"), _("Maximum number of notes played at once"));
+	_miscPolyphonySlider = new SliderWidget(_tabWidget, "FluidSynthSettings_Misc.PolyphonySlider", Common::U32String(), kPolyphonyChangedCmd);
+	// 16 - 1024, Default: 256
+	_miscPolyphonySlider->setMinValue(16);
+	_miscPolyphonySlider->setMaxValue(1024);
+	_miscPolyphonyLabel = new StaticTextWidget(_tabWidget, "FluidSynthSettings_Misc.PolyphonyLabel", Common::U32String("256"));
+
+	_miscCpuBudgetDesc = new StaticTextWidget(_tabWidget, "FluidSynthSettings_Misc.CpuBudgetText", _("CPU limit:"), _("Share of the CPU time above which fewer notes are played at once. 0 disables the limit"));
+	_miscCpuBudgetSlider = new SliderWidget(_tabWidget, "FluidSynthSettings_Misc.CpuBudgetSlider", Common::U32String(), kCpuBudgetChangedCmd);
+	// 0 - 100, Default: 0
+	_miscCpuBudgetSlider->setMinValue(0);
+	_miscCpuBudgetSlider->setMaxValue(100);
+	_miscCpuBudgetLabel = new StaticTextWidget(_tabWidget, "FluidSynthSettings_Misc.CpuBudgetLabel", Common::U32String("0"));
+
+	_miscDynamicLoadingCheckbox = new CheckboxWidget(_tabWidget, "FluidSynthSettings_Misc.DynamicLoadingCheckbox", _("Load instruments on demand"), _("Only load the samples of the instruments used by the game, to save memory"));
+
 	_tabWidget->setActiveTab(0);
 
 	new ButtonWidget(this, "FluidSynthSettings.ResetSettings", _("Reset"), _("Reset all FluidSynth settings to their default values."), kResetSettingsCmd);
@@ -213,6 +232,14 @@ void FluidSynthSettingsDialog::handleCommand(CommandSender *sender, uint32 cmd,
 		_reverbLevelLabel->setLabel(Common::String::format("%d", _reverbLevelSlider->getValue()));
 		_reverbLevelLabel->markAsDirty();
 		break;
+	case kPolyphonyChangedCmd:
+		_miscPolyphonyLabel->setLabel(Common::String::format("%d", _miscPolyphonySlider->getValue()));
+		_miscPolyphonyLabel->markAsDirty();
+		break;
+	case kCpuBudgetChangedCmd:
+		_miscCpuBudgetLabel->setLabel(Common::String::format("%d", _miscCpuBudgetSlider->getValue()));
+		_miscCpuBudgetLabel->markAsDirty();
+		break;
 	case kResetSettingsCmd: {
 		MessageDialog alert(_("Do you really want to reset all FluidSynth settings to their default values?"), _("Yes"), _("No"));
 		if (alert.runModal() == GUI::kMessageOK) {
@@ -301,6 +328,12 @@ void FluidSynthSettingsDialog::readSettings() {
 		_miscInterpolationPopUp->setSelectedTag(kInterpolation7thOrder);
 	}
 
+	_miscPolyphonySlider->setValue(ConfMan.getInt("fluidsynth_misc_polyphony", _domain));
+	_miscPolyphonyLabel->setLabel(Common::String::format("%d", _miscPolyphonySlider->getValue()));
+	_miscCpuBudgetSlider->setValue(ConfMan.getInt("fluidsynth_misc_cpu_budget", _domain));
+	_miscCpuBudgetLabel->setLabel(Common::String::format("%d", _miscCpuBudgetSlider->getValue()));
+	_miscDynamicLoadingCheckbox->setState(ConfMan.getBool("fluidsynth_misc_dynamic_loading", _domain));
+
 	// This may trigger redrawing, so don't do it until all sliders have
 	// their proper values. Otherwise, the dialog may crash because of
 	// invalid slider values.
@@ -343,6 +376,10 @@ void FluidSynthSettingsDialog::writeSettings() {
 		ConfMan.removeKey("fluidsynth_misc_interpolation", _domain);
 	}
 
+	ConfMan.setInt("fluidsynth_misc_polyphony", _miscPolyphonySlider->getValue(), _domain);
+	ConfMan.setInt("fluidsynth_misc_cpu_budget", _miscCpuBudgetSlider->getValue(), _domain);
+	ConfMan.setBool("fluidsynth_misc_dynamic_loading", _miscDynamicLoadingCheckbox->getState(), _domain);
+
 	// The main options dialog is responsible for writing the config file.
 	// That's why we don't actually flush the settings to the file here.
 }
@@ -362,6 +399,9 @@ void FluidSynthSettingsDialog::resetSettings() {
 	ConfMan.removeKey("fluidsynth_reverb_level", _domain);
 
 	ConfMan.removeKey("fluidsynth_misc_interpolation", _domain);
+	ConfMan.removeKey("fluidsynth_misc_polyphony", _domain);
+	ConfMan.removeKey("fluidsynth_misc_cpu_budget", _domain);
+	ConfMan.removeKey("fluidsynth_misc_dynamic_loading", _domain);
 }
 
 } // End of namespace GUI
@@ -97,6 +97,16 @@ private:
 
 	StaticTextWidget *_miscInterpolationPopUpDesc;
 	PopUpWidget *_miscInterpolationPopUp;
+
+	StaticTextWidget *_miscPolyphonyDesc;
+	SliderWidget *_miscPolyphonySlider;
+	StaticTextWidget *_miscPolyphonyLabel;
+
+	StaticTextWidget *_miscCpuBudgetDesc;
+	SliderWidget *_miscCpuBudgetSlider;
+	StaticTextWidget *_miscCpuBudgetLabel;
+
+	CheckboxWidget *_miscDynamicLoadingCheckbox;
 };
 
 } // End of namespace GUI
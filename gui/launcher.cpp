@@ -162,6 +162,26 @@ bool LauncherFilterMatcher(void *boss, int idx, const Common::U32String &item, C
 	return invert ? !result : result;
 }
 
+bool LauncherFilterRefinement(const Common::U32String &oldToken, const Common::U32String &newToken) {
+	// Inverted tokens match more entries as they get longer
+	if ((oldToken.size() && oldToken[0] == '!') || (newToken.size() && newToken[0] == '!'))
+		return false;
+
+	Common::String old8 = oldToken;
+	Common::String new8 = newToken;
+	size_t oldPos = old8.findFirstOf(":=~");
+	size_t newPos = new8.findFirstOf(":=~");
+	if (oldPos != newPos)
+		return false;
+	if (oldPos == old8.npos)
+		return newToken.contains(oldToken);
+
+	// Only substring matches on the same key narrow down, exact and wildcard ones don't
+	if (old8[oldPos] != ':' || new8[newPos] != ':' || old8.substr(0, oldPos) != new8.substr(0, newPos))
+		return false;
+	return new8.substr(newPos + 1).contains(old8.substr(oldPos + 1));
+}
+
 LauncherDialog::LauncherDialog(const Common::String &dialogName)
 	: Dialog(dialogName), _title(dialogName), _browser(nullptr),
 	_loadDialog(nullptr), _searchClearButton(nullptr), _searchDesc(nullptr),
@@ -1007,7 +1027,7 @@ void LauncherSimple::build() {
 	_list->setEditable(false);
 	_list->enableDictionarySelect(true);
 	_list->setNumberingMode(kListNumberingOff);
-	_list->setFilterMatcher(LauncherFilterMatcher, this);
+	_list->setFilterMatcher(LauncherFilterMatcher, this, LauncherFilterRefinement);
 
 	// Populate the list
 	updateListing();
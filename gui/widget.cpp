@@ -83,6 +83,7 @@ void Widget::updateState(int oldFlags, int newFlags) {
 
 void Widget::markAsDirty() {
 	_needsRedraw = true;
+	_dirtyRect = Common::Rect();
 
 	Widget *w = _firstWidget;
 	while (w) {
@@ -91,6 +92,34 @@ void Widget::markAsDirty() {
 	}
 }
 
+void Widget::markAreaAsDirty(const Common::Rect &r) {
+	if (r.isEmpty())
+		return;
+
+	// A pending full redraw already covers the area
+	if (_needsRedraw && _dirtyRect.isEmpty())
+		return;
+
+	if (_needsRedraw) {
+		_dirtyRect.extend(r);
+	} else {
+		_dirtyRect = r;
+		_needsRedraw = true;
+	}
+
+	// Redrawing our background over the area erases the children in it
+	Common::Rect absRect(r);
+	absRect.translate(getAbsX(), getAbsY());
+
+	Widget *w = _firstWidget;
+	while (w) {
+		Common::Rect childRect(w->getAbsX(), w->getAbsY(), w->getAbsX() + w->getWidth(), w->getAbsY() + w->getHeight());
+		if (childRect.intersects(absRect))
+			w->markAsDirty();
+		w = w->next();
+	}
+}
+
 void Widget::draw() {
 	Common::Rect oldClip;
 	if (!isVisible() || !_boss->isVisible())
@@ -121,8 +150,22 @@ void Widget::draw() {
 			g_gui.theme()->swapClipRect(clip);
 		}
 
+		// Only redraw the damaged area if the widget was partially invalidated.
+		// In RTL mode the widget is mirrored, so we always redraw it entirely.
+		bool partial = !_dirtyRect.isEmpty() && !g_gui.useRTL();
+		bool hidden = false;
+		if (partial) {
+			Common::Rect damaged(_dirtyRect);
+			damaged.translate(_x, _y);
+			damaged = damaged.findIntersectingRect(clip);
+			if (damaged.isEmpty())
+				hidden = true;
+			else
+				g_gui.theme()->swapClipRect(damaged);
+		}
+
 		// Draw border
-		if (_flags & WIDGET_BORDER) {
+		if ((_flags & WIDGET_BORDER) && !hidden) {
 			g_gui.theme()->drawWidgetBackground(Common::Rect(_x, _y, _x + _w, _y + _h),
 			                                    ThemeEngine::kWidgetBackgroundBorder);
 			_x += 4;
@@ -131,12 +174,16 @@ void Widget::draw() {
 			_h -= 8;
 		}
 
-		// Now perform the actual widget draw
-		drawWidget();
+		// Now perform the actual widget draw, unless the damaged area is not visible
+		if (!hidden)
+			drawWidget();
 
+		// Children marked as dirty on their own are not limited to our damaged area
+		if (partial)
+			g_gui.theme()->swapClipRect(clip);
 
 		// Restore x/y
-		if (_flags & WIDGET_BORDER) {
+		if ((_flags & WIDGET_BORDER) && !hidden) {
 			_x -= 4;
 			_y -= 4;
 			_w += 8;
@@ -147,6 +194,7 @@ void Widget::draw() {
 		_y = oldY;
 
 		_needsRedraw = false;
+		_dirtyRect = Common::Rect();
 	}
 
 	// Draw all children
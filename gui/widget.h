@@ -107,6 +107,7 @@ protected:
 private:
 	uint16		_flags;
 	bool		_needsRedraw;
+	Common::Rect	_dirtyRect;	///< Damaged area in widget coordinates, empty if the whole widget needs a redraw
 
 public:
 	static Widget *findWidgetInChain(Widget *start, int x, int y);
@@ -146,6 +147,13 @@ public:
 	/** Mark the widget and its children as dirty so they are redrawn on the next screen update */
 	virtual void markAsDirty();
 
+	/**
+	 * Mark only the given area (in widget coordinates) as dirty, so that the next
+	 * screen update clips the redraw of this widget to it. Children overlapping
+	 * the area are marked as dirty as well.
+	 */
+	void markAreaAsDirty(const Common::Rect &r);
+
 	/** Redraw the widget if it was marked as dirty, and recursively proceed with its children */
 	virtual void draw();
 
@@ -443,39 +443,15 @@ void GroupedListWidget::setFilter(const Common::U32String &filter, bool redraw)
 	if (_filter == filt) // Filter was not changed
 		return;
 
+	Common::U32String oldFilter = _filter;
 	_filter = filt;
 
 	if (_filter.empty()) {
 		// No filter -> display everything
 		sortGroups();
 	} else {
-		// Restrict the list to everything which contains all words in _filter
-		// as substrings, ignoring case.
-
-		Common::U32StringTokenizer tok(_filter);
-		Common::U32String tmp;
-		int n = 0;
-
-		_list.clear();
-		_listIndex.clear();
-
-		for (Common::U32StringArray::iterator i = _dataList.begin(); i != _dataList.end(); ++i, ++n) {
-			tmp = *i;
-			tmp.toLowercase();
-			bool matches = true;
-			tok.reset();
-			while (!tok.empty()) {
-				if (!_filterMatcher(_filterMatcherArg, n, tmp, tok.nextToken())) {
-					matches = false;
-					break;
-				}
-			}
-
-			if (matches) {
-				_list.push_back(*i);
-				_listIndex.push_back(n);
-			}
-		}
+		// Restrict the list to everything which matches all tokens in _filter, ignoring case.
+		filterList(oldFilter);
 	}
 
 	_currentPos = 0;
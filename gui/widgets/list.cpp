@@ -36,6 +36,10 @@ bool ListWidgetDefaultMatcher(void *, int, const Common::U32String &item, Common
 	return item.contains(token);
 }
 
+bool ListWidgetDefaultRefinement(const Common::U32String &oldToken, const Common::U32String &newToken) {
+	return newToken.contains(oldToken);
+}
+
 ListWidget::ListWidget(Dialog *boss, const Common::String &name, const Common::U32String &tooltip, uint32 cmd)
 	: EditableWidget(boss, name, tooltip), _cmd(cmd) {
 
@@ -67,6 +71,7 @@ ListWidget::ListWidget(Dialog *boss, const Common::String &name, const Common::U
 
 	_filterMatcher = ListWidgetDefaultMatcher;
 	_filterMatcherArg = nullptr;
+	_filterRefinement = ListWidgetDefaultRefinement;
 
 	_lastRead = -1;
 
@@ -106,6 +111,7 @@ ListWidget::ListWidget(Dialog *boss, int x, int y, int w, int h, const Common::U
 
 	_filterMatcher = ListWidgetDefaultMatcher;
 	_filterMatcherArg = nullptr;
+	_filterRefinement = ListWidgetDefaultRefinement;
 
 	_lastRead = -1;
 
@@ -259,14 +265,17 @@ void ListWidget::handleMouseDown(int x, int y, int button, int clickCount) {
 	if (_selectedItem != newSelectedItem && newSelectedItem != -1) {
 		if (_editMode)
 			abortEditMode();
+
+		// Only the previously and the newly selected rows need to be redrawn
+		markItemAsDirty(_selectedItem);
 		_selectedItem = newSelectedItem;
+		markItemAsDirty(_selectedItem);
 		sendCommand(kListSelectionChangedCmd, _selectedItem);
 	}
 
 	// TODO: Determine where inside the string the user clicked and place the
 	// caret accordingly.
 	// See _editScrollOffset and EditTextWidget::handleMouseDown.
-	markAsDirty();
 
 }
 
@@ -338,6 +347,7 @@ bool ListWidget::handleKeyDown(Common::KeyState state) {
 	bool handled = true;
 	bool dirty = false;
 	int oldSelectedItem = _selectedItem;
+	int oldPos = _currentPos;
 
 	if (!_editMode && state.keycode <= Common::KEYCODE_z && Common::isPrint(state.ascii)) {
 		// Quick selection mode: Go to first list item starting with this key
@@ -489,8 +499,13 @@ bool ListWidget::handleKeyDown(Common::KeyState state) {
 		scrollToCurrent();
 	}
 
-	if (dirty || _selectedItem != oldSelectedItem)
+	if (dirty || (_selectedItem != oldSelectedItem && _currentPos != oldPos)) {
 		markAsDirty();
+	} else if (_selectedItem != oldSelectedItem) {
+		// The list did not scroll, so only the two affected rows need to be redrawn
+		markItemAsDirty(oldSelectedItem);
+		markItemAsDirty(_selectedItem);
+	}
 
 	if (_selectedItem != oldSelectedItem) {
 		sendCommand(kListSelectionChangedCmd, _selectedItem);
@@ -617,6 +632,17 @@ void ListWidget::drawWidget() {
 	}
 }
 
+void ListWidget::markItemAsDirty(int item) {
+	if (item < _currentPos || item >= _currentPos + _entriesPerPage)
+		return;
+
+	const int scrollbarW = (_scrollBar && _scrollBar->isVisible()) ? _scrollBarWidth : 0;
+	const int y = _topPadding + kLineHeight * (item - _currentPos);
+
+	// The selection background may slightly overlap the neighbouring rows
+	markAreaAsDirty(Common::Rect(0, y - 2, _w - scrollbarW, y + kLineHeight + 2));
+}
+
 Common::Rect ListWidget::getEditRect() const {
 	const int scrollbarW = (_scrollBar && _scrollBar->isVisible()) ? _scrollBarWidth : 0;
 	int editWidth = _w - _hlLeftPadding - _hlRightPadding - scrollbarW;
@@ -759,6 +785,7 @@ void ListWidget::setFilter(const Common::U32String &filter, bool redraw) {
 	if (_filter == filt) // Filter was not changed
 		return;
 
+	Common::U32String oldFilter = _filter;
 	_filter = filt;
 
 	if (_filter.empty()) {
@@ -767,31 +794,7 @@ void ListWidget::setFilter(const Common::U32String &filter, bool redraw) {
 		_listIndex.clear();
 	} else {
 		// Restrict the list to everything which matches all tokens in _filter, ignoring case.
-
-		Common::U32StringTokenizer tok(_filter);
-		Common::U32String tmp;
-		int n = 0;
-
-		_list.clear();
-		_listIndex.clear();
-
-		for (Common::U32StringArray::iterator i = _dataList.begin(); i != _dataList.end(); ++i, ++n) {
-			tmp = *i;
-			tmp.toLowercase();
-			bool matches = true;
-			tok.reset();
-			while (!tok.empty()) {
-				if (!_filterMatcher(_filterMatcherArg, n, tmp, tok.nextToken())) {
-					matches = false;
-					break;
-				}
-			}
-
-			if (matches) {
-				_list.push_back(*i);
-				_listIndex.push_back(n);
-			}
-		}
+		filterList(oldFilter);
 	}
 
 	_currentPos = 0;
@@ -814,4 +817,74 @@ void ListWidget::setFilter(const Common::U32String &filter, bool redraw) {
 	}
 }
 
+static void tokenizeFilter(const Common::U32String &filter, Common::U32StringArray &tokens) {
+	Common::U32StringTokenizer tok(filter);
+	while (!tok.empty())
+		tokens.push_back(tok.nextToken());
+}
+
+bool ListWidget::isFilterRefinement(const Common::U32String &oldFilter, const Common::U32String &newFilter) const {
+	Common::U32StringArray oldTokens, newTokens;
+	tokenizeFilter(oldFilter, oldTokens);
+	tokenizeFilter(newFilter, newTokens);
+
+	if (oldTokens.empty() || oldTokens.size() > newTokens.size())
+		return false;
+
+	// Entries have to match all tokens, so adding tokens can only remove entries
+	for (uint i = 0; i < oldTokens.size() - 1; ++i) {
+		if (oldTokens[i] != newTokens[i])
+			return false;
+	}
+
+	const Common::U32String &lastOld = oldTokens.back();
+	const Common::U32String &lastNew = newTokens[oldTokens.size() - 1];
+	if (lastOld == lastNew)
+		return true;
+
+	// Only the matcher knows whether the changed token matches fewer entries
+	return _filterRefinement && _filterRefinement(lastOld, lastNew);
+}
+
+void ListWidget::filterList(const Common::U32String &oldFilter) {
+	Common::U32StringArray tokens;
+	tokenizeFilter(_filter, tokens);
+
+	// When the user keeps typing in the search box, the new filter usually
+	// narrows down the old one. In that case only the entries that are
+	// currently shown need to be checked again.
+	Common::Array<int> candidates;
+	const bool narrow = !oldFilter.empty() && isFilterRefinement(oldFilter, _filter);
+	if (narrow)
+		candidates = _listIndex;
+
+	const int count = narrow ? (int)candidates.size() : (int)_dataList.size();
+	Common::U32String tmp;
+
+	_list.clear();
+	_listIndex.clear();
+
+	for (int i = 0; i < count; ++i) {
+		const int n = narrow ? candidates[i] : i;
+		if (n < 0)
+			continue;
+
+		tmp = _dataList[n];
+		tmp.toLowercase();
+
+		bool matches = true;
+		for (uint t = 0; t < tokens.size(); ++t) {
+			if (!_filterMatcher(_filterMatcherArg, n, tmp, tokens[t])) {
+				matches = false;
+				break;
+			}
+		}
+
+		if (matches) {
+			_list.push_back(_dataList[n]);
+			_listIndex.push_back(n);
+		}
+	}
+}
+
 } // End of namespace GUI
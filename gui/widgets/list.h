@@ -31,6 +31,9 @@ namespace GUI {
 
 class ScrollBarWidget;
 
+bool ListWidgetDefaultMatcher(void *arg, int idx, const Common::U32String &item, Common::U32String token);
+bool ListWidgetDefaultRefinement(const Common::U32String &oldToken, const Common::U32String &newToken);
+
 enum NumberingMode {
 	kListNumberingOff	= -1,
 	kListNumberingZero	= 0,
@@ -51,6 +54,8 @@ public:
 	typedef Common::Array<ThemeEngine::FontColor> ColorList;
 
 	typedef bool (*FilterMatcher)(void *arg, int idx, const Common::U32String &item, Common::U32String token);
+	/// Returns true if all entries matched by newToken are also matched by oldToken.
+	typedef bool (*FilterRefinement)(const Common::U32String &oldToken, const Common::U32String &newToken);
 protected:
 	Common::U32StringArray	_list;
 	Common::U32StringArray	_dataList;
@@ -88,6 +93,7 @@ protected:
 
 	FilterMatcher	_filterMatcher;
 	void			*_filterMatcherArg;
+	FilterRefinement	_filterRefinement;
 
 public:
 	ListWidget(Dialog *boss, const Common::String &name, const Common::U32String &tooltip = Common::U32String(), uint32 cmd = 0);
@@ -121,7 +127,12 @@ public:
 	bool isEditable() const						{ return _editable; }
 	void setEditable(bool editable)				{ _editable = editable; }
 	void setEditColor(ThemeEngine::FontColor color) { _editColor = color; }
-	void setFilterMatcher(FilterMatcher matcher, void *arg) { _filterMatcher = matcher; _filterMatcherArg = arg; }
+	/**
+	 * Set the function matching entries with the filter tokens. If a refinement
+	 * function is given, it tells when a token narrows down the matches of the
+	 * previous one, so that only the listed entries are checked again.
+	 */
+	void setFilterMatcher(FilterMatcher matcher, void *arg, FilterRefinement refinement = nullptr) { _filterMatcher = matcher; _filterMatcherArg = arg; _filterRefinement = refinement; }
 
 	// Made startEditMode/endEditMode for SaveLoadChooser
 	void startEditMode() override;
@@ -148,6 +159,8 @@ protected:
 
 	/// Finds the item at position (x,y). Returns -1 if there is no item there.
 	int findItem(int x, int y) const;
+	/// Schedules a redraw of the row showing the given item, if it is visible.
+	void markItemAsDirty(int item);
 	void scrollBarRecalc();
 
 	void abortEditMode() override;
@@ -158,6 +171,14 @@ protected:
 	void lostFocusWidget() override;
 	void checkBounds();
 	void scrollToCurrent();
+
+	/// Returns true if all entries matching newFilter are known to also match oldFilter.
+	bool isFilterRefinement(const Common::U32String &oldFilter, const Common::U32String &newFilter) const;
+	/**
+	 * Fills _list and _listIndex with the entries of _dataList matching _filter.
+	 * If _filter refines oldFilter, only the entries currently listed are checked.
+	 */
+	void filterList(const Common::U32String &oldFilter);
 };
 
 } // End of namespace GUI
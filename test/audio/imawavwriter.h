@@ -0,0 +1,98 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/imawavwriter.h"
+#include "audio/audiostream.h"
+#include "audio/decoders/wave.h"
+
+#include "common/memstream.h"
+
+#include "helper.h"
+
+class IMAWAVWriterTestSuite : public CxxTest::TestSuite
+{
+private:
+	void encodeTestTemplate(const int sampleRate, const int time, const bool isStereo, const uint32 chunk) {
+		int16 *sine;
+		Audio::SeekableAudioStream *s = createSineStream<int16>(sampleRate, time, &sine, false, isStereo);
+		delete s;
+
+		// Feed the samples in chunks which don't match the blocks
+		const uint32 totalSamples = sampleRate * time * (isStereo ? 2 : 1);
+		Common::MemoryWriteStreamDynamic file(DisposeAfterUse::NO);
+		Audio::IMAWAVWriter writer(&file, sampleRate, isStereo);
+		for (uint32 i = 0; i < totalSamples; i += chunk)
+			writer.write(sine + i, MIN(chunk, totalSamples - i));
+		TS_ASSERT(writer.finish());
+
+		// A quarter of the size of the samples, plus the headers
+		TS_ASSERT_LESS_THAN(file.size(), (int64)totalSamples / 2 + 4096);
+
+		Common::SeekableReadStream *wav = new Common::MemoryReadStream(file.getData(), file.size(), DisposeAfterUse::YES);
+		Audio::SeekableAudioStream *decoded = Audio::makeWAVStream(wav, DisposeAfterUse::YES);
+		TS_ASSERT(decoded);
+		if (!decoded) {
+			delete[] sine;
+			return;
+		}
+
+		TS_ASSERT_EQUALS(decoded->getRate(), sampleRate);
+		TS_ASSERT_EQUALS(decoded->isStereo(), isStereo);
+
+		int16 *buffer = new int16[totalSamples + 4096];
+		const int read = decoded->readBuffer(buffer, totalSamples + 4096);
+		TS_ASSERT_LESS_THAN_EQUALS((int)totalSamples, read);
+
+		// The sine is slow enough for the steps to follow it closely
+		int32 maxError = 0;
+		for (uint32 i = 0; i < totalSamples; i++)
+			maxError = MAX<int32>(maxError, ABS(buffer[i] - sine[i]));
+		TS_ASSERT_LESS_THAN(maxError, 64);
+
+		delete[] sine;
+		delete[] buffer;
+		delete decoded;
+	}
+
+public:
+	void test_encode_mono() {
+		encodeTestTemplate(11025, 2, false, 1000);
+	}
+
+	void test_encode_stereo() {
+		encodeTestTemplate(22050, 2, true, 3000);
+	}
+
+	void test_loop() {
+		int16 samples[4000];
+		memset(samples, 0, sizeof(samples));
+
+		Common::MemoryWriteStreamDynamic file(DisposeAfterUse::NO);
+		Audio::IMAWAVWriter writer(&file, 22050, true);
+		writer.write(samples, ARRAYSIZE(samples));
+		writer.setLoop(100, 1500, 0);
+		TS_ASSERT(writer.finish());
+
+		Common::MemoryReadStream wav(file.getData(), file.size(), DisposeAfterUse::YES);
+		TS_ASSERT_EQUALS(wav.readUint32BE(), MKTAG('R', 'I', 'F', 'F'));
+		TS_ASSERT_EQUALS(wav.readUint32LE(), (uint32)wav.size() - 8);
+
+		// The loop follows the data, its end is the last frame played
+		wav.seek(-68, SEEK_END);
+		TS_ASSERT_EQUALS(wav.readUint32BE(), MKTAG('s', 'm', 'p', 'l'));
+		TS_ASSERT_EQUALS(wav.readUint32LE(), 60U);
+		wav.skip(28);
+		TS_ASSERT_EQUALS(wav.readUint32LE(), 1U);
+		wav.skip(12);
+		TS_ASSERT_EQUALS(wav.readUint32LE(), 100U);
+		TS_ASSERT_EQUALS(wav.readUint32LE(), 1499U);
+		wav.skip(4);
+		TS_ASSERT_EQUALS(wav.readUint32LE(), 0U);
+
+		// Decoders stop at the end of the data chunk
+		wav.seek(0);
+		int size, rate;
+		byte flags;
+		TS_ASSERT(Audio::loadWAVFromStream(wav, size, rate, flags));
+		TS_ASSERT_EQUALS(size, wav.size() - 68 - 48);
+	}
+};
@@ -0,0 +1,102 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/audiostream.h"
+#include "audio/soundcache.h"
+#include "common/system.h"
+
+#include "helper.h"
+#include "../null_osystem.h"
+
+// The cached sounds use a mutex, which needs an OSystem
+#if NULL_OSYSTEM_IS_AVAILABLE
+#define TEST_SOUNDCACHE 1
+#else
+#define TEST_SOUNDCACHE 0
+#endif
+
+class SoundCacheTestSuite : public CxxTest::TestSuite
+{
+public:
+	void test_cached_stream_matches_source() {
+#if TEST_SOUNDCACHE
+		if (!g_system)
+			Common::install_null_g_system();
+
+		int16 *sine;
+		Audio::SeekableAudioStream *s = createSineStream<int16>(11025, 1, &sine, true, true);
+
+		Audio::SoundCache cache(1024 * 1024);
+		TS_ASSERT(!cache.contains("sine"));
+		TS_ASSERT(!cache.makeStream("sine"));
+
+		Audio::SeekableAudioStream *first = cache.cacheStream("sine", s);
+		TS_ASSERT(cache.contains("sine"));
+		TS_ASSERT_EQUALS(cache.getUsedBytes(), 11025u * 2 * sizeof(int16));
+
+		// Streams made later play the same samples, from their own position
+		Audio::SeekableAudioStream *second = cache.makeStream("sine");
+		TS_ASSERT(second);
+
+		const int totalSamples = 11025 * 2;
+		int16 *buffer = new int16[totalSamples];
+
+		for (int i = 0; i < 2; ++i) {
+			Audio::SeekableAudioStream *stream = i ? second : first;
+			TS_ASSERT_EQUALS(stream->isStereo(), true);
+			TS_ASSERT_EQUALS(stream->getRate(), 11025);
+			TS_ASSERT_EQUALS(stream->getLength().totalNumberOfFrames(), 11025);
+			TS_ASSERT_EQUALS(stream->readBuffer(buffer, totalSamples), totalSamples);
+			TS_ASSERT_EQUALS(memcmp(sine, buffer, sizeof(int16) * totalSamples), 0);
+			TS_ASSERT_EQUALS(stream->endOfData(), true);
+		}
+
+		// Seeking is by sample frame
+		TS_ASSERT(second->seek(Audio::Timestamp(0, 500, 11025)));
+		TS_ASSERT_EQUALS(second->readBuffer(buffer, 2), 2);
+		TS_ASSERT_EQUALS(memcmp(sine + 500 * 2, buffer, sizeof(int16) * 2), 0);
+
+		// Streams outlive the cache
+		cache.clear();
+		TS_ASSERT(!cache.contains("sine"));
+		TS_ASSERT_EQUALS(cache.getUsedBytes(), 0u);
+		TS_ASSERT(first->rewind());
+		TS_ASSERT_EQUALS(first->readBuffer(buffer, totalSamples), totalSamples);
+		TS_ASSERT_EQUALS(memcmp(sine, buffer, sizeof(int16) * totalSamples), 0);
+
+		delete first;
+		delete second;
+		delete[] buffer;
+		delete[] sine;
+#endif
+	}
+
+	void test_eviction() {
+#if TEST_SOUNDCACHE
+		if (!g_system)
+			Common::install_null_g_system();
+
+		// Room for two sounds of one second of 8kHz mono
+		Audio::SoundCache cache(2 * 8000 * sizeof(int16));
+
+		delete cache.cacheStream("a", createSineStream<int16>(8000, 1, 0, true, false));
+		delete cache.cacheStream("b", createSineStream<int16>(8000, 1, 0, true, false));
+		TS_ASSERT(cache.contains("a"));
+		TS_ASSERT(cache.contains("b"));
+
+		// Using "a" makes "b" the least recently used one
+		delete cache.makeStream("a");
+		delete cache.cacheStream("c", createSineStream<int16>(8000, 1, 0, true, false));
+		TS_ASSERT(cache.contains("a"));
+		TS_ASSERT(!cache.contains("b"));
+		TS_ASSERT(cache.contains("c"));
+		TS_ASSERT_EQUALS(cache.getUsedBytes(), 2u * 8000 * sizeof(int16));
+
+		// Sounds larger than the budget are returned uncached
+		Audio::SeekableAudioStream *large = createSineStream<int16>(8000, 3, 0, true, false);
+		TS_ASSERT_EQUALS(cache.cacheStream("large", large), large);
+		TS_ASSERT(!cache.contains("large"));
+		TS_ASSERT(cache.contains("a"));
+		delete large;
+#endif
+	}
+};
@@ -0,0 +1,130 @@
+// Replaces the global allocation functions to count the allocations of
+// the whole benchmark runner. This must be done in one translation unit
+// only, so it is kept out of the benchmark headers.
+//
+// Allocations made with malloc() directly are not counted.
+
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
+#include "common/scummsys.h"
+
+#include <new>
+#include <stdlib.h>
+#ifdef WIN32
+#include <malloc.h>
+#endif
+
+namespace Benchmark {
+uint32 allocationCount = 0;
+}
+
+static void *countedAlloc(size_t size) {
+	Benchmark::allocationCount++;
+	return malloc(size ? size : 1);
+}
+
+void *operator new(size_t size) {
+	return countedAlloc(size);
+}
+
+void *operator new[](size_t size) {
+	return countedAlloc(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+	return countedAlloc(size);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept {
+	return countedAlloc(size);
+}
+
+void operator delete(void *ptr) noexcept {
+	free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+	free(ptr);
+}
+
+void operator delete(void *ptr, const std::nothrow_t &) noexcept {
+	free(ptr);
+}
+
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept {
+	free(ptr);
+}
+
+#ifdef __cpp_sized_deallocation
+void operator delete(void *ptr, size_t) noexcept {
+	free(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept {
+	free(ptr);
+}
+#endif
+
+#ifdef __cpp_aligned_new
+static void *countedAlignedAlloc(size_t size, std::align_val_t alignment) {
+	Benchmark::allocationCount++;
+	if (!size)
+		size = 1;
+#ifdef WIN32
+	return _aligned_malloc(size, (size_t)alignment);
+#else
+	void *ptr;
+	if (posix_memalign(&ptr, (size_t)alignment < sizeof(void *) ? sizeof(void *) : (size_t)alignment, size))
+		return nullptr;
+	return ptr;
+#endif
+}
+
+static void alignedFree(void *ptr) {
+#ifdef WIN32
+	_aligned_free(ptr);
+#else
+	free(ptr);
+#endif
+}
+
+void *operator new(size_t size, std::align_val_t alignment) {
+	return countedAlignedAlloc(size, alignment);
+}
+
+void *operator new[](size_t size, std::align_val_t alignment) {
+	return countedAlignedAlloc(size, alignment);
+}
+
+void *operator new(size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+	return countedAlignedAlloc(size, alignment);
+}
+
+void *operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+	return countedAlignedAlloc(size, alignment);
+}
+
+void operator delete(void *ptr, std::align_val_t) noexcept {
+	alignedFree(ptr);
+}
+
+void operator delete[](void *ptr, std::align_val_t) noexcept {
+	alignedFree(ptr);
+}
+
+void operator delete(void *ptr, std::align_val_t, const std::nothrow_t &) noexcept {
+	alignedFree(ptr);
+}
+
+void operator delete[](void *ptr, std::align_val_t, const std::nothrow_t &) noexcept {
+	alignedFree(ptr);
+}
+
+void operator delete(void *ptr, size_t, std::align_val_t) noexcept {
+	alignedFree(ptr);
+}
+
+void operator delete[](void *ptr, size_t, std::align_val_t) noexcept {
+	alignedFree(ptr);
+}
+#endif
@@ -0,0 +1,219 @@
+#include <cxxtest/TestSuite.h>
+
+#include "helper.h"
+
+#include "common/fs.h"
+#include "common/memstream.h"
+#include "common/random.h"
+#include "common/stream.h"
+#include "audio/audiostream.h"
+#include "audio/decoders/adpcm.h"
+#include "audio/decoders/asf.h"
+#include "audio/decoders/flac.h"
+#include "audio/decoders/g711.h"
+#include "audio/decoders/mp3.h"
+#include "audio/decoders/quicktime.h"
+#include "audio/decoders/raw.h"
+#include "audio/decoders/vorbis.h"
+#include "audio/decoders/wave.h"
+
+class AudioDecodersBenchmarkSuite : public CxxTest::TestSuite {
+public:
+#if BENCHMARK_IS_AVAILABLE
+	/**
+	 * Decodes the whole stream the given number of times, rewinding it in
+	 * between, and reports the throughput and the allocation rate.
+	 */
+	static void decodeStream(const Common::String &name, Audio::RewindableAudioStream *stream, int passes) {
+		if (!stream) {
+			Benchmark::report("AudioDecoders", name, "failed to create the stream");
+			return;
+		}
+
+		// A multiple of the channel count and of DK3's four samples
+		int16 buffer[4096];
+		uint64 samples = 0;
+
+		const uint32 allocations = Benchmark::allocationCount;
+		Benchmark::Timer timer;
+
+		for (int pass = 0; pass < passes; ++pass) {
+			stream->rewind();
+
+			while (!stream->endOfData()) {
+				const int read = stream->readBuffer(buffer, ARRAYSIZE(buffer));
+				if (read <= 0)
+					break;
+
+				samples += read;
+			}
+		}
+
+		const uint32 ms = timer.elapsed();
+		const uint32 allocated = Benchmark::allocationCount - allocations;
+
+		// Samples are counted per channel, the rate is per sample frame
+		const uint32 perSecond = stream->getRate() * (stream->isStereo() ? 2 : 1);
+		const uint32 audioMs = MAX<uint32>(samples * 1000 / perSecond, 1);
+
+		Benchmark::report("AudioDecoders", name,
+		                  Common::String::format("%u ksamples/s, %ux realtime, %u allocations per decoded second",
+		                                         (uint32)(samples / ms), audioMs / ms, (uint32)((uint64)allocated * 1000 / audioMs)));
+
+		delete stream;
+	}
+
+	/** Fills the block headers of synthetic ADPCM data with valid values. */
+	static void writeADPCMHeaders(byte *data, uint32 size, Audio::ADPCMType type, int rate, int channels, uint32 blockAlign, Common::RandomSource &rnd) {
+		for (uint32 block = 0; block + blockAlign <= size; block += blockAlign) {
+			byte *header = data + block;
+
+			switch (type) {
+			case Audio::kADPCMMSIma:
+				// Predictor and step index per channel
+				for (int i = 0; i < channels; ++i)
+					WRITE_LE_UINT16(header + i * 4 + 2, rnd.getRandomNumber(88));
+				break;
+			case Audio::kADPCMMS:
+				// Predictor index, then the deltas
+				for (int i = 0; i < channels; ++i)
+					header[i] = rnd.getRandomNumber(6);
+				for (int i = 0; i < channels; ++i)
+					WRITE_LE_UINT16(header + channels + i * 2, 16 + rnd.getRandomNumber(1024));
+				break;
+			case Audio::kADPCMDK3:
+				WRITE_LE_UINT16(header + 2, rate);
+				header[14] = rnd.getRandomNumber(88);
+				header[15] = rnd.getRandomNumber(88);
+				break;
+			case Audio::kADPCMXA:
+				// Filter and shift of each sound unit
+				for (int i = 4; i < 12; ++i)
+					header[i] = (rnd.getRandomNumber(4) << 4) | rnd.getRandomNumber(12);
+				break;
+			default:
+				break;
+			}
+		}
+	}
+#endif
+
+	void test_synthetic() {
+#if BENCHMARK_IS_AVAILABLE
+		Benchmark::init();
+
+		Common::RandomSource rnd("audio_decoders_benchmark");
+		rnd.setSeed(1);
+
+		// About 45 seconds of 4-bit stereo audio at 22kHz
+		const uint32 size = 1024 * 1024;
+		const int rate = 22050;
+		const int passes = 16;
+
+		struct ADPCMFormat {
+			const char *name;
+			Audio::ADPCMType type;
+			int channels;
+			uint32 blockAlign;
+		};
+
+		const ADPCMFormat adpcmFormats[] = {
+			{ "ADPCM Oki mono",       Audio::kADPCMOki,   1, 0 },
+			{ "ADPCM DVI stereo",     Audio::kADPCMDVI,   2, 0 },
+			{ "ADPCM Apple stereo",   Audio::kADPCMApple, 2, 34 },
+			{ "ADPCM MS IMA stereo",  Audio::kADPCMMSIma, 2, 2048 },
+			{ "ADPCM MS stereo",      Audio::kADPCMMS,    2, 2048 },
+			{ "ADPCM DK3 stereo",     Audio::kADPCMDK3,   2, 1024 },
+			{ "ADPCM XA stereo",      Audio::kADPCMXA,    2, 128 }
+		};
+
+		for (uint f = 0; f < ARRAYSIZE(adpcmFormats); ++f) {
+			const ADPCMFormat &format = adpcmFormats[f];
+
+			byte *data = (byte *)malloc(size);
+			for (uint32 i = 0; i < size; ++i)
+				data[i] = rnd.getRandomNumber(255);
+			if (format.blockAlign)
+				writeADPCMHeaders(data, size, format.type, rate, format.channels, format.blockAlign, rnd);
+
+			Common::SeekableReadStream *stream = new Common::MemoryReadStream(data, size, DisposeAfterUse::YES);
+			decodeStream(format.name, Audio::makeADPCMStream(stream, DisposeAfterUse::YES, size, format.type, rate, format.channels, format.blockAlign), passes);
+		}
+
+		// The 8-bit codecs and raw PCM as the baseline
+		for (int codec = 0; codec < 3; ++codec) {
+			byte *data = (byte *)malloc(size);
+			for (uint32 i = 0; i < size; ++i)
+				data[i] = rnd.getRandomNumber(255);
+
+			Common::SeekableReadStream *stream = new Common::MemoryReadStream(data, size, DisposeAfterUse::YES);
+
+			if (codec == 0)
+				decodeStream("G.711 A-law stereo", Audio::makeALawStream(stream, DisposeAfterUse::YES, rate, 2), passes);
+			else if (codec == 1)
+				decodeStream("G.711 mu-law stereo", Audio::makeMuLawStream(stream, DisposeAfterUse::YES, rate, 2), passes);
+			else
+				decodeStream("Raw 16-bit stereo", Audio::makeRawStream(stream, rate, Audio::FLAG_16BITS | Audio::FLAG_LITTLE_ENDIAN | Audio::FLAG_STEREO, DisposeAfterUse::YES), passes);
+		}
+#endif
+	}
+
+	void test_sampleFiles() {
+#if BENCHMARK_IS_AVAILABLE
+		Benchmark::init();
+
+		// MP3, Vorbis, FLAC, WMA, QDM2 and AAC need real encoded data, so
+		// they are only measured with the sample files someone drops into
+		// test/benchmarks/data.
+		Common::FSNode dir(Benchmark::sourcePath("test/benchmarks/data"));
+		Common::FSList files;
+		if (!dir.getChildren(files, Common::FSNode::kListFilesOnly))
+			files.clear();
+
+		uint decoded = 0;
+		for (Common::FSList::const_iterator file = files.begin(); file != files.end(); ++file) {
+			const Common::String name = file->getName();
+			Common::String label = name;
+			Common::SeekableReadStream *stream = 0;
+			Audio::RewindableAudioStream *audio = 0;
+
+#ifdef USE_MAD
+			if (name.hasSuffixIgnoreCase(".mp3") && (stream = file->createReadStream()))
+				audio = Audio::makeMP3Stream(stream, DisposeAfterUse::YES);
+#endif
+#ifdef USE_VORBIS
+			if (name.hasSuffixIgnoreCase(".ogg") && (stream = file->createReadStream())) {
+				audio = Audio::makeVorbisStream(stream, DisposeAfterUse::YES);
+
+				// Either the floating point libvorbis or the integer-only
+				// Tremor, see --enable-fixed-point-decoders
+#ifdef USE_TREMOR
+				label += " (Tremor)";
+#else
+				label += " (libvorbis)";
+#endif
+			}
+#endif
+#ifdef USE_FLAC
+			if (name.hasSuffixIgnoreCase(".flac") && (stream = file->createReadStream()))
+				audio = Audio::makeFLACStream(stream, DisposeAfterUse::YES);
+#endif
+			if (name.hasSuffixIgnoreCase(".wav") && (stream = file->createReadStream()))
+				audio = Audio::makeWAVStream(stream, DisposeAfterUse::YES);
+			else if ((name.hasSuffixIgnoreCase(".wma") || name.hasSuffixIgnoreCase(".asf")) && (stream = file->createReadStream()))
+				audio = Audio::makeASFStream(stream, DisposeAfterUse::YES);
+			else if ((name.hasSuffixIgnoreCase(".mov") || name.hasSuffixIgnoreCase(".m4a")) && (stream = file->createReadStream()))
+				audio = Audio::makeQuickTimeStream(stream, DisposeAfterUse::YES);
+
+			if (!stream)
+				continue;
+
+			decodeStream(label, audio, 1);
+			decoded++;
+		}
+
+		if (!decoded)
+			Benchmark::report("AudioDecoders", "sampleFiles", "no sample files in test/benchmarks/data");
+#endif
+	}
+};
@@ -0,0 +1,50 @@
+#include <cxxtest/TestSuite.h>
+
+#include "helper.h"
+
+#include "common/fs.h"
+#include "common/stream.h"
+#include "common/system.h"
+#include "video/bink_decoder.h"
+
+class BinkBenchmarkSuite : public CxxTest::TestSuite {
+public:
+	void test_decodeFrames() {
+#if BENCHMARK_IS_AVAILABLE && defined(USE_BINK)
+		Benchmark::init();
+
+		// There is no freely distributable Bink video, so this only runs
+		// on the sample files someone drops into test/benchmarks/data.
+		Common::FSNode dir(Benchmark::sourcePath("test/benchmarks/data"));
+		Common::FSList files;
+		if (!dir.getChildren(files, Common::FSNode::kListFilesOnly))
+			files.clear();
+
+		uint decoded = 0;
+		for (Common::FSList::const_iterator file = files.begin(); file != files.end(); ++file) {
+			if (!file->getName().hasSuffixIgnoreCase(".bik"))
+				continue;
+
+			Video::BinkDecoder decoder;
+			if (!decoder.loadStream(file->createReadStream())) {
+				Benchmark::report("Bink", file->getName(), "failed to load");
+				continue;
+			}
+
+			uint frames = 0;
+			Benchmark::Timer timer;
+			while (!decoder.endOfVideo() && decoder.decodeNextFrame())
+				frames++;
+			const uint32 ms = MAX<uint32>(timer.elapsed(), 1);
+
+			Benchmark::report("Bink", Common::String::format("%s %dx%d", file->getName().c_str(), decoder.getWidth(), decoder.getHeight()),
+			                  Common::String::format("%u frames/s, %u us/frame, %u threads",
+			                                         frames * 1000 / ms, frames ? ms * 1000 / frames : 0, g_system->getCPUCount()));
+			decoded++;
+		}
+
+		if (!decoded)
+			Benchmark::report("Bink", "decodeFrames", "no sample files in test/benchmarks/data");
+#endif
+	}
+};
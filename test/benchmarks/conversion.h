@@ -0,0 +1,85 @@
+#include <cxxtest/TestSuite.h>
+
+#include "helper.h"
+
+#include "common/random.h"
+#include "graphics/conversion.h"
+#include "graphics/surface.h"
+
+class ConversionBenchmarkSuite : public CxxTest::TestSuite {
+public:
+	void test_crossBlit() {
+#if BENCHMARK_IS_AVAILABLE
+		Benchmark::init();
+
+		const Graphics::PixelFormat rgb565(2, 5, 6, 5, 0, 11, 5, 0, 0);
+		const Graphics::PixelFormat xrgb8888(4, 8, 8, 8, 0, 16, 8, 0, 0);
+		const Graphics::PixelFormat argb8888(4, 8, 8, 8, 8, 16, 8, 0, 24);
+		const Graphics::PixelFormat abgr8888(4, 8, 8, 8, 8, 0, 8, 16, 24);
+		const Graphics::PixelFormat rgba8888(4, 8, 8, 8, 8, 24, 16, 8, 0);
+
+		const struct {
+			const char *name;
+			Graphics::PixelFormat src, dst;
+		} pairs[] = {
+			{ "RGB565 -> XRGB8888", rgb565, xrgb8888 },
+			{ "XRGB8888 -> RGB565", xrgb8888, rgb565 },
+			{ "ARGB8888 -> ABGR8888", argb8888, abgr8888 },
+			{ "ARGB8888 -> RGBA8888", argb8888, rgba8888 },
+			{ "RGBA8888 -> RGB565", rgba8888, rgb565 }
+		};
+
+		const int w = 640, h = 480, iterations = 100;
+		Common::RandomSource rnd("benchmark");
+
+		for (uint p = 0; p < ARRAYSIZE(pairs); ++p) {
+			Graphics::Surface src, dst;
+			src.create(w, h, pairs[p].src);
+			dst.create(w, h, pairs[p].dst);
+			for (int y = 0; y < h; ++y)
+				for (int x = 0; x < w; ++x)
+					src.setPixel(x, y, rnd.getRandomNumber(0xFFFFFFFF));
+
+			Benchmark::Timer timer;
+			for (int i = 0; i < iterations; ++i)
+				Graphics::crossBlit((byte *)dst.getPixels(), (const byte *)src.getPixels(), dst.pitch, src.pitch, w, h, dst.format, src.format);
+			const uint32 ms = MAX<uint32>(timer.elapsed(), 1);
+
+			Benchmark::report("Conversion", Common::String::format("crossBlit %s", pairs[p].name),
+			                  Common::String::format("%u Mpix/s", (uint32)((uint64)iterations * w * h / ms / 1000)));
+
+			src.free();
+			dst.free();
+		}
+
+		// Palette lookups
+		byte palette[256 * 3];
+		for (uint i = 0; i < ARRAYSIZE(palette); ++i)
+			palette[i] = rnd.getRandomNumber(255);
+
+		const Graphics::PixelFormat mapFormats[] = { rgb565, argb8888 };
+		for (uint f = 0; f < ARRAYSIZE(mapFormats); ++f) {
+			uint32 map[256];
+			Graphics::convertPaletteToMap(map, palette, 256, mapFormats[f]);
+
+			Graphics::Surface src, dst;
+			src.create(w, h, Graphics::PixelFormat::createFormatCLUT8());
+			dst.create(w, h, mapFormats[f]);
+			for (int y = 0; y < h; ++y)
+				for (int x = 0; x < w; ++x)
+					src.setPixel(x, y, rnd.getRandomNumber(255));
+
+			Benchmark::Timer timer;
+			for (int i = 0; i < iterations; ++i)
+				Graphics::crossBlitMap((byte *)dst.getPixels(), (const byte *)src.getPixels(), dst.pitch, src.pitch, w, h, dst.format.bytesPerPixel, map);
+			const uint32 ms = MAX<uint32>(timer.elapsed(), 1);
+
+			Benchmark::report("Conversion", Common::String::format("crossBlitMap CLUT8 -> %dbpp", mapFormats[f].bytesPerPixel * 8),
+			                  Common::String::format("%u Mpix/s", (uint32)((uint64)iterations * w * h / ms / 1000)));
+
+			src.free();
+			dst.free();
+		}
+#endif
+	}
+};
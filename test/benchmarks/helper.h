@@ -0,0 +1,66 @@
+#ifndef TEST_BENCHMARK_HELPER_H
+#define TEST_BENCHMARK_HELPER_H
+
+#include "common/system.h"
+#include "common/str.h"
+#include "../null_osystem.h"
+
+// Benchmarks need a working OSystem for timing and output
+#define BENCHMARK_IS_AVAILABLE NULL_OSYSTEM_IS_AVAILABLE
+
+#if BENCHMARK_IS_AVAILABLE
+
+namespace Benchmark {
+
+/** Makes sure an OSystem is available. Call before using files or timers. */
+static inline void init() {
+	if (!g_system)
+		Common::install_null_g_system();
+}
+
+/**
+ * Measures the wall clock time of a benchmark run, in milliseconds.
+ */
+class Timer {
+public:
+	Timer() {
+		init();
+		_start = g_system->getMillis();
+	}
+
+	uint32 elapsed() const {
+		uint32 ms = g_system->getMillis() - _start;
+		return ms ? ms : 1;
+	}
+
+private:
+	uint32 _start;
+};
+
+/**
+ * Prints a benchmark result. The output is meant to be compared between
+ * runs, so it is kept to one line per measured item.
+ */
+static inline void report(const char *suite, const Common::String &item, const Common::String &result) {
+	Common::String line = Common::String::format("\n%s: %s: %s", suite, item.c_str(), result.c_str());
+	g_system->logMessage(LogMessageType::kInfo, line.c_str());
+}
+
+/** Returns the path to a file in the source tree. */
+static inline Common::String sourcePath(const char *path) {
+	return Common::String::format("%s/%s", BENCHMARK_SRCDIR, path);
+}
+
+/**
+ * Number of allocations made through operator new so far. Benchmarks
+ * compare it before and after a run to report allocation rates.
+ *
+ * Counted by the allocation functions in allocations.cpp.
+ */
+extern uint32 allocationCount;
+
+} // End of namespace Benchmark
+
+#endif
+
+#endif
@@ -0,0 +1,109 @@
+#include <cxxtest/TestSuite.h>
+
+#include "helper.h"
+
+#include "common/random.h"
+#include "audio/softsynth/opl/dbopl.h"
+
+class OPLBenchmarkSuite : public CxxTest::TestSuite {
+public:
+#if BENCHMARK_IS_AVAILABLE && !defined(DISABLE_DOSBOX_OPL)
+	typedef OPL::DOSBox::DBOPL::Chip Chip;
+
+	/** Sets up a random instrument on a channel and plays a note on it. */
+	static void playNote(Chip &chip, int channel, Common::RandomSource &rnd) {
+		// Channels 9 to 17 are in the second register set of the OPL3
+		const uint32 bank = channel >= 9 ? 0x100 : 0;
+		const int c = channel % 9;
+		const uint32 op = (c % 3) + (c / 3) * 8;
+
+		for (int i = 0; i < 2; ++i) {
+			const uint32 slot = bank + op + i * 3;
+			chip.WriteReg(0x20 + slot, rnd.getRandomNumber(0xff));
+			chip.WriteReg(0x40 + slot, rnd.getRandomNumber(0x3f));
+			chip.WriteReg(0x60 + slot, 0x80 | rnd.getRandomNumber(0x7f));
+			chip.WriteReg(0x80 + slot, rnd.getRandomNumber(0xff));
+			chip.WriteReg(0xE0 + slot, rnd.getRandomNumber(7));
+		}
+
+		// Both speakers, random feedback and connection
+		chip.WriteReg(bank + 0xC0 + c, 0x30 | rnd.getRandomNumber(0xf));
+		chip.WriteReg(bank + 0xA0 + c, rnd.getRandomNumber(0xff));
+		chip.WriteReg(bank + 0xB0 + c, 0x20 | (rnd.getRandomNumber(5) + 2) << 2 | rnd.getRandomNumber(3));
+	}
+
+	static void releaseNote(Chip &chip, int channel) {
+		const uint32 bank = channel >= 9 ? 0x100 : 0;
+		chip.WriteReg(bank + 0xB0 + channel % 9, 0);
+	}
+
+	/**
+	 * Plays random notes on all the channels for the given number of
+	 * seconds, writing to the chip between blocks of samples like a
+	 * driver called back at 250Hz, and reports the speed and a checksum
+	 * of the output.
+	 */
+	static void renderSong(const char *name, bool opl3, bool percussion, int rate, int seconds) {
+		OPL::DOSBox::DBOPL::InitTables();
+		Chip chip;
+		chip.Setup(rate);
+
+		Common::RandomSource rnd("opl_benchmark");
+		rnd.setSeed(1);
+
+		const int channels = opl3 ? 18 : 9;
+		chip.WriteReg(0x01, 0x20);
+		if (opl3)
+			chip.WriteReg(0x105, 0x01);
+		// Deep tremolo and vibrato, and the rhythm section
+		chip.WriteReg(0xBD, 0xC0 | (percussion ? 0x3f : 0));
+
+		const int ticksPerSecond = 250;
+		const int32 stereo = opl3 ? 2 : 1;
+		int32 *buffer = new int32[(rate / ticksPerSecond + 1) * stereo];
+		uint32 checksum = 0;
+		int remainder = 0;
+
+		Benchmark::Timer timer;
+
+		for (int tick = 0; tick < seconds * ticksPerSecond; ++tick) {
+			// A new note on a random channel every 20ms, released 200ms later
+			if (tick % 5 == 0) {
+				const int channel = rnd.getRandomNumber(channels - 1);
+				playNote(chip, channel, rnd);
+			}
+			if (tick % 5 == 2)
+				releaseNote(chip, rnd.getRandomNumber(channels - 1));
+
+			remainder += rate;
+			const int samples = remainder / ticksPerSecond;
+			remainder %= ticksPerSecond;
+
+			if (opl3)
+				chip.GenerateBlock3(samples, buffer);
+			else
+				chip.GenerateBlock2(samples, buffer);
+
+			for (int i = 0; i < samples * stereo; ++i)
+				checksum = checksum * 31 + buffer[i];
+		}
+
+		const uint32 ms = timer.elapsed();
+		Benchmark::report("OPL", Common::String::format("DOSBox %s %dHz", name, rate),
+		                  Common::String::format("%ux realtime, checksum %08x", seconds * 1000 / ms, checksum));
+
+		delete[] buffer;
+	}
+#endif
+
+	void test_dosbox() {
+#if BENCHMARK_IS_AVAILABLE && !defined(DISABLE_DOSBOX_OPL)
+		Benchmark::init();
+
+		renderSong("OPL2", false, false, 44100, 300);
+		renderSong("OPL2 rhythm", false, true, 44100, 300);
+		renderSong("OPL3", true, false, 44100, 300);
+		renderSong("OPL2", false, false, 22050, 300);
+#endif
+	}
+};
@@ -0,0 +1,261 @@
+#include <cxxtest/TestSuite.h>
+
+#include "helper.h"
+
+#include "common/fs.h"
+#include "common/memstream.h"
+#include "common/random.h"
+#include "graphics/tinygl/capture.h"
+#include "graphics/tinygl/tinygl.h"
+
+class TinyGLBenchmarkSuite : public CxxTest::TestSuite {
+public:
+#if BENCHMARK_IS_AVAILABLE
+	enum Mode {
+		kModeGouraud,
+		kModeFlat,
+		kModeTextured,
+		kModeTexturedBlended,
+		kModeTexturedMipmapped,
+		kModeCount
+	};
+
+	struct Triangle {
+		float x[3], y[3], z[3];
+		float r[3], g[3], b[3], a[3];
+		float s[3], t[3];
+	};
+
+	/** Overlapping triangles of random sizes, covering the screen a few times over. */
+	static void createScene(Common::Array<Triangle> &scene, int count) {
+		Common::RandomSource rnd("tinygl_benchmark");
+		rnd.setSeed(1);
+
+		scene.resize(count);
+		for (int i = 0; i < count; ++i) {
+			Triangle &tri = scene[i];
+			const float cx = rnd.getRandomNumber(2000) / 1000.0f - 1.0f;
+			const float cy = rnd.getRandomNumber(2000) / 1000.0f - 1.0f;
+			const float size = 0.05f + rnd.getRandomNumber(400) / 1000.0f;
+
+			for (int v = 0; v < 3; ++v) {
+				tri.x[v] = cx + size * (rnd.getRandomNumber(2000) / 1000.0f - 1.0f);
+				tri.y[v] = cy + size * (rnd.getRandomNumber(2000) / 1000.0f - 1.0f);
+				tri.z[v] = rnd.getRandomNumber(1800) / 1000.0f - 0.9f;
+				tri.r[v] = rnd.getRandomNumber(255) / 255.0f;
+				tri.g[v] = rnd.getRandomNumber(255) / 255.0f;
+				tri.b[v] = rnd.getRandomNumber(255) / 255.0f;
+				tri.a[v] = rnd.getRandomNumber(255) / 255.0f;
+				tri.s[v] = rnd.getRandomNumber(2000) / 1000.0f;
+				tri.t[v] = rnd.getRandomNumber(2000) / 1000.0f;
+			}
+		}
+	}
+
+	/** A 64x64 texture, minified in most of the scene. */
+	static TGLuint createTexture(TGLint minFilter = TGL_NEAREST) {
+		Common::RandomSource rnd("tinygl_benchmark");
+		rnd.setSeed(2);
+
+		const int size = 64;
+		byte *pixels = new byte[size * size * 4];
+		for (int i = 0; i < size * size * 4; ++i)
+			pixels[i] = rnd.getRandomNumber(255);
+
+		TGLuint texture;
+		tglGenTextures(1, &texture);
+		tglBindTexture(TGL_TEXTURE_2D, texture);
+		tglTexParameteri(TGL_TEXTURE_2D, TGL_TEXTURE_MIN_FILTER, minFilter);
+		tglTexParameteri(TGL_TEXTURE_2D, TGL_TEXTURE_MAG_FILTER, TGL_NEAREST);
+		tglTexImage2D(TGL_TEXTURE_2D, 0, TGL_RGBA, size, size, 0, TGL_RGBA, TGL_UNSIGNED_BYTE, pixels);
+
+		delete[] pixels;
+		return texture;
+	}
+
+	/** Renders one frame of the scene, the context must be current. */
+	static void drawScene(const Common::Array<Triangle> &scene, Mode mode, TGLuint texture, TGLuint mipmappedTexture = 0, TinyGL::BlitImage *image = nullptr) {
+		tglClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+		tglClearDepth(1.0f);
+		tglClear(TGL_COLOR_BUFFER_BIT | TGL_DEPTH_BUFFER_BIT);
+
+		tglMatrixMode(TGL_PROJECTION);
+		tglLoadIdentity();
+		tglMatrixMode(TGL_MODELVIEW);
+		tglLoadIdentity();
+
+		tglEnable(TGL_DEPTH_TEST);
+		tglDepthFunc(TGL_LESS);
+		tglShadeModel(mode == kModeFlat ? TGL_FLAT : TGL_SMOOTH);
+
+		if (mode == kModeTextured || mode == kModeTexturedBlended || mode == kModeTexturedMipmapped) {
+			tglEnable(TGL_TEXTURE_2D);
+			tglBindTexture(TGL_TEXTURE_2D, mode == kModeTexturedMipmapped ? mipmappedTexture : texture);
+		} else {
+			tglDisable(TGL_TEXTURE_2D);
+		}
+
+		if (mode == kModeTexturedBlended) {
+			tglEnable(TGL_BLEND);
+			tglBlendFunc(TGL_SRC_ALPHA, TGL_ONE_MINUS_SRC_ALPHA);
+		} else {
+			tglDisable(TGL_BLEND);
+		}
+
+		tglBegin(TGL_TRIANGLES);
+		for (uint i = 0; i < scene.size(); ++i) {
+			const Triangle &tri = scene[i];
+			for (int v = 0; v < 3; ++v) {
+				tglColor4f(tri.r[v], tri.g[v], tri.b[v], tri.a[v]);
+				tglTexCoord2f(tri.s[v], tri.t[v]);
+				tglVertex3f(tri.x[v], tri.y[v], tri.z[v]);
+			}
+		}
+		tglEnd();
+
+		if (image)
+			tglBlit(image, 100 + mode * 80, 100 + mode * 40);
+
+		TinyGL::presentBuffer();
+	}
+
+	static uint32 checksumFrame() {
+		Graphics::Surface surface;
+		TinyGL::getSurfaceRef(surface);
+
+		uint32 checksum = 0;
+		for (int y = 0; y < surface.h; ++y) {
+			const byte *row = (const byte *)surface.getBasePtr(0, y);
+			for (int x = 0; x < surface.w * surface.format.bytesPerPixel; ++x)
+				checksum = checksum * 31 + row[x];
+		}
+		return checksum;
+	}
+
+	/**
+	 * Replays all the frames of a capture, and reports the time per frame
+	 * and the checksum of the last frame.
+	 */
+	static uint32 replayCapture(const Common::String &name, Common::SeekableReadStream *stream, int passes) {
+		TinyGL::CaptureReplay replay(stream);
+		if (!replay.isValid()) {
+			Benchmark::report("TinyGL", name, "not a capture");
+			return 0;
+		}
+
+		uint32 frames = 0, checksum = 0;
+		Benchmark::Timer timer;
+
+		for (int pass = 0; pass < passes; ++pass) {
+			replay.start();
+			while (replay.drawFrame())
+				frames++;
+			checksum = checksumFrame();
+			replay.stop();
+		}
+
+		const uint32 ms = timer.elapsed();
+		Benchmark::report("TinyGL", Common::String::format("replay %s %dx%d %dbpp", name.c_str(), replay.getWidth(), replay.getHeight(), replay.getPixelFormat().bytesPerPixel * 8),
+		                  Common::String::format("%u.%02u ms/frame, checksum %08x", ms / MAX<uint32>(frames, 1), ms * 100 / MAX<uint32>(frames, 1) % 100, checksum));
+		return checksum;
+	}
+#endif
+
+	void test_rasterizer() {
+#if BENCHMARK_IS_AVAILABLE
+		Benchmark::init();
+
+		const int w = 640, h = 480, frames = 30;
+		const char *modeNames[] = { "Gouraud", "flat", "textured", "textured blended", "textured mipmapped" };
+
+		Common::Array<Triangle> scene;
+		createScene(scene, 2000);
+
+		const Graphics::PixelFormat formats[] = {
+			Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0),
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0)
+		};
+
+		for (uint f = 0; f < ARRAYSIZE(formats); ++f) {
+			// Without dirty rectangles every frame is drawn in full
+			TinyGL::createContext(w, h, formats[f], 256, false, false);
+			const TGLuint texture = createTexture();
+			const TGLuint mipmappedTexture = createTexture(TGL_NEAREST_MIPMAP_NEAREST);
+
+			for (int mode = 0; mode < kModeCount; ++mode) {
+				Benchmark::Timer timer;
+				for (int i = 0; i < frames; ++i)
+					drawScene(scene, (Mode)mode, texture, mipmappedTexture);
+				const uint32 ms = MAX<uint32>(timer.elapsed(), 1);
+
+				Benchmark::report("TinyGL", Common::String::format("%s 640x480 %dbpp", modeNames[mode], formats[f].bytesPerPixel * 8),
+				                  Common::String::format("%u frames/s", frames * 1000 / ms));
+			}
+
+			tglDeleteTextures(1, &texture);
+			tglDeleteTextures(1, &mipmappedTexture);
+			TinyGL::destroyContext();
+		}
+#endif
+	}
+
+	void test_replay() {
+#if BENCHMARK_IS_AVAILABLE
+		Benchmark::init();
+
+		// Capture the scene in every mode, with a blit on top, and check
+		// that the replay draws the same
+		const int w = 640, h = 480;
+		Common::Array<Triangle> scene;
+		createScene(scene, 2000);
+
+		TinyGL::createContext(w, h, Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0), 256, false, true);
+		const TGLuint texture = createTexture();
+		const TGLuint mipmappedTexture = createTexture(TGL_NEAREST_MIPMAP_NEAREST);
+
+		Graphics::Surface imageSurface;
+		imageSurface.create(64, 64, Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0));
+		for (int y = 0; y < 64; ++y)
+			for (int x = 0; x < 64; ++x)
+				*(uint32 *)imageSurface.getBasePtr(x, y) = imageSurface.format.ARGBToColor((x ^ y) & 8 ? 255 : 128, x * 4, y * 4, 128);
+		TinyGL::BlitImage *image = tglGenBlitImage();
+		tglUploadBlitImage(image, imageSurface, 0, false);
+		imageSurface.free();
+
+		Common::MemoryWriteStreamDynamic *capture = new Common::MemoryWriteStreamDynamic(DisposeAfterUse::NO);
+		TinyGL::beginCapture(capture, 0);
+		for (int mode = 0; mode < kModeCount; ++mode)
+			drawScene(scene, (Mode)mode, texture, mipmappedTexture, image);
+		const uint32 expected = checksumFrame();
+
+		byte *data = capture->getData();
+		const uint32 size = capture->size();
+		TinyGL::endCapture();
+
+		tglDeleteBlitImage(image);
+		tglDeleteTextures(1, &texture);
+		tglDeleteTextures(1, &mipmappedTexture);
+		TinyGL::destroyContext();
+
+		const uint32 checksum = replayCapture("synthetic", new Common::MemoryReadStream(data, size, DisposeAfterUse::YES), 5);
+		if (checksum != expected)
+			Benchmark::report("TinyGL", "replay synthetic", Common::String::format("differs from the captured frame, checksum %08x", expected));
+
+		// Captures made with the "tinygl_capture" setting, dropped into
+		// test/benchmarks/data
+		Common::FSNode dir(Benchmark::sourcePath("test/benchmarks/data"));
+		Common::FSList files;
+		if (!dir.getChildren(files, Common::FSNode::kListFilesOnly))
+			files.clear();
+
+		for (Common::FSList::const_iterator file = files.begin(); file != files.end(); ++file) {
+			if (!file->getName().hasSuffixIgnoreCase(".tglc"))
+				continue;
+
+			Common::SeekableReadStream *stream = file->createReadStream();
+			if (stream)
+				replayCapture(file->getName(), stream, 1);
+		}
+#endif
+	}
+};
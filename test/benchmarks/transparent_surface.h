@@ -0,0 +1,69 @@
+#include <cxxtest/TestSuite.h>
+
+#include "helper.h"
+
+#include "common/random.h"
+#include "graphics/transparent_surface.h"
+
+class TransparentSurfaceBenchmarkSuite : public CxxTest::TestSuite {
+public:
+	void test_blit() {
+#if BENCHMARK_IS_AVAILABLE
+		Benchmark::init();
+
+		const Graphics::PixelFormat format(4, 8, 8, 8, 8, 24, 16, 8, 0);
+		Common::RandomSource rnd("benchmark");
+
+		Graphics::Surface target;
+		target.create(640, 480, format);
+		for (int y = 0; y < target.h; ++y)
+			for (int x = 0; x < target.w; ++x)
+				*(uint32 *)target.getBasePtr(x, y) = rnd.getRandomNumber(0xFFFFFFFF);
+
+		const int sizes[] = { 32, 128, 400 };
+		const struct {
+			Graphics::TSpriteBlendMode mode;
+			const char *name;
+		} modes[] = {
+			{ Graphics::BLEND_NORMAL, "normal" },
+			{ Graphics::BLEND_ADDITIVE, "additive" },
+			{ Graphics::BLEND_SUBTRACTIVE, "subtractive" },
+			{ Graphics::BLEND_MULTIPLY, "multiply" }
+		};
+		const uint colors[] = { TS_ARGB(255, 255, 255, 255), TS_ARGB(160, 255, 128, 64) };
+
+		for (uint s = 0; s < ARRAYSIZE(sizes); ++s) {
+			// A sprite with soft edges, so each blit mixes transparent,
+			// translucent and opaque pixels
+			Graphics::TransparentSurface sprite;
+			sprite.create(sizes[s], sizes[s], format);
+			for (int y = 0; y < sprite.h; ++y) {
+				for (int x = 0; x < sprite.w; ++x) {
+					const int edge = MIN(MIN(x, sprite.w - 1 - x), MIN(y, sprite.h - 1 - y));
+					const uint alpha = MIN(edge * 16, 255);
+					*(uint32 *)sprite.getBasePtr(x, y) = TS_ARGB(alpha, rnd.getRandomNumber(255), rnd.getRandomNumber(255), rnd.getRandomNumber(255));
+				}
+			}
+
+			const int iterations = 20000000 / (sizes[s] * sizes[s]) + 1;
+
+			for (uint m = 0; m < ARRAYSIZE(modes); ++m) {
+				for (uint c = 0; c < ARRAYSIZE(colors); ++c) {
+					Benchmark::Timer timer;
+					for (int i = 0; i < iterations; ++i)
+						sprite.blit(target, i % (target.w - sprite.w), i % (target.h - sprite.h), Graphics::FLIP_NONE, nullptr, colors[c], -1, -1, modes[m].mode);
+					const uint32 ms = MAX<uint32>(timer.elapsed(), 1);
+
+					Benchmark::report("TransparentSurface",
+					                  Common::String::format("blit %dx%d %s%s", sizes[s], sizes[s], modes[m].name, c ? " tinted" : ""),
+					                  Common::String::format("%u Mpix/s", (uint32)((uint64)iterations * sizes[s] * sizes[s] / ms / 1000)));
+				}
+			}
+
+			sprite.free();
+		}
+
+		target.free();
+#endif
+	}
+};
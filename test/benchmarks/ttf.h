@@ -0,0 +1,61 @@
+#include <cxxtest/TestSuite.h>
+
+#include "helper.h"
+
+#include "common/fs.h"
+#include "common/rect.h"
+#include "common/stream.h"
+#include "common/ustr.h"
+#include "graphics/font.h"
+#include "graphics/fonts/ttf.h"
+#include "graphics/surface.h"
+
+class TTFBenchmarkSuite : public CxxTest::TestSuite {
+public:
+	void test_drawString() {
+#if BENCHMARK_IS_AVAILABLE && defined(USE_FREETYPE2)
+		Benchmark::init();
+
+		Common::FSNode node(Benchmark::sourcePath("gui/themes/fonts/FreeSans.ttf"));
+		Common::SeekableReadStream *stream = node.createReadStream();
+		TS_ASSERT(stream);
+		if (!stream)
+			return;
+
+		Graphics::Font *font = Graphics::loadTTFFont(*stream, 16);
+		delete stream;
+		TS_ASSERT(font);
+		if (!font)
+			return;
+
+		const Common::U32String text("The quick brown fox jumps over the lazy dog. AVAWAY Tokyo");
+
+		const Graphics::PixelFormat formats[] = {
+			Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0),
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0)
+		};
+
+		for (uint f = 0; f < ARRAYSIZE(formats); ++f) {
+			Graphics::Surface surface;
+			surface.create(640, 480, formats[f]);
+			surface.fillRect(Common::Rect(640, 480), formats[f].RGBToColor(0, 0, 128));
+
+			const uint32 color = formats[f].RGBToColor(255, 255, 255);
+			const int iterations = 2000;
+
+			Benchmark::Timer timer;
+			for (int i = 0; i < iterations; ++i)
+				font->drawString(&surface, text, 0, (i * font->getFontHeight()) % (480 - font->getFontHeight()), 640, color);
+			const uint32 ms = timer.elapsed();
+
+			Benchmark::report("TTFFont", Common::String::format("drawString %dbpp", formats[f].bytesPerPixel * 8),
+			                  Common::String::format("%u strings/s, %u chars/s",
+			                                         iterations * 1000 / ms, iterations * 1000 / ms * text.size()));
+
+			surface.free();
+		}
+
+		delete font;
+#endif
+	}
+};
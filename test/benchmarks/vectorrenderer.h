@@ -0,0 +1,56 @@
+#include <cxxtest/TestSuite.h>
+
+#include "helper.h"
+
+#include "common/rect.h"
+#include "graphics/managed_surface.h"
+#include "graphics/VectorRenderer.h"
+#include "graphics/VectorRendererSpec.h"
+
+class VectorRendererBenchmarkSuite : public CxxTest::TestSuite {
+public:
+	void test_drawRoundedSquare() {
+#if BENCHMARK_IS_AVAILABLE
+		Benchmark::init();
+
+		const Graphics::PixelFormat formats[] = {
+			Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0),
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0)
+		};
+
+		for (uint f = 0; f < ARRAYSIZE(formats); ++f) {
+			Graphics::ManagedSurface surface(640, 480, formats[f]);
+
+			Graphics::VectorRenderer *renderer;
+			if (formats[f].bytesPerPixel == 2)
+				renderer = new Graphics::VectorRendererSpec<uint16>(formats[f]);
+			else
+				renderer = new Graphics::VectorRendererSpec<uint32>(formats[f]);
+
+			renderer->setSurface(&surface);
+			renderer->setBgColor(32, 32, 96);
+			renderer->setFgColor(255, 255, 255);
+			renderer->setGradientColors(64, 64, 160, 200, 200, 255);
+			renderer->setGradientFactor(1);
+			renderer->setShadowOffset(4);
+			renderer->setStrokeWidth(1);
+			renderer->fillSurface();
+
+			const int iterations = 1000;
+			Benchmark::Timer timer;
+			for (int i = 0; i < iterations; ++i) {
+				renderer->setFillMode(Graphics::VectorRenderer::kFillGradient);
+				renderer->drawRoundedSquare(20 + i % 40, 20, 8, 560, 400);
+				renderer->setFillMode(Graphics::VectorRenderer::kFillBackground);
+				renderer->drawRoundedSquare(40, 40 + i % 40, 4, 200, 24);
+			}
+			const uint32 ms = MAX<uint32>(timer.elapsed(), 1);
+
+			Benchmark::report("VectorRenderer", Common::String::format("drawRoundedSquare %dbpp", formats[f].bytesPerPixel * 8),
+			                  Common::String::format("%u frames/s", iterations * 1000 / ms));
+
+			delete renderer;
+		}
+#endif
+	}
+};
@@ -0,0 +1,64 @@
+#include <cxxtest/TestSuite.h>
+
+#include "helper.h"
+
+#include "common/random.h"
+#include "graphics/surface.h"
+#include "graphics/yuv_to_rgb.h"
+
+class YUVToRGBBenchmarkSuite : public CxxTest::TestSuite {
+public:
+	void test_convert() {
+#if BENCHMARK_IS_AVAILABLE
+		Benchmark::init();
+
+		const int w = 640, h = 480, iterations = 1000;
+		Common::RandomSource rnd("benchmark");
+
+		// The 410 chroma planes need an extra row and column
+		const int uvPitch = w + 1;
+		byte *yPlane = new byte[w * h];
+		byte *uPlane = new byte[uvPitch * (h + 1)];
+		byte *vPlane = new byte[uvPitch * (h + 1)];
+		for (int i = 0; i < w * h; ++i)
+			yPlane[i] = rnd.getRandomNumber(255);
+		for (int i = 0; i < uvPitch * (h + 1); ++i) {
+			uPlane[i] = rnd.getRandomNumber(255);
+			vPlane[i] = rnd.getRandomNumber(255);
+		}
+
+		const Graphics::PixelFormat formats[] = {
+			Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0),
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0)
+		};
+		const char *layouts[] = { "420", "444", "410" };
+
+		for (uint f = 0; f < ARRAYSIZE(formats); ++f) {
+			Graphics::Surface surface;
+			surface.create(w, h, formats[f]);
+
+			for (uint l = 0; l < ARRAYSIZE(layouts); ++l) {
+				Benchmark::Timer timer;
+				for (int i = 0; i < iterations; ++i) {
+					if (l == 0)
+						YUVToRGBMan.convert420(&surface, Graphics::YUVToRGBManager::kScaleITU, yPlane, uPlane, vPlane, w, h, w, uvPitch);
+					else if (l == 1)
+						YUVToRGBMan.convert444(&surface, Graphics::YUVToRGBManager::kScaleITU, yPlane, uPlane, vPlane, w, h, w, uvPitch);
+					else
+						YUVToRGBMan.convert410(&surface, Graphics::YUVToRGBManager::kScaleITU, yPlane, uPlane, vPlane, w, h, w, uvPitch);
+				}
+				const uint32 ms = MAX<uint32>(timer.elapsed(), 1);
+
+				Benchmark::report("YUVToRGB", Common::String::format("convert%s 640x480 %dbpp", layouts[l], formats[f].bytesPerPixel * 8),
+				                  Common::String::format("%u frames/s", iterations * 1000 / ms));
+			}
+
+			surface.free();
+		}
+
+		delete[] yPlane;
+		delete[] uPlane;
+		delete[] vPlane;
+#endif
+	}
+};
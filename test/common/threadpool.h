@@ -0,0 +1,146 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/mutex.h"
+#include "common/system.h"
+#include "common/threadpool.h"
+
+#include "../null_osystem.h"
+
+static void threadPoolIncrement(void *param) {
+	(*(int *)param)++;
+}
+
+struct ThreadPoolMeeting {
+	Common::Mutex mutex;
+	uint arrived;
+	uint count;
+	bool allMet;
+};
+
+// Waits for the other items of the run, which only works if they run at the
+// same time
+static void threadPoolMeet(void *param) {
+	ThreadPoolMeeting &meeting = *(ThreadPoolMeeting *)param;
+	{
+		Common::StackLock lock(meeting.mutex);
+		meeting.arrived++;
+	}
+
+	const uint32 start = g_system->getMillis();
+	while (g_system->getMillis() - start < 5000) {
+		Common::StackLock lock(meeting.mutex);
+		if (meeting.arrived == meeting.count)
+			return;
+	}
+
+	Common::StackLock lock(meeting.mutex);
+	meeting.allMet = false;
+}
+
+class ThreadPoolTestSuite : public CxxTest::TestSuite {
+public:
+	void test_run() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		if (!g_system)
+			Common::install_null_g_system();
+
+		Common::ThreadPool pool;
+		int counters[5] = { 0, 0, 0, 0, 0 };
+		void *params[5];
+
+		for (int i = 0; i < 5; i++)
+			params[i] = &counters[i];
+
+		// Every parameter is used once per run, however many there are
+		pool.run(threadPoolIncrement, params, 5);
+		pool.run(threadPoolIncrement, params, 2);
+		pool.run(threadPoolIncrement, params, 0);
+
+		TS_ASSERT_EQUALS(counters[0], 2);
+		TS_ASSERT_EQUALS(counters[1], 2);
+		TS_ASSERT_EQUALS(counters[2], 1);
+		TS_ASSERT_EQUALS(counters[3], 1);
+		TS_ASSERT_EQUALS(counters[4], 1);
+#endif
+	}
+
+	void test_concurrent_run() {
+#if NULL_OSYSTEM_IS_AVAILABLE && defined(POSIX)
+		if (!g_system)
+			Common::install_null_g_system();
+
+		Common::ThreadPool pool;
+		ThreadPoolMeeting meeting;
+		meeting.arrived = 0;
+		meeting.count = 4;
+		meeting.allMet = true;
+		void *params[4] = { &meeting, &meeting, &meeting, &meeting };
+
+		// The caller and three workers take an item each
+		pool.run(threadPoolMeet, params, 4);
+
+		TS_ASSERT_EQUALS(meeting.arrived, 4U);
+		TS_ASSERT(meeting.allMet);
+#endif
+	}
+
+	void test_repeated_runs() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		if (!g_system)
+			Common::install_null_g_system();
+
+		Common::ThreadPool pool;
+		const uint count = 1000;
+		int *counters = new int[count];
+		void **params = new void *[count];
+
+		for (uint i = 0; i < count; i++) {
+			counters[i] = 0;
+			params[i] = &counters[i];
+		}
+
+		// Fewer items than workers leave some of them idle
+		for (uint i = 0; i < 100; i++)
+			pool.run(threadPoolIncrement, params, (i % 2) ? count : i % 7 + 1);
+
+		for (uint i = 0; i < count; i++) {
+			int expected = 50;
+			for (uint j = 0; j < 100; j += 2) {
+				if (i < j % 7 + 1)
+					expected++;
+			}
+			TS_ASSERT_EQUALS(counters[i], expected);
+		}
+
+		delete[] params;
+		delete[] counters;
+#endif
+	}
+
+	void test_destroy_idle() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		if (!g_system)
+			Common::install_null_g_system();
+
+		int counters[8] = { 0 };
+		void *params[8];
+
+		for (int i = 0; i < 8; i++)
+			params[i] = &counters[i];
+
+		// The workers wait for the next run when the pool is destroyed
+		{
+			Common::ThreadPool pool;
+			pool.run(threadPoolIncrement, params, 8);
+		}
+
+		// No worker was started
+		{
+			Common::ThreadPool pool;
+		}
+
+		for (int i = 0; i < 8; i++)
+			TS_ASSERT_EQUALS(counters[i], 1);
+#endif
+	}
+};
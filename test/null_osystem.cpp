@@ -2,9 +2,125 @@
 #define NULL_DRIVER_USE_FOR_TEST 1
 #include "null_osystem.h"
 #include "../backends/platform/null/null.cpp"
+#include "../backends/graphics/null/null-graphics.h"
+
+#ifdef POSIX
+#include <pthread.h>
+
+#include "common/thread.h"
+
+// The null backend has no threads, real ones let the tests cover the code
+// running on several threads
+class TestMutexInternal final : public Common::MutexInternal {
+public:
+	TestMutexInternal() {
+		pthread_mutexattr_t attr;
+		pthread_mutexattr_init(&attr);
+		pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+		pthread_mutex_init(&_mutex, &attr);
+		pthread_mutexattr_destroy(&attr);
+	}
+	~TestMutexInternal() override { pthread_mutex_destroy(&_mutex); }
+
+	bool lock() override { return pthread_mutex_lock(&_mutex) == 0; }
+	bool unlock() override { return pthread_mutex_unlock(&_mutex) == 0; }
+
+private:
+	pthread_mutex_t _mutex;
+};
+
+class TestThreadInternal final : public Common::ThreadInternal {
+public:
+	TestThreadInternal(Common::ThreadProc proc, void *param) : _proc(proc), _param(param) {
+		_valid = pthread_create(&_thread, nullptr, run, this) == 0;
+	}
+	~TestThreadInternal() override { join(); }
+
+	void join() override {
+		if (_valid) {
+			pthread_join(_thread, nullptr);
+			_valid = false;
+		}
+	}
+
+	bool isValid() const { return _valid; }
+
+private:
+	static void *run(void *data) {
+		TestThreadInternal *thread = (TestThreadInternal *)data;
+		thread->_proc(thread->_param);
+		return nullptr;
+	}
+
+	pthread_t _thread;
+	bool _valid;
+	Common::ThreadProc _proc;
+	void *_param;
+};
+
+class TestSemaphoreInternal final : public Common::SemaphoreInternal {
+public:
+	TestSemaphoreInternal(uint value) : _value(value) {
+		pthread_mutex_init(&_mutex, nullptr);
+		pthread_cond_init(&_cond, nullptr);
+	}
+	~TestSemaphoreInternal() override {
+		pthread_cond_destroy(&_cond);
+		pthread_mutex_destroy(&_mutex);
+	}
+
+	void wait() override {
+		pthread_mutex_lock(&_mutex);
+		while (_value == 0)
+			pthread_cond_wait(&_cond, &_mutex);
+		_value--;
+		pthread_mutex_unlock(&_mutex);
+	}
+
+	void signal() override {
+		pthread_mutex_lock(&_mutex);
+		_value++;
+		pthread_cond_signal(&_cond);
+		pthread_mutex_unlock(&_mutex);
+	}
+
+private:
+	pthread_mutex_t _mutex;
+	pthread_cond_t _cond;
+	uint _value;
+};
+#endif
+
+// The tests don't call initBackend(), but the video decoders they use query
+// the screen format
+class OSystem_NULL_Test : public OSystem_NULL {
+public:
+	OSystem_NULL_Test() {
+		_graphicsManager = new NullGraphicsManager();
+	}
+
+#ifdef POSIX
+	Common::MutexInternal *createMutex() override {
+		return new TestMutexInternal();
+	}
+
+	Common::ThreadInternal *createThread(Common::ThreadProc proc, void *param) override {
+		TestThreadInternal *thread = new TestThreadInternal(proc, param);
+		if (!thread->isValid()) {
+			delete thread;
+			return nullptr;
+		}
+		return thread;
+	}
+
+	Common::SemaphoreInternal *createSemaphore(uint value) override {
+		return new TestSemaphoreInternal(value);
+	}
+#endif
+};
 
 void Common::install_null_g_system() {
-	g_system = OSystem_NULL_create();
+	g_system = new OSystem_NULL_Test();
 }
 
 bool BaseBackend::setScaler(const char *name, int factor) {
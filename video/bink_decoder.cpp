@@ -305,6 +305,13 @@ BinkDecoder::BinkVideoTrack::BinkVideoTrack(uint32 width, uint32 height, const G
 	memset(_curPlanes[3], 255, _yBlockWidth  * 8 * _yBlockHeight  * 8);
 	memset(_oldPlanes[3], 255, _yBlockWidth  * 8 * _yBlockHeight  * 8);
 
+	// With threads, the DCT blocks are transformed in parallel once all
+	// planes were read. Every block position holds at most one of them.
+	_threadParts = CLIP<uint>(g_system->getCPUCount(), 1, kMaxThreadParts);
+	_dctBlockCount = 0;
+	if (_threadParts > 1)
+		_dctBlocks.resize(_yBlockWidth * _yBlockHeight * (hasAlpha ? 2 : 1) + _uvBlockWidth * _uvBlockHeight * 2);
+
 	initBundles();
 	initHuffman();
 }
@@ -466,6 +473,8 @@ bool BinkDecoder::BinkVideoTrack::rewind() {
 void BinkDecoder::BinkVideoTrack::decodePacket(VideoFrame &frame) {
 	assert(frame.bits);
 
+	_dctBlockCount = 0;
+
 	if (_hasAlpha) {
 		if (_id == kBIKiID)
 			frame.bits->skip(32);
@@ -485,18 +494,10 @@ void BinkDecoder::BinkVideoTrack::decodePacket(VideoFrame &frame) {
 			break;
 	}
 
+	transformDCTBlocks();
+
 	// Convert the YUV data we have to our format
-	// The width used here is the surface-width, and not the video-width
-	// to allow for odd-sized videos.
-	if (_hasAlpha) {
-		assert(_curPlanes[0] && _curPlanes[1] && _curPlanes[2] && _curPlanes[3]);
-		YUVToRGBMan.convert420Alpha(&_surface, Graphics::YUVToRGBManager::kScaleITU, _curPlanes[0], _curPlanes[1], _curPlanes[2], _curPlanes[3],
-				_surfaceWidth, _surfaceHeight, _yBlockWidth * 8, _uvBlockWidth * 8);
-	} else {
-		assert(_curPlanes[0] && _curPlanes[1] && _curPlanes[2]);
-		YUVToRGBMan.convert420(&_surface, Graphics::YUVToRGBManager::kScaleITU, _curPlanes[0], _curPlanes[1], _curPlanes[2],
-				_surfaceWidth, _surfaceHeight, _yBlockWidth * 8, _uvBlockWidth * 8);
-	}
+	convertToRGB();
 
 	// And swap the planes with the reference planes
 	for (int i = 0; i < 4; i++)
@@ -505,6 +506,115 @@ void BinkDecoder::BinkVideoTrack::decodePacket(VideoFrame &frame) {
 	_curFrame++;
 }
 
+int32 *BinkDecoder::BinkVideoTrack::getDCTBlock(DecodeContext &ctx, BlockType type, int32 *local) {
+	if (_dctBlockCount >= _dctBlocks.size())
+		return local;
+
+	DCTBlock &block = _dctBlocks[_dctBlockCount++];
+	block.dest  = ctx.dest;
+	block.pitch = ctx.pitch;
+	block.type  = type;
+	return block.coeffs;
+}
+
+void BinkDecoder::BinkVideoTrack::transformDCTBlocks() {
+	if (!_dctBlockCount)
+		return;
+
+	// The blocks don't overlap and only write to the current planes, so
+	// they can be transformed in any order
+	const uint partCount = MIN<uint>(_threadParts, _dctBlockCount);
+
+	ThreadPart parts[kMaxThreadParts];
+	void *params[kMaxThreadParts];
+
+	for (uint i = 0; i < partCount; i++) {
+		parts[i].track = this;
+		parts[i].start = _dctBlockCount * i / partCount;
+		parts[i].end = _dctBlockCount * (i + 1) / partCount;
+		params[i] = &parts[i];
+	}
+
+	_threadPool.run(transformDCTPart, params, partCount);
+}
+
+void BinkDecoder::BinkVideoTrack::transformDCTPart(void *param) {
+	const ThreadPart &part = *(const ThreadPart *)param;
+	BinkVideoTrack &track = *part.track;
+
+	for (uint32 i = part.start; i < part.end; i++) {
+		DCTBlock &block = track._dctBlocks[i];
+
+		switch (block.type) {
+		case kBlockIntra:
+			track.IDCTPut(block.dest, block.pitch, block.coeffs);
+			break;
+		case kBlockInter:
+			track.IDCTAdd(block.dest, block.pitch, block.coeffs);
+			break;
+		case kBlockScaled:
+			track.IDCTPutScaled(block.dest, block.pitch, block.coeffs);
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+void BinkDecoder::BinkVideoTrack::convertToRGB() {
+	// Split the frame into parts of whole macroblock rows. Every part
+	// starts on an even row, so the chroma rows line up with the luma rows.
+	const uint partCount = CLIP<uint>(_threadParts, 1, (_surfaceHeight + 15) / 16);
+	const uint32 rowsPerPart = ((_surfaceHeight / partCount) + 15) & ~15;
+
+	ThreadPart parts[kMaxThreadParts];
+	void *params[kMaxThreadParts];
+
+	for (uint i = 0; i < partCount; i++) {
+		parts[i].track = this;
+		parts[i].start = MIN<uint32>(i * rowsPerPart, _surfaceHeight);
+		parts[i].end = (i == partCount - 1) ? _surfaceHeight : MIN<uint32>(parts[i].start + rowsPerPart, _surfaceHeight);
+		params[i] = &parts[i];
+	}
+
+	// Create the converter here, its creation isn't thread-safe
+	Graphics::YUVToRGBManager::instance();
+
+	_threadPool.run(convertPart, params, partCount);
+}
+
+void BinkDecoder::BinkVideoTrack::convertPart(void *param) {
+	const ThreadPart &part = *(const ThreadPart *)param;
+	BinkVideoTrack &track = *part.track;
+
+	if (part.end <= part.start)
+		return;
+
+	const int yPitch  = track._yBlockWidth  * 8;
+	const int uvPitch = track._uvBlockWidth * 8;
+
+	Graphics::Surface dst;
+	dst.init(track._surface.w, part.end - part.start, track._surface.pitch,
+			track._surface.getBasePtr(0, part.start), track._surface.format);
+
+	const byte *y = track._curPlanes[0] + part.start * yPitch;
+	const byte *u = track._curPlanes[1] + (part.start / 2) * uvPitch;
+	const byte *v = track._curPlanes[2] + (part.start / 2) * uvPitch;
+
+	// The width used here is the surface-width, and not the video-width
+	// to allow for odd-sized videos.
+	if (track._hasAlpha) {
+		assert(track._curPlanes[0] && track._curPlanes[1] && track._curPlanes[2] && track._curPlanes[3]);
+		const byte *a = track._curPlanes[3] + part.start * yPitch;
+		YUVToRGBMan.convert420Alpha(&dst, Graphics::YUVToRGBManager::kScaleITU, y, u, v, a,
+				track._surfaceWidth, part.end - part.start, yPitch, uvPitch);
+	} else {
+		assert(track._curPlanes[0] && track._curPlanes[1] && track._curPlanes[2]);
+		YUVToRGBMan.convert420(&dst, Graphics::YUVToRGBManager::kScaleITU, y, u, v,
+				track._surfaceWidth, part.end - part.start, yPitch, uvPitch);
+	}
+}
+
 void BinkDecoder::BinkVideoTrack::decodePlane(VideoFrame &video, int planeIdx, bool isChroma) {
 	uint32 blockWidth  = isChroma ? _uvBlockWidth  : _yBlockWidth;
 	uint32 blockHeight = isChroma ? _uvBlockHeight : _yBlockHeight;
@@ -815,24 +925,16 @@ void BinkDecoder::BinkVideoTrack::blockScaledRun(DecodeContext &ctx) {
 }
 
 void BinkDecoder::BinkVideoTrack::blockScaledIntra(DecodeContext &ctx) {
-	int32 block[64];
+	int32 local[64];
+	int32 *block = getDCTBlock(ctx, kBlockScaled, local);
 	memset(block, 0, 64 * sizeof(int32));
 
 	block[0] = getBundleValue(kSourceIntraDC);
 
 	readDCTCoeffs(*ctx.video, block, true);
 
-	IDCT(block);
-
-	int32 *src   = block;
-	byte  *dest1 = ctx.dest;
-	byte  *dest2 = ctx.dest + ctx.pitch;
-	for (int j = 0; j < 8; j++, dest1 += (ctx.pitch << 1) - 16, dest2 += (ctx.pitch << 1) - 16, src += 8) {
-
-		for (int i = 0; i < 8; i++, dest1 += 2, dest2 += 2)
-			dest1[0] = dest1[1] = dest2[0] = dest2[1] = src[i];
-
-	}
+	if (block == local)
+		IDCTPutScaled(ctx.dest, ctx.pitch, block);
 }
 
 void BinkDecoder::BinkVideoTrack::blockScaledFill(DecodeContext &ctx) {
@@ -960,14 +1062,16 @@ void BinkDecoder::BinkVideoTrack::blockResidue(DecodeContext &ctx) {
 }
 
 void BinkDecoder::BinkVideoTrack::blockIntra(DecodeContext &ctx) {
-	int32 block[64];
+	int32 local[64];
+	int32 *block = getDCTBlock(ctx, kBlockIntra, local);
 	memset(block, 0, 64 * sizeof(int32));
 
 	block[0] = getBundleValue(kSourceIntraDC);
 
 	readDCTCoeffs(*ctx.video, block, true);
 
-	IDCTPut(ctx, block);
+	if (block == local)
+		IDCTPut(ctx.dest, ctx.pitch, block);
 }
 
 void BinkDecoder::BinkVideoTrack::blockFill(DecodeContext &ctx) {
@@ -981,14 +1085,16 @@ void BinkDecoder::BinkVideoTrack::blockFill(DecodeContext &ctx) {
 void BinkDecoder::BinkVideoTrack::blockInter(DecodeContext &ctx) {
 	blockMotion(ctx);
 
-	int32 block[64];
+	int32 local[64];
+	int32 *block = getDCTBlock(ctx, kBlockInter, local);
 	memset(block, 0, 64 * sizeof(int32));
 
 	block[0] = getBundleValue(kSourceInterDC);
 
 	readDCTCoeffs(*ctx.video, block, false);
 
-	IDCTAdd(ctx, block);
+	if (block == local)
+		IDCTAdd(ctx.dest, ctx.pitch, block);
 }
 
 void BinkDecoder::BinkVideoTrack::blockPattern(DecodeContext &ctx) {
@@ -1478,23 +1584,36 @@ void BinkDecoder::BinkVideoTrack::IDCT(int32 *block) {
 	}
 }
 
-void BinkDecoder::BinkVideoTrack::IDCTAdd(DecodeContext &ctx, int32 *block) {
+void BinkDecoder::BinkVideoTrack::IDCTAdd(byte *dest, uint32 pitch, int32 *block) {
 	int i, j;
 
 	IDCT(block);
-	byte *dest = ctx.dest;
-	for (i = 0; i < 8; i++, dest += ctx.pitch, block += 8)
+	for (i = 0; i < 8; i++, dest += pitch, block += 8)
 		for (j = 0; j < 8; j++)
 			 dest[j] += block[j];
 }
 
-void BinkDecoder::BinkVideoTrack::IDCTPut(DecodeContext &ctx, int32 *block) {
+void BinkDecoder::BinkVideoTrack::IDCTPut(byte *dest, uint32 pitch, int32 *block) {
 	int i;
 	int32 temp[64];
 	for (i = 0; i < 8; i++)
 		IDCTCol(&temp[i], &block[i]);
 	for (i = 0; i < 8; i++) {
-		IDCT_ROW( (&ctx.dest[i*ctx.pitch]), (&temp[8*i]) );
+		IDCT_ROW( (&dest[i*pitch]), (&temp[8*i]) );
+	}
+}
+
+void BinkDecoder::BinkVideoTrack::IDCTPutScaled(byte *dest, uint32 pitch, int32 *block) {
+	IDCT(block);
+
+	int32 *src   = block;
+	byte  *dest1 = dest;
+	byte  *dest2 = dest + pitch;
+	for (int j = 0; j < 8; j++, dest1 += (pitch << 1) - 16, dest2 += (pitch << 1) - 16, src += 8) {
+
+		for (int i = 0; i < 8; i++, dest1 += 2, dest2 += 2)
+			dest1[0] = dest1[1] = dest2[0] = dest2[1] = src[i];
+
 	}
 }
 
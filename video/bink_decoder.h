@@ -33,6 +33,7 @@
 #include "common/array.h"
 #include "common/bitstream.h"
 #include "common/rational.h"
+#include "common/threadpool.h"
 
 #include "video/video_decoder.h"
 
@@ -269,6 +270,48 @@ private:
 		byte *_curPlanes[4]; ///< The 4 color planes, YUVA, current frame.
 		byte *_oldPlanes[4]; ///< The 4 color planes, YUVA, last frame.
 
+		enum {
+			kMaxThreadParts = 8 ///< Maximum number of parts a frame is split into for threads
+		};
+
+		/** A part of the work on a frame, done on its own thread. */
+		struct ThreadPart {
+			BinkVideoTrack *track;
+			uint32 start; ///< First DCT block, or first row to convert to RGB
+			uint32 end;   ///< End of the DCT blocks or rows
+		};
+
+		/** A DCT block, transformed once all planes were read. */
+		struct DCTBlock {
+			byte *dest;
+			uint32 pitch;
+			BlockType type; ///< kBlockIntra, kBlockInter or kBlockScaled
+			int32 coeffs[64];
+		};
+
+		Common::ThreadPool _threadPool;
+		uint _threadParts; ///< Number of parts to split the work on a frame into
+
+		Common::Array<DCTBlock> _dctBlocks; ///< DCT blocks of the frame, unused without threads
+		uint32 _dctBlockCount;              ///< Number of DCT blocks read for the frame
+
+		/**
+		 * Get the buffer to read the coefficients of a DCT block into.
+		 *
+		 * @return A deferred block's coefficients, or local if the
+		 *         block has to be transformed right away.
+		 */
+		int32 *getDCTBlock(DecodeContext &ctx, BlockType type, int32 *local);
+		/** Transform the DCT blocks of the frame. */
+		void transformDCTBlocks();
+		/** Transform a part of the DCT blocks, for Common::ThreadPool::run(). */
+		static void transformDCTPart(void *param);
+
+		/** Convert the current YUV planes into the surface. */
+		void convertToRGB();
+		/** Convert a part of the rows of the current YUV planes, for Common::ThreadPool::run(). */
+		static void convertPart(void *param);
+
 		/** Initialize the bundles. */
 		void initBundles();
 		/** Deinitialize the bundles. */
@@ -326,8 +369,9 @@ private:
 
 		// Bink video IDCT
 		void IDCT(int32 *block);
-		void IDCTPut(DecodeContext &ctx, int32 *block);
-		void IDCTAdd(DecodeContext &ctx, int32 *block);
+		void IDCTPut(byte *dest, uint32 pitch, int32 *block);
+		void IDCTAdd(byte *dest, uint32 pitch, int32 *block);
+		void IDCTPutScaled(byte *dest, uint32 pitch, int32 *block);
 	};
 
 	class BinkAudioTrack : public AudioTrack {
@@ -75,6 +75,11 @@ public:
 protected:
 	Common::QuickTimeParser::SampleDesc *readSampleDesc(Common::QuickTimeParser::Track *track, uint32 format, uint32 descSize);
 
+	// The audio buffers are filled from decodeNextFrame()
+	bool supportsDecodeAhead() const { return false; }
+	// ...even while the frames are replayed from the cache
+	bool supportsFrameCache() const { return true; }
+
 private:
 	void init();
 
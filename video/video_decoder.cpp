@@ -24,14 +24,104 @@
 #include "audio/audiostream.h"
 #include "audio/mixer.h" // for kMaxChannelVolume
 
+#include "common/debug.h"
 #include "common/rational.h"
 #include "common/file.h"
+#include "common/mutex.h"
+#include "common/rect.h"
 #include "common/system.h"
 
 #include "graphics/palette.h"
+#include "graphics/surface.h"
 
 namespace Video {
 
+struct VideoDecoder::DecodeAhead {
+	struct Frame {
+		Graphics::Surface surface;
+		bool hasSurface;
+		int number;
+		uint32 startTime;
+		bool dirtyPalette;
+		byte palette[256 * 3];
+	};
+
+	DecodeAhead(VideoTrack *videoTrack, uint frames) : track(videoTrack), read(0), count(0), ended(false), quit(false),
+			freeSlots(frames), queuedFrames(0) {
+		// One slot more than the queue holds, so the frame returned last
+		// stays valid while the worker fills the others
+		slots.resize(frames + 1);
+		curFrame = track->getCurFrame();
+		nextStartTime = track->getNextFrameStartTime();
+	}
+
+	~DecodeAhead() {
+		for (uint i = 0; i < slots.size(); i++)
+			slots[i].surface.free();
+	}
+
+	VideoTrack *track;
+	Common::Array<Frame> slots;
+	uint read, count;
+	bool ended, quit;
+
+	// Start time of the frame the worker decodes next
+	uint32 nextStartTime;
+
+	// State of the frame returned last
+	int curFrame;
+	byte palette[256 * 3];
+
+	Common::Mutex mutex;
+
+	// The worker waits on freeSlots while the queue is full, the engine
+	// thread on queuedFrames while it is empty. The worker signals
+	// queuedFrames once more when it ends, so a waiting engine thread
+	// notices.
+	Common::Semaphore freeSlots, queuedFrames;
+
+	Common::Thread thread;
+};
+
+struct VideoDecoder::FrameCache {
+	struct Frame {
+		Graphics::Surface surface;
+		bool hasSurface;
+		uint32 startTime;
+		byte *palette; // Only set when the palette changed with this frame
+	};
+
+	FrameCache(VideoTrack *videoTrack, FrameCacheBudget *frameBudget) : track(videoTrack), budget(frameBudget), usedBytes(0), complete(false), replayPos(-1) {}
+
+	~FrameCache() {
+		clear();
+	}
+
+	void clear() {
+		for (uint i = 0; i < frames.size(); i++) {
+			frames[i].surface.free();
+			delete[] frames[i].palette;
+		}
+
+		frames.clear();
+		budget->release(usedBytes);
+		usedBytes = 0;
+		complete = false;
+		replayPos = -1;
+	}
+
+	VideoTrack *track;
+	FrameCacheBudget *budget;
+	uint32 usedBytes;
+	Common::Array<Frame> frames;
+
+	// All frames up to the end of the video are cached
+	bool complete;
+
+	// Index of the frame to return next, or -1 when decoding
+	int replayPos;
+};
+
 VideoDecoder::VideoDecoder() {
 	_startTime = 0;
 	_dirtyPalette = false;
@@ -48,6 +138,9 @@ VideoDecoder::VideoDecoder() {
 	_nextVideoTrack = 0;
 	_mainAudioTrack = 0;
 	_canSetDither = true;
+	_decodeAhead = 0;
+	_decodeAheadFrames = 0;
+	_frameCache = 0;
 
 	// Find the best format for output
 	_defaultHighColorFormat = g_system->getScreenFormat();
@@ -56,7 +149,17 @@ VideoDecoder::VideoDecoder() {
 		_defaultHighColorFormat = Graphics::PixelFormat(4, 8, 8, 8, 8, 8, 16, 24, 0);
 }
 
+VideoDecoder::~VideoDecoder() {
+	stopDecodeAhead();
+	delete _frameCache;
+}
+
 void VideoDecoder::close() {
+	stopDecodeAhead();
+
+	delete _frameCache;
+	_frameCache = 0;
+
 	if (isPlaying())
 		stop();
 
@@ -79,6 +182,7 @@ void VideoDecoder::close() {
 	_nextVideoTrack = 0;
 	_mainAudioTrack = 0;
 	_canSetDither = true;
+	_decodeAheadFrames = 0;
 }
 
 bool VideoDecoder::loadFile(const Common::Path &filename) {
@@ -97,6 +201,7 @@ bool VideoDecoder::needsUpdate() const {
 }
 
 void VideoDecoder::pauseVideo(bool pause) {
+	Common::StackLock trackLock(_trackMutex);
 	if (pause) {
 		_pauseLevel++;
 
@@ -128,6 +233,7 @@ void VideoDecoder::resetPauseStartTime() {
 }
 
 void VideoDecoder::setVolume(byte volume) {
+	Common::StackLock trackLock(_trackMutex);
 	_audioVolume = volume;
 
 	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++)
@@ -136,6 +242,7 @@ void VideoDecoder::setVolume(byte volume) {
 }
 
 void VideoDecoder::setBalance(int8 balance) {
+	Common::StackLock trackLock(_trackMutex);
 	_audioBalance = balance;
 
 	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++)
@@ -148,6 +255,7 @@ Audio::Mixer::SoundType VideoDecoder::getSoundType() const {
 }
 
 void VideoDecoder::setSoundType(Audio::Mixer::SoundType soundType) {
+	Common::StackLock trackLock(_trackMutex);
 	_soundType = soundType;
 
 	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++)
@@ -187,22 +295,39 @@ const Graphics::Surface *VideoDecoder::decodeNextFrame() {
 	_needsUpdate = false;
 	_canSetDither = false;
 
-	readNextPacket();
+	if (isReplayingFrameCache())
+		return nextCachedFrame();
 
-	// If we have no next video track at this point, there shouldn't be
-	// any frame available for us to display.
-	if (!_nextVideoTrack)
-		return 0;
+	// The worker thread owns the video track while decoding ahead
+	uint32 startTime = 0;
+	if (_frameCache)
+		startTime = _decodeAhead ? getDecodeAheadStartTime() : _frameCache->track->getNextFrameStartTime();
 
-	const Graphics::Surface *frame = _nextVideoTrack->decodeNextFrame();
+	const Graphics::Surface *frame;
 
-	if (_nextVideoTrack->hasDirtyPalette()) {
-		_palette = _nextVideoTrack->getPalette();
-		_dirtyPalette = true;
+	if (_decodeAheadFrames && (_decodeAhead || startDecodeAhead())) {
+		frame = nextDecodedAheadFrame();
+	} else {
+		readNextPacket();
+
+		// If we have no next video track at this point, there shouldn't be
+		// any frame available for us to display.
+		if (!_nextVideoTrack)
+			return 0;
+
+		frame = _nextVideoTrack->decodeNextFrame();
+
+		if (_nextVideoTrack->hasDirtyPalette()) {
+			_palette = _nextVideoTrack->getPalette();
+			_dirtyPalette = true;
+		}
+
+		// Look for the next video track here for the next decode.
+		findNextVideoTrack();
 	}
 
-	// Look for the next video track here for the next decode.
-	findNextVideoTrack();
+	if (_frameCache)
+		cacheFrame(frame, startTime);
 
 	return frame;
 }
@@ -212,6 +337,12 @@ bool VideoDecoder::setReverse(bool reverse) {
 	if (reverse && hasAudio())
 		return false;
 
+	// Frames decoded ahead or cached are always in forward order
+	if (reverse && (_decodeAhead || isReplayingFrameCache()))
+		return false;
+
+	Common::StackLock trackLock(_trackMutex);
+
 	// Attempt to make sure all the tracks are in the requested direction
 	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++) {
 		if ((*it)->getTrackType() == Track::kTrackTypeVideo && ((VideoTrack *)*it)->isReversed() != reverse) {
@@ -232,6 +363,12 @@ const byte *VideoDecoder::getPalette() {
 }
 
 int VideoDecoder::getCurFrame() const {
+	if (isReplayingFrameCache())
+		return _frameCache->replayPos - 1;
+
+	if (_decodeAhead)
+		return _decodeAhead->curFrame;
+
 	int32 frame = -1;
 
 	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++)
@@ -242,6 +379,7 @@ int VideoDecoder::getCurFrame() const {
 }
 
 uint32 VideoDecoder::getFrameCount() const {
+	Common::StackLock trackLock(_trackMutex);
 	int count = 0;
 
 	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++)
@@ -273,13 +411,22 @@ uint32 VideoDecoder::getTime() const {
 }
 
 uint32 VideoDecoder::getTimeToNextFrame() const {
-	if (endOfVideo() || _needsUpdate || !_nextVideoTrack)
+	bool replaying = isReplayingFrameCache();
+
+	if (endOfVideo() || _needsUpdate || (!replaying && !_decodeAhead && !_nextVideoTrack))
 		return 0;
 
 	uint32 currentTime = getTime();
-	uint32 nextFrameStartTime = _nextVideoTrack->getNextFrameStartTime();
+	uint32 nextFrameStartTime;
 
-	if (_nextVideoTrack->isReversed()) {
+	if (replaying)
+		nextFrameStartTime = getFrameCacheStartTime();
+	else if (_decodeAhead)
+		nextFrameStartTime = getDecodeAheadStartTime();
+	else
+		nextFrameStartTime = _nextVideoTrack->getNextFrameStartTime();
+
+	if (!replaying && !_decodeAhead && _nextVideoTrack->isReversed()) {
 		// For reversed videos, we need to handle the time difference the opposite way.
 		if (nextFrameStartTime >= currentTime)
 			return 0;
@@ -298,6 +445,24 @@ bool VideoDecoder::endOfVideo() const {
 	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++) {
 		const Track *track = *it;
 
+		// The video track is not used while replaying cached frames
+		if (isReplayingFrameCache() && track->getTrackType() == Track::kTrackTypeVideo) {
+			bool videoEndTimeReached = _endTimeSet && !frameCacheEnded() && getFrameCacheStartTime() >= (uint)_endTime.msecs();
+			if (!frameCacheEnded() && !(isPlaying() && videoEndTimeReached))
+				return false;
+
+			continue;
+		}
+
+		// The worker thread owns the video track while decoding ahead
+		if (_decodeAhead && track->getTrackType() == Track::kTrackTypeVideo) {
+			bool videoEndTimeReached = _endTimeSet && getDecodeAheadStartTime() >= (uint)_endTime.msecs();
+			if (!decodeAheadEnded() && !(isPlaying() && videoEndTimeReached))
+				return false;
+
+			continue;
+		}
+
 		bool videoEndTimeReached = _endTimeSet && track->getTrackType() == Track::kTrackTypeVideo && ((const VideoTrack *)track)->getNextFrameStartTime() >= (uint)_endTime.msecs();
 		bool endReached = track->endOfTrack() || (isPlaying() && videoEndTimeReached);
 		if (!endReached)
@@ -322,6 +487,9 @@ bool VideoDecoder::rewind() {
 	if (!isRewindable())
 		return false;
 
+	// Drop the frames decoded ahead, the thread restarts on the next frame
+	stopDecodeAhead();
+
 	// Stop all tracks so they can be rewound
 	if (isPlaying())
 		stopAudio();
@@ -338,6 +506,7 @@ bool VideoDecoder::rewind() {
 	_startTime = g_system->getMillis();
 	resetPauseStartTime();
 	findNextVideoTrack();
+	startFrameCacheReplay(Audio::Timestamp(0, 1000));
 	return true;
 }
 
@@ -356,6 +525,9 @@ bool VideoDecoder::seek(const Audio::Timestamp &time) {
 	if (!isSeekable())
 		return false;
 
+	// Drop the frames decoded ahead, the thread restarts on the next frame
+	stopDecodeAhead();
+
 	// Stop all tracks so they can be seeked
 	if (isPlaying())
 		stopAudio();
@@ -380,6 +552,7 @@ bool VideoDecoder::seek(const Audio::Timestamp &time) {
 
 	resetPauseStartTime();
 	findNextVideoTrack();
+	startFrameCacheReplay(time);
 	_needsUpdate = true;
 	return true;
 }
@@ -419,6 +592,7 @@ void VideoDecoder::start() {
 }
 
 void VideoDecoder::stop() {
+	Common::StackLock trackLock(_trackMutex);
 	if (!isPlaying())
 		return;
 
@@ -446,6 +620,7 @@ void VideoDecoder::stop() {
 }
 
 void VideoDecoder::setRate(const Common::Rational &rate) {
+	Common::StackLock trackLock(_trackMutex);
 	if (!isVideoLoaded() || _playbackRate == rate)
 		return;
 
@@ -488,6 +663,7 @@ bool VideoDecoder::isPlaying() const {
 }
 
 Audio::Timestamp VideoDecoder::getDuration() const {
+	Common::StackLock trackLock(_trackMutex);
 	Audio::Timestamp maxDuration(0, 1000);
 
 	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++) {
@@ -525,6 +701,326 @@ bool VideoDecoder::setDitheringPalette(const byte *palette) {
 	return result;
 }
 
+bool VideoDecoder::setDecodeAhead(uint frames) {
+	// Like the dithering palette, this can't change once a frame was decoded
+	if (!_canSetDither || !supportsDecodeAhead())
+		return false;
+
+	_decodeAheadFrames = frames;
+	return true;
+}
+
+void VideoDecoder::decodeAheadThread(void *param) {
+	((VideoDecoder *)param)->decodeAheadLoop();
+}
+
+void VideoDecoder::decodeAheadLoop() {
+	DecodeAhead &ahead = *_decodeAhead;
+
+	for (;;) {
+		ahead.freeSlots.wait();
+
+		uint slot;
+		{
+			Common::StackLock lock(ahead.mutex);
+
+			if (ahead.quit)
+				return;
+
+			slot = (ahead.read + ahead.count) % ahead.slots.size();
+		}
+
+		// The slot is not visible to the engine thread until it is queued
+		DecodeAhead::Frame &frame = ahead.slots[slot];
+		bool ended;
+		uint32 nextStartTime;
+
+		{
+			Common::StackLock trackLock(_trackMutex);
+
+			frame.startTime = ahead.track->getNextFrameStartTime();
+
+			readNextPacket();
+			const Graphics::Surface *surface = ahead.track->decodeNextFrame();
+
+			frame.hasSurface = surface != 0;
+			if (surface) {
+				if (frame.surface.w != surface->w || frame.surface.h != surface->h || frame.surface.format != surface->format) {
+					frame.surface.free();
+					frame.surface.create(surface->w, surface->h, surface->format);
+				}
+
+				frame.surface.copyRectToSurface(*surface, 0, 0, Common::Rect(surface->w, surface->h));
+			}
+
+			frame.dirtyPalette = ahead.track->hasDirtyPalette();
+			if (frame.dirtyPalette)
+				memcpy(frame.palette, ahead.track->getPalette(), sizeof(frame.palette));
+
+			frame.number = ahead.track->getCurFrame();
+			ended = ahead.track->endOfTrack();
+			nextStartTime = ahead.track->getNextFrameStartTime();
+		}
+
+		{
+			Common::StackLock lock(ahead.mutex);
+			ahead.count++;
+			ahead.ended = ended;
+			ahead.nextStartTime = nextStartTime;
+		}
+
+		ahead.queuedFrames.signal();
+
+		if (ended) {
+			ahead.queuedFrames.signal();
+			return;
+		}
+	}
+}
+
+bool VideoDecoder::startDecodeAhead() {
+	VideoTrack *track = 0;
+
+	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++) {
+		if ((*it)->getTrackType() == Track::kTrackTypeVideo) {
+			// Only one video track is supported
+			if (track)
+				return false;
+
+			track = (VideoTrack *)*it;
+		}
+	}
+
+	if (!track || track->isReversed() || track->endOfTrack())
+		return false;
+
+	_decodeAhead = new DecodeAhead(track, _decodeAheadFrames);
+
+	if (!_decodeAhead->thread.start(decodeAheadThread, this)) {
+		debug(1, "VideoDecoder: No thread support, decoding frames on demand");
+		delete _decodeAhead;
+		_decodeAhead = 0;
+		_decodeAheadFrames = 0;
+		return false;
+	}
+
+	return true;
+}
+
+void VideoDecoder::stopDecodeAhead() {
+	if (!_decodeAhead)
+		return;
+
+	{
+		Common::StackLock lock(_decodeAhead->mutex);
+		_decodeAhead->quit = true;
+	}
+
+	// Wake the worker up if the queue is full
+	_decodeAhead->freeSlots.signal();
+	_decodeAhead->thread.join();
+	delete _decodeAhead;
+	_decodeAhead = 0;
+}
+
+const Graphics::Surface *VideoDecoder::nextDecodedAheadFrame() {
+	DecodeAhead &ahead = *_decodeAhead;
+	const DecodeAhead::Frame *frame;
+
+	{
+		Common::StackLock lock(ahead.mutex);
+
+		if (ahead.ended && !ahead.count)
+			return 0;
+	}
+
+	// Wait for the worker if it fell behind
+	ahead.queuedFrames.wait();
+
+	{
+		Common::StackLock lock(ahead.mutex);
+
+		// Woken up by the end of the video
+		if (!ahead.count)
+			return 0;
+
+		frame = &ahead.slots[ahead.read];
+		ahead.read = (ahead.read + 1) % ahead.slots.size();
+		ahead.count--;
+	}
+
+	// The slot of the frame returned before this one is free again
+	ahead.freeSlots.signal();
+	ahead.curFrame = frame->number;
+
+	if (frame->dirtyPalette) {
+		memcpy(ahead.palette, frame->palette, sizeof(ahead.palette));
+		_palette = ahead.palette;
+		_dirtyPalette = true;
+	}
+
+	return frame->hasSurface ? &frame->surface : 0;
+}
+
+bool VideoDecoder::decodeAheadEnded() const {
+	Common::StackLock lock(_decodeAhead->mutex);
+	return _decodeAhead->ended && !_decodeAhead->count;
+}
+
+uint32 VideoDecoder::getDecodeAheadStartTime() const {
+	Common::StackLock lock(_decodeAhead->mutex);
+
+	if (_decodeAhead->count)
+		return _decodeAhead->slots[_decodeAhead->read].startTime;
+
+	return _decodeAhead->nextStartTime;
+}
+
+bool VideoDecoder::setFrameCache(FrameCacheBudget *budget) {
+	if (_frameCache && _frameCache->budget == budget)
+		return true;
+
+	// The video track isn't where the replayed frames are
+	if (isReplayingFrameCache())
+		return false;
+
+	delete _frameCache;
+	_frameCache = 0;
+
+	if (!budget)
+		return true;
+
+	if (!supportsFrameCache())
+		return false;
+
+	VideoTrack *track = 0;
+
+	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++) {
+		if ((*it)->getTrackType() == Track::kTrackTypeVideo) {
+			// Only one video track is supported
+			if (track)
+				return false;
+
+			track = (VideoTrack *)*it;
+		}
+	}
+
+	if (!track)
+		return false;
+
+	_frameCache = new FrameCache(track, budget);
+	return true;
+}
+
+bool VideoDecoder::supportsFrameCache() const {
+	for (TrackList::const_iterator it = _internalTracks.begin(); it != _internalTracks.end(); it++)
+		if ((*it)->getTrackType() == Track::kTrackTypeAudio)
+			return false;
+
+	return true;
+}
+
+void VideoDecoder::cacheFrame(const Graphics::Surface *surface, uint32 startTime) {
+	FrameCache &cache = *_frameCache;
+
+	if (cache.complete)
+		return;
+
+	// Only a run of frames from the start of the video can be replayed
+	int number = getCurFrame();
+	if (number != (int)cache.frames.size() || cache.track->isReversed()) {
+		cache.clear();
+
+		if (number != 0 || cache.track->isReversed())
+			return;
+	}
+
+	uint32 size = sizeof(FrameCache::Frame);
+	if (surface)
+		size += surface->pitch * surface->h;
+	if (_dirtyPalette && _palette)
+		size += 256 * 3;
+
+	if (!cache.budget->reserve(size)) {
+		debug(1, "VideoDecoder: Frames exceed the cache budget of %u bytes, disabling the cache", cache.budget->getMaxBytes());
+		delete _frameCache;
+		_frameCache = 0;
+		return;
+	}
+
+	FrameCache::Frame frame;
+	frame.hasSurface = surface != 0;
+	if (surface)
+		frame.surface.copyFrom(*surface);
+	frame.startTime = startTime;
+	frame.palette = 0;
+	if (_dirtyPalette && _palette) {
+		frame.palette = new byte[256 * 3];
+		memcpy(frame.palette, _palette, 256 * 3);
+	}
+
+	cache.frames.push_back(frame);
+	cache.usedBytes += size;
+
+	cache.complete = _decodeAhead ? decodeAheadEnded() : cache.track->endOfTrack();
+	if (cache.complete)
+		debug(2, "VideoDecoder: Cached all %u frames in %u bytes", cache.frames.size(), cache.usedBytes);
+}
+
+void VideoDecoder::startFrameCacheReplay(const Audio::Timestamp &time) {
+	if (!_frameCache || !_frameCache->complete)
+		return;
+
+	FrameCache &cache = *_frameCache;
+
+	// Continue with the frame shown at the given time
+	uint32 msecs = time.msecs();
+	uint pos = 0;
+	while (pos + 1 < cache.frames.size() && cache.frames[pos + 1].startTime <= msecs)
+		pos++;
+
+	cache.replayPos = pos;
+
+	// Restore the palette the skipped frames left behind
+	for (int i = pos - 1; i >= 0; i--) {
+		if (cache.frames[i].palette) {
+			_palette = cache.frames[i].palette;
+			_dirtyPalette = true;
+			break;
+		}
+	}
+}
+
+bool VideoDecoder::isReplayingFrameCache() const {
+	return _frameCache && _frameCache->replayPos >= 0;
+}
+
+const Graphics::Surface *VideoDecoder::nextCachedFrame() {
+	if (frameCacheEnded())
+		return 0;
+
+	const FrameCache::Frame &frame = _frameCache->frames[_frameCache->replayPos++];
+
+	if (frame.palette) {
+		_palette = frame.palette;
+		_dirtyPalette = true;
+	}
+
+	return frame.hasSurface ? &frame.surface : 0;
+}
+
+bool VideoDecoder::frameCacheEnded() const {
+	return _frameCache->replayPos >= (int)_frameCache->frames.size();
+}
+
+uint32 VideoDecoder::getFrameCacheStartTime() const {
+	if (frameCacheEnded())
+		return 0;
+
+	return _frameCache->frames[_frameCache->replayPos].startTime;
+}
+
+
 VideoDecoder::Track::Track() {
 	_paused = false;
 }
@@ -755,6 +1251,7 @@ void VideoDecoder::addTrack(Track *track, bool isExternal) {
 }
 
 bool VideoDecoder::addStreamFileTrack(const Common::String &baseName) {
+	Common::StackLock trackLock(_trackMutex);
 	// Only allow adding external tracks if a video is already loaded
 	if (!isVideoLoaded())
 		return false;
@@ -772,6 +1269,7 @@ bool VideoDecoder::addStreamFileTrack(const Common::String &baseName) {
 }
 
 bool VideoDecoder::setAudioTrack(int index) {
+	Common::StackLock trackLock(_trackMutex);
 	if (!supportsAudioTrackSwitching())
 		return false;
 
@@ -800,6 +1298,7 @@ uint VideoDecoder::getAudioTrackCount() const {
 }
 
 void VideoDecoder::setEndTime(const Audio::Timestamp &endTime) {
+	Common::StackLock trackLock(_trackMutex);
 	Audio::Timestamp startTime = 0;
 
 	if (isPlaying()) {
@@ -921,6 +1420,16 @@ bool VideoDecoder::hasFramesLeft() const {
 		if ((*it)->getTrackType() != Track::kTrackTypeVideo)
 			continue;
 
+		if (isReplayingFrameCache()) {
+			bool videoEndTimeReached = _endTimeSet && !frameCacheEnded() && getFrameCacheStartTime() >= (uint)_endTime.msecs();
+			return !frameCacheEnded() && !(isPlaying() && videoEndTimeReached);
+		}
+
+		if (_decodeAhead) {
+			bool videoEndTimeReached = _endTimeSet && getDecodeAheadStartTime() >= (uint)_endTime.msecs();
+			return !decodeAheadEnded() && !(isPlaying() && videoEndTimeReached);
+		}
+
 		const VideoTrack *track = (const VideoTrack *)*it;
 
 		bool videoEndTimeReached = _endTimeSet && track->getNextFrameStartTime() >= (uint)_endTime.msecs();
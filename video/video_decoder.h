@@ -25,6 +25,7 @@
 #include "audio/mixer.h"
 #include "audio/timestamp.h"	// TODO: Move this to common/ ?
 #include "common/array.h"
+#include "common/mutex.h"
 #include "common/path.h"
 #include "common/rational.h"
 #include "common/str.h"
@@ -46,13 +47,44 @@ struct Surface;
 
 namespace Video {
 
+/**
+ * A memory budget shared by the frame caches of several videos.
+ *
+ * It must outlive the videos using it, and the videos must be decoded on
+ * the same thread.
+ *
+ * @see VideoDecoder::setFrameCache()
+ */
+class FrameCacheBudget {
+public:
+	explicit FrameCacheBudget(uint32 maxBytes) : _maxBytes(maxBytes), _usedBytes(0) {}
+
+	uint32 getMaxBytes() const { return _maxBytes; }
+	uint32 getUsedBytes() const { return _usedBytes; }
+
+	/** Take bytes from the budget, if enough are left. */
+	bool reserve(uint32 bytes) {
+		if (bytes > _maxBytes - _usedBytes)
+			return false;
+
+		_usedBytes += bytes;
+		return true;
+	}
+
+	/** Give bytes taken with reserve() back. */
+	void release(uint32 bytes) { _usedBytes -= bytes; }
+
+private:
+	uint32 _maxBytes, _usedBytes;
+};
+
 /**
  * Generic interface for video decoder classes.
  */
 class VideoDecoder {
 public:
 	VideoDecoder();
-	virtual ~VideoDecoder() {}
+	virtual ~VideoDecoder();
 
 	/////////////////////////////////////////
 	// Opening/Closing a Video
@@ -396,6 +428,50 @@ public:
 	 */
 	bool setDitheringPalette(const byte *palette);
 
+	/**
+	 * Decode frames ahead of time on a separate thread.
+	 *
+	 * A worker thread keeps up to the given number of frames decoded in
+	 * advance, and decodeNextFrame() returns them in order. This moves the
+	 * decoding off the calling thread and evens out the cost of expensive
+	 * frames.
+	 *
+	 * This is only supported for videos with one video track that play
+	 * forward, and only if the backend supports threads. Otherwise frames
+	 * are decoded on demand as usual. Seeking or rewinding drops the
+	 * decoded frames, and close() stops the thread. The other calls
+	 * changing the playback state wait for the worker to finish the frame
+	 * it is decoding.
+	 *
+	 * This should be called after loadStream(), but before a decodeNextFrame()
+	 * call. This is enforced.
+	 *
+	 * @param frames The number of frames to decode ahead, or 0 to disable
+	 * @return true on success, false otherwise
+	 */
+	bool setDecodeAhead(uint frames);
+
+	/**
+	 * Keep the decoded frames in memory, to replay them when looping.
+	 *
+	 * While the video plays forward from its first frame to its end, a
+	 * copy of every frame is kept. Once all frames are cached, rewinding
+	 * or seeking the video replays the frames from memory instead of
+	 * decoding them again, which makes looping short videos nearly free.
+	 *
+	 * This is only supported for videos with one video track. The cache
+	 * is dropped and disabled if the frames exceed what is left of the
+	 * memory budget.
+	 *
+	 * This should be called after loadStream(). If frames were decoded
+	 * already, caching starts when the video next plays from its first
+	 * frame. The cache can't be replaced while its frames are replayed.
+	 *
+	 * @param budget The memory budget for the cached frames, or 0 to disable
+	 * @return true on success, false otherwise
+	 */
+	bool setFrameCache(FrameCacheBudget *budget);
+
 	/////////////////////////////////////////
 	// Audio Control
 	/////////////////////////////////////////
@@ -936,6 +1012,30 @@ protected:
 	 */
 	virtual AudioTrack *getAudioTrack(int index) { return 0; }
 
+	/**
+	 * Can this video be decoded ahead on a separate thread?
+	 *
+	 * Decoding ahead calls readNextPacket() and the video track's
+	 * decodeNextFrame() from a worker thread. A subclass that accesses
+	 * its tracks from other functions while the video plays must return
+	 * false.
+	 *
+	 * @see setDecodeAhead()
+	 */
+	virtual bool supportsDecodeAhead() const { return true; }
+
+	/**
+	 * Can the frames of this video be replayed from the frame cache?
+	 *
+	 * Replaying frames skips readNextPacket(). By default this is only
+	 * supported for videos without internal audio tracks, which may be
+	 * fed from readNextPacket(). A subclass whose audio does not depend
+	 * on it can return true.
+	 *
+	 * @see setFrameCache()
+	 */
+	virtual bool supportsFrameCache() const;
+
 private:
 	// Tracks owned by this VideoDecoder
 	TrackList _tracks;
@@ -959,6 +1059,34 @@ private:
 	// Default PixelFormat settings
 	Graphics::PixelFormat _defaultHighColorFormat;
 
+	// Frames decoded ahead on a worker thread, see setDecodeAhead()
+	struct DecodeAhead;
+	DecodeAhead *_decodeAhead;
+	uint _decodeAheadFrames;
+
+	// Held by the worker while it decodes, and by the calls changing the
+	// tracks while it may run. Must not be held when stopping the worker.
+	mutable Common::Mutex _trackMutex;
+
+	static void decodeAheadThread(void *param);
+	void decodeAheadLoop();
+	bool startDecodeAhead();
+	void stopDecodeAhead();
+	const Graphics::Surface *nextDecodedAheadFrame();
+	bool decodeAheadEnded() const;
+	uint32 getDecodeAheadStartTime() const;
+
+	// Frames kept for replaying looped videos, see setFrameCache()
+	struct FrameCache;
+	FrameCache *_frameCache;
+
+	void cacheFrame(const Graphics::Surface *surface, uint32 startTime);
+	void startFrameCacheReplay(const Audio::Timestamp &time);
+	bool isReplayingFrameCache() const;
+	const Graphics::Surface *nextCachedFrame();
+	bool frameCacheEnded() const;
+	uint32 getFrameCacheStartTime() const;
+
 protected:
 	// Internal helper functions
 	void stopAudio();